@@ -12,4 +12,5 @@
 #define LOG_AUDIO(fmt, ...) LOG_TAG("AUDIO", fmt, ##__VA_ARGS__)
 #define LOG_UI(fmt, ...) LOG_TAG("UI", fmt, ##__VA_ARGS__)
 #define LOG_CFG(fmt, ...) LOG_TAG("CFG", fmt, ##__VA_ARGS__)
-#define LOG_CORE(fmt, ...) LOG_TAG("CORE", fmt, ##__VA_ARGS__)
\ No newline at end of file
+#define LOG_CORE(fmt, ...) LOG_TAG("CORE", fmt, ##__VA_ARGS__)
+#define LOG_LIB(fmt, ...) LOG_TAG("LIB", fmt, ##__VA_ARGS__)
\ No newline at end of file
@@ -0,0 +1,195 @@
+#pragma once
+// native 环境的 Arduino 核心替身：只实现本项目和 ESP8266Audio 用到的部分
+#include <stdint.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdarg.h>
+#include <math.h>
+#include <string>
+#include "pgmspace.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+#include "freertos/queue.h"
+
+#define IRAM_ATTR
+#define DRAM_ATTR
+#define RAM_ATTR
+
+typedef uint8_t byte;
+typedef bool boolean;
+
+uint32_t millis();
+uint32_t micros();
+void delay(uint32_t ms);
+void delayMicroseconds(uint32_t us);
+void yield();
+
+long random(long max);
+long random(long min, long max);
+void randomSeed(unsigned long seed);
+long map(long x, long inMin, long inMax, long outMin, long outMax);
+
+// PSRAM：默认按有 PSRAM 的机型模拟，SIM_PSRAM=0 时按无 PSRAM 处理
+bool psramFound();
+
+class String
+{
+public:
+    String() {}
+    String(const char *c) : s(c ? c : "") {}
+    String(const std::string &v) : s(v) {}
+    String(char c) : s(1, c) {}
+    String(int v) : s(std::to_string(v)) {}
+    String(unsigned int v) : s(std::to_string(v)) {}
+    String(long v) : s(std::to_string(v)) {}
+    String(unsigned long v) : s(std::to_string(v)) {}
+
+    const char *c_str() const { return s.c_str(); }
+    unsigned int length() const { return (unsigned int)s.size(); }
+    bool isEmpty() const { return s.empty(); }
+    char operator[](unsigned int i) const { return i < s.size() ? s[i] : 0; }
+    char charAt(unsigned int i) const { return (*this)[i]; }
+
+    bool startsWith(const String &p) const { return s.compare(0, p.s.size(), p.s) == 0; }
+    bool endsWith(const String &p) const
+    {
+        return s.size() >= p.s.size() && s.compare(s.size() - p.s.size(), p.s.size(), p.s) == 0;
+    }
+    int indexOf(char c, unsigned int from = 0) const
+    {
+        size_t i = s.find(c, from);
+        return i == std::string::npos ? -1 : (int)i;
+    }
+    int indexOf(const String &p, unsigned int from = 0) const
+    {
+        size_t i = s.find(p.s, from);
+        return i == std::string::npos ? -1 : (int)i;
+    }
+    int lastIndexOf(char c) const
+    {
+        size_t i = s.rfind(c);
+        return i == std::string::npos ? -1 : (int)i;
+    }
+    String substring(unsigned int from) const { return from < s.size() ? String(s.substr(from)) : String(); }
+    String substring(unsigned int from, unsigned int to) const
+    {
+        if (from >= s.size() || to <= from)
+            return String();
+        return String(s.substr(from, to - from));
+    }
+    void toLowerCase()
+    {
+        for (auto &c : s)
+            if (c >= 'A' && c <= 'Z')
+                c += 'a' - 'A';
+    }
+    void toUpperCase()
+    {
+        for (auto &c : s)
+            if (c >= 'a' && c <= 'z')
+                c -= 'a' - 'A';
+    }
+    void trim()
+    {
+        size_t b = s.find_first_not_of(" \t\r\n");
+        size_t e = s.find_last_not_of(" \t\r\n");
+        s = b == std::string::npos ? std::string() : s.substr(b, e - b + 1);
+    }
+    long toInt() const { return strtol(s.c_str(), nullptr, 10); }
+
+    String &operator+=(const String &o)
+    {
+        s += o.s;
+        return *this;
+    }
+    String &operator+=(const char *o)
+    {
+        s += o ? o : "";
+        return *this;
+    }
+    String &operator+=(char c)
+    {
+        s += c;
+        return *this;
+    }
+    friend String operator+(const String &a, const String &b) { return String(a.s + b.s); }
+    friend String operator+(const String &a, const char *b) { return String(a.s + (b ? b : "")); }
+    friend String operator+(const char *a, const String &b) { return String(std::string(a ? a : "") + b.s); }
+    bool operator==(const String &o) const { return s == o.s; }
+    bool operator==(const char *o) const { return s == (o ? o : ""); }
+    bool operator!=(const String &o) const { return s != o.s; }
+    bool operator!=(const char *o) const { return !(*this == o); }
+    bool operator<(const String &o) const { return s < o.s; }
+
+private:
+    std::string s;
+};
+
+class Print
+{
+public:
+    virtual ~Print() {}
+    virtual size_t write(uint8_t c) = 0;
+    virtual size_t write(const uint8_t *buf, size_t len)
+    {
+        size_t n = 0;
+        while (len--)
+            n += write(*buf++);
+        return n;
+    }
+    size_t write(const char *str) { return str ? write((const uint8_t *)str, strlen(str)) : 0; }
+    virtual void flush() {}
+
+    size_t print(const char *s) { return write(s); }
+    size_t print(const String &s) { return write(s.c_str()); }
+    size_t print(char c) { return write((uint8_t)c); }
+    size_t print(int v) { return printf("%d", v); }
+    size_t print(unsigned int v) { return printf("%u", v); }
+    size_t print(long v) { return printf("%ld", v); }
+    size_t print(unsigned long v) { return printf("%lu", v); }
+    size_t print(double v, int digits = 2) { return printf("%.*f", digits, v); }
+    size_t println() { return write("\n"); }
+    template <typename T>
+    size_t println(const T &v)
+    {
+        size_t n = print(v);
+        return n + println();
+    }
+    size_t printf(const char *fmt, ...) __attribute__((format(printf, 2, 3)));
+};
+
+// 串口输出到 stdout，一次 write 一整段，多任务同时打日志时行不会被拆开
+class HardwareSerial : public Print
+{
+public:
+    void begin(unsigned long baud) { (void)baud; }
+    void end() {}
+    int available() { return 0; }
+    int read() { return -1; }
+    operator bool() const { return true; }
+    virtual size_t write(uint8_t c) override;
+    virtual size_t write(const uint8_t *buf, size_t len) override;
+    virtual void flush() override;
+    using Print::write;
+};
+extern HardwareSerial Serial;
+
+class EspClass
+{
+public:
+    uint32_t getFreeHeap();
+    uint32_t getMinFreeHeap();
+    uint32_t getMaxAllocHeap();
+    uint32_t getFreePsram();
+    uint32_t getPsramSize();
+    uint32_t getCpuFreqMHz() { return 240; }
+    void restart();
+};
+extern EspClass ESP;
+
+// Arduino 入口，由 main.cpp 实现
+void setup();
+void loop();
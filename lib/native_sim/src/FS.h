@@ -0,0 +1,76 @@
+#pragma once
+// native 环境的 FS：SD 卡根目录映射到主机上的一个目录（SIM_SD_ROOT，默认 ./sim_sd）
+#include "Arduino.h"
+#include <memory>
+#include <time.h>
+
+#define FILE_READ "r"
+#define FILE_WRITE "w"
+#define FILE_APPEND "a"
+
+enum SeekMode
+{
+    SeekSet = 0,
+    SeekCur = 1,
+    SeekEnd = 2
+};
+
+namespace fs
+{
+    struct FileImpl;
+
+    class File
+    {
+    public:
+        File() {}
+        explicit File(std::shared_ptr<FileImpl> p) : impl(p) {}
+
+        operator bool() const;
+        // 与 ESP32 Arduino 2.x 一致：name() 只有文件名，path() 是卡内完整路径
+        const char *name() const;
+        const char *path() const;
+        bool isDirectory();
+        File openNextFile(const char *mode = FILE_READ);
+        void rewindDirectory();
+
+        size_t size() const;
+        size_t position() const;
+        int available();
+        bool seek(uint32_t pos, SeekMode mode = SeekSet);
+        size_t read(uint8_t *buf, size_t len);
+        int read();
+        size_t write(const uint8_t *buf, size_t len);
+        size_t write(uint8_t c) { return write(&c, 1); }
+        void flush();
+        time_t getLastWrite();
+        void close();
+
+    private:
+        std::shared_ptr<FileImpl> impl;
+    };
+
+    class FS
+    {
+    public:
+        File open(const char *path, const char *mode = FILE_READ, bool create = false);
+        File open(const String &path, const char *mode = FILE_READ, bool create = false)
+        {
+            return open(path.c_str(), mode, create);
+        }
+        bool exists(const char *path);
+        bool exists(const String &path) { return exists(path.c_str()); }
+        bool mkdir(const char *path);
+        bool rmdir(const char *path);
+        bool remove(const char *path);
+        bool rename(const char *from, const char *to);
+
+        // 模拟层：卡内路径 -> 主机路径
+        std::string hostPath(const char *path) const;
+
+    protected:
+        std::string root;
+    };
+}
+
+using fs::File;
+using fs::FS;
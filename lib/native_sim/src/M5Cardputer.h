@@ -0,0 +1,168 @@
+#pragma once
+// native 环境的显示替身：M5Canvas / M5GFX 的软件帧缓冲实现，只覆盖本项目用到的接口。
+// 像素按 RGB565 大端（屏幕字节序）存放，和设备上的画布内存布局一致。
+// 颜色参数的解释沿用 LovyanGFX：int / uint16_t 为 RGB565，uint32_t 为 RGB888，uint8_t 为 RGB332。
+// 文字不做真实字形，每个字符画成一个按字体宽高缩放的小块，版面位置与设备一致
+#include "Arduino.h"
+
+#define BLACK 0x0000
+#define WHITE 0xFFFF
+#define RED 0xF800
+#define GREEN 0x07E0
+#define BLUE 0x001F
+#define CYAN 0x07FF
+#define MAGENTA 0xF81F
+#define YELLOW 0xFFE0
+
+namespace fonts
+{
+    struct SimFont
+    {
+        uint8_t asciiW; // ASCII 字符宽
+        uint8_t wideW;  // 全角字符宽
+        uint8_t height;
+    };
+    extern const SimFont Font0;
+    extern const SimFont efontCN_16;
+}
+
+// 按 LovyanGFX 的规则把各种颜色类型统一成 RGB565
+struct SimColor
+{
+    uint16_t rgb565;
+    SimColor(uint8_t c) : rgb565((uint16_t)(((c & 0xE0) << 8) | ((c & 0x1C) << 6) | ((c & 0x03) << 3))) {}
+    SimColor(uint16_t c) : rgb565(c) {}
+    SimColor(int c) : rgb565((uint16_t)c) {}
+    SimColor(uint32_t c) : rgb565((uint16_t)(((c >> 8) & 0xF800) | ((c >> 5) & 0x07E0) | ((c >> 3) & 0x001F))) {}
+};
+
+class LGFXBase
+{
+public:
+    virtual ~LGFXBase() {}
+
+    int32_t width() const { return w; }
+    int32_t height() const { return h; }
+    static uint16_t color565(uint8_t r, uint8_t g, uint8_t b)
+    {
+        return (uint16_t)(((r >> 3) << 11) | ((g >> 2) << 5) | (b >> 3));
+    }
+
+    void fillScreen(SimColor c) { fillRect(0, 0, w, h, c); }
+    void fillRect(int32_t x, int32_t y, int32_t rw, int32_t rh, SimColor c);
+    void drawRect(int32_t x, int32_t y, int32_t rw, int32_t rh, SimColor c);
+    void drawFastHLine(int32_t x, int32_t y, int32_t len, SimColor c) { fillRect(x, y, len, 1, c); }
+    void drawFastVLine(int32_t x, int32_t y, int32_t len, SimColor c) { fillRect(x, y, 1, len, c); }
+    void drawPixel(int32_t x, int32_t y, SimColor c) { fillRect(x, y, 1, 1, c); }
+    void drawLine(int32_t x0, int32_t y0, int32_t x1, int32_t y1, SimColor c);
+
+    void setClipRect(int32_t x, int32_t y, int32_t cw, int32_t ch);
+    void clearClipRect();
+
+    void setFont(const fonts::SimFont *f) { font = f; }
+    void setTextSize(float s) { textSize = s > 0 ? s : 1; }
+    void setTextColor(SimColor fg) { textFg = fg.rgb565; }
+    void setTextColor(SimColor fg, SimColor bg)
+    {
+        (void)bg;
+        textFg = fg.rgb565;
+    }
+    void setCursor(int32_t x, int32_t y)
+    {
+        cursorX = x;
+        cursorY = y;
+    }
+    int32_t textWidth(const char *s);
+    int32_t textWidth(const String &s) { return textWidth(s.c_str()); }
+    int32_t fontHeight() const;
+    int32_t drawString(const char *s, int32_t x, int32_t y);
+    int32_t drawString(const String &s, int32_t x, int32_t y) { return drawString(s.c_str(), x, y); }
+    int32_t drawCenterString(const char *s, int32_t x, int32_t y) { return drawString(s, x - textWidth(s) / 2, y); }
+    int32_t drawCenterString(const String &s, int32_t x, int32_t y) { return drawCenterString(s.c_str(), x, y); }
+    int32_t drawRightString(const char *s, int32_t x, int32_t y) { return drawString(s, x - textWidth(s), y); }
+    int32_t drawRightString(const String &s, int32_t x, int32_t y) { return drawRightString(s.c_str(), x, y); }
+    size_t print(const char *s);
+    size_t print(const String &s) { return print(s.c_str()); }
+
+    // 模拟层：按 PPM（P6）导出当前像素
+    bool dumpPPM(const char *path) const;
+
+protected:
+    void resize(int32_t nw, int32_t nh);
+    void putSpan(int32_t x, int32_t y, int32_t len, uint16_t rgb565);
+
+    int32_t w = 0;
+    int32_t h = 0;
+    uint16_t *buf = nullptr;
+
+    int32_t clipX0 = 0, clipY0 = 0, clipX1 = 0, clipY1 = 0; // [x0, x1)
+    const fonts::SimFont *font = &fonts::Font0;
+    float textSize = 1;
+    uint16_t textFg = WHITE;
+    int32_t cursorX = 0, cursorY = 0;
+};
+
+// 屏幕：240x135 帧缓冲，推送接口直接写入
+class M5GFX : public LGFXBase
+{
+public:
+    M5GFX();
+    bool init() { return true; }
+    bool begin() { return true; }
+    void setRotation(uint8_t r) { (void)r; }
+    void setBrightness(uint8_t b) { (void)b; }
+
+    void startWrite() {}
+    void endWrite() {}
+    void setAddrWindow(int32_t x, int32_t y, int32_t aw, int32_t ah);
+    // swap=false 表示数据已是屏幕字节序
+    void writePixels(const uint16_t *data, int32_t len, bool swap = true);
+    void writePixelsDMA(const uint16_t *data, int32_t len, bool swap = true) { writePixels(data, len, swap); }
+    void pushPixels(const uint16_t *data, int32_t len, bool swap = true) { writePixels(data, len, swap); }
+    void pushPixelsDMA(const uint16_t *data, int32_t len, bool swap = true) { writePixels(data, len, swap); }
+    void initDMA() {}
+    void waitDMA() {}
+    bool dmaBusy() { return false; }
+
+    void pushBlock(const uint16_t *data, int32_t x, int32_t y, int32_t bw, int32_t bh);
+
+    // 模拟层：累计写入屏幕的像素数
+    uint64_t pixelsWritten() const { return written; }
+
+private:
+    int32_t winX = 0, winY = 0, winW = 0, winH = 0;
+    int32_t winPos = 0;
+    uint64_t written = 0;
+};
+
+class M5Canvas : public LGFXBase
+{
+public:
+    M5Canvas() {}
+    explicit M5Canvas(M5GFX *parent) : parent(parent) {}
+    virtual ~M5Canvas() override { deleteSprite(); }
+
+    void setPsram(bool on) { (void)on; }
+    void setColorDepth(int bits) { (void)bits; }
+    void *createSprite(int32_t sw, int32_t sh);
+    void deleteSprite();
+    void *getBuffer() { return buf; }
+    void pushSprite(int32_t x, int32_t y);
+
+private:
+    M5GFX *parent = nullptr;
+};
+
+struct M5CardputerSim
+{
+    M5GFX Display;
+    template <typename Cfg>
+    void begin(const Cfg &cfg, bool keyboard = true)
+    {
+        (void)cfg;
+        (void)keyboard;
+    }
+    void update() {}
+};
+
+extern M5CardputerSim M5Cardputer;
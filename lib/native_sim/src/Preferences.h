@@ -0,0 +1,69 @@
+#pragma once
+// native 环境的 NVS：每个命名空间一个文本文件（SIM_NVS_DIR/<name>.nvs，默认 ./sim_nvs），
+// 每行 key=十六进制字节；put 之后立即整文件重写
+#include "Arduino.h"
+#include <map>
+#include <vector>
+
+class Preferences
+{
+public:
+    bool begin(const char *name, bool readOnly = false, const char *partition = nullptr);
+    void end();
+    bool clear();
+    bool remove(const char *key);
+    bool isKey(const char *key);
+    size_t freeEntries() { return 256; }
+
+    size_t putChar(const char *key, int8_t v) { return putRaw(key, &v, sizeof(v)); }
+    size_t putUChar(const char *key, uint8_t v) { return putRaw(key, &v, sizeof(v)); }
+    size_t putShort(const char *key, int16_t v) { return putRaw(key, &v, sizeof(v)); }
+    size_t putUShort(const char *key, uint16_t v) { return putRaw(key, &v, sizeof(v)); }
+    size_t putInt(const char *key, int32_t v) { return putRaw(key, &v, sizeof(v)); }
+    size_t putUInt(const char *key, uint32_t v) { return putRaw(key, &v, sizeof(v)); }
+    size_t putLong(const char *key, int32_t v) { return putRaw(key, &v, sizeof(v)); }
+    size_t putULong(const char *key, uint32_t v) { return putRaw(key, &v, sizeof(v)); }
+    size_t putLong64(const char *key, int64_t v) { return putRaw(key, &v, sizeof(v)); }
+    size_t putULong64(const char *key, uint64_t v) { return putRaw(key, &v, sizeof(v)); }
+    size_t putBool(const char *key, bool v) { return putUChar(key, v ? 1 : 0); }
+    size_t putString(const char *key, const char *v) { return putRaw(key, v, strlen(v) + 1); }
+    size_t putString(const char *key, const String &v) { return putString(key, v.c_str()); }
+    size_t putBytes(const char *key, const void *v, size_t len) { return putRaw(key, v, len); }
+
+    int8_t getChar(const char *key, int8_t def = 0) { return getAs(key, def); }
+    uint8_t getUChar(const char *key, uint8_t def = 0) { return getAs(key, def); }
+    int16_t getShort(const char *key, int16_t def = 0) { return getAs(key, def); }
+    uint16_t getUShort(const char *key, uint16_t def = 0) { return getAs(key, def); }
+    int32_t getInt(const char *key, int32_t def = 0) { return getAs(key, def); }
+    uint32_t getUInt(const char *key, uint32_t def = 0) { return getAs(key, def); }
+    int32_t getLong(const char *key, int32_t def = 0) { return getAs(key, def); }
+    uint32_t getULong(const char *key, uint32_t def = 0) { return getAs(key, def); }
+    int64_t getLong64(const char *key, int64_t def = 0) { return getAs(key, def); }
+    uint64_t getULong64(const char *key, uint64_t def = 0) { return getAs(key, def); }
+    bool getBool(const char *key, bool def = false) { return getUChar(key, def ? 1 : 0) != 0; }
+    String getString(const char *key, const String &def = String());
+    size_t getString(const char *key, char *buf, size_t maxLen);
+    size_t getBytesLength(const char *key);
+    size_t getBytes(const char *key, void *buf, size_t maxLen);
+
+private:
+    size_t putRaw(const char *key, const void *v, size_t len);
+    const std::vector<uint8_t> *find(const char *key) const;
+    bool save();
+
+    template <typename T>
+    T getAs(const char *key, T def)
+    {
+        const std::vector<uint8_t> *v = find(key);
+        if (!v || v->size() != sizeof(T))
+            return def;
+        T out;
+        memcpy(&out, v->data(), sizeof(T));
+        return out;
+    }
+
+    std::string file;
+    bool opened = false;
+    bool readOnly = false;
+    std::map<std::string, std::vector<uint8_t>> kv;
+};
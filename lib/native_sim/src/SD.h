@@ -0,0 +1,30 @@
+#pragma once
+#include "FS.h"
+
+typedef enum
+{
+    CARD_NONE,
+    CARD_MMC,
+    CARD_SD,
+    CARD_SDHC,
+    CARD_UNKNOWN
+} sdcard_type_t;
+
+class SPIClass;
+
+class SDFS : public fs::FS
+{
+public:
+    // 引脚和时钟参数只为和设备上的签名一致；根目录不存在时返回 false
+    bool begin(uint8_t ssPin = 0, SPIClass *spi = nullptr, uint32_t frequency = 0);
+    void end();
+    sdcard_type_t cardType();
+    uint64_t cardSize();
+    uint64_t totalBytes();
+    uint64_t usedBytes();
+
+private:
+    bool mounted = false;
+};
+
+extern SDFS SD;
@@ -0,0 +1,41 @@
+#pragma once
+// 主机上所有内存都是同一个堆，caps 只用来区分统计口径
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+#define MALLOC_CAP_EXEC (1 << 0)
+#define MALLOC_CAP_32BIT (1 << 1)
+#define MALLOC_CAP_8BIT (1 << 2)
+#define MALLOC_CAP_DMA (1 << 3)
+#define MALLOC_CAP_SPIRAM (1 << 10)
+#define MALLOC_CAP_INTERNAL (1 << 11)
+#define MALLOC_CAP_DEFAULT (1 << 12)
+
+inline void *heap_caps_malloc(size_t size, uint32_t caps)
+{
+    (void)caps;
+    return malloc(size);
+}
+
+inline void *heap_caps_calloc(size_t n, size_t size, uint32_t caps)
+{
+    (void)caps;
+    return calloc(n, size);
+}
+
+inline void *heap_caps_realloc(void *p, size_t size, uint32_t caps)
+{
+    (void)caps;
+    return realloc(p, size);
+}
+
+inline void heap_caps_free(void *p)
+{
+    free(p);
+}
+
+// 内部 RAM 按 malloc 实际占用变化；PSRAM 按 Cardputer（8MB 版本）报固定值
+size_t heap_caps_get_free_size(uint32_t caps);
+size_t heap_caps_get_largest_free_block(uint32_t caps);
+size_t heap_caps_get_minimum_free_size(uint32_t caps);
@@ -0,0 +1,46 @@
+#pragma once
+// native 环境的 FreeRTOS 替身：任务是 pthread，队列/信号量/任务通知用互斥量 + 条件变量实现。
+// 1 tick = 1ms；优先级和核心绑定只记录不生效，由主机调度器决定
+#include <stdint.h>
+#include <stddef.h>
+#include <mutex>
+
+typedef int32_t BaseType_t;
+typedef uint32_t UBaseType_t;
+typedef uint32_t TickType_t;
+
+struct SimTask;
+struct SimQueue;
+struct SimSemaphore;
+typedef SimTask *TaskHandle_t;
+typedef SimQueue *QueueHandle_t;
+typedef SimSemaphore *SemaphoreHandle_t;
+
+#define pdTRUE 1
+#define pdFALSE 0
+#define pdPASS 1
+#define pdFAIL 0
+#define portMAX_DELAY 0xFFFFFFFFu
+#define configTICK_RATE_HZ 1000
+#define portTICK_PERIOD_MS 1
+#define pdMS_TO_TICKS(ms) ((TickType_t)(ms))
+#define tskNO_AFFINITY 0x7FFFFFFF
+#define tskIDLE_PRIORITY 0
+
+// 调用者所在的核心：返回任务创建时绑定的核心（不绑定的算 0，loop() 算 1），便于日志核对分工
+BaseType_t xPortGetCoreID();
+
+// 临界区：多核上是自旋锁，这里用递归互斥量
+struct portMUX_TYPE
+{
+    std::recursive_mutex m;
+};
+#define portMUX_INITIALIZER_UNLOCKED {}
+#define portENTER_CRITICAL(mux) (mux)->m.lock()
+#define portEXIT_CRITICAL(mux) (mux)->m.unlock()
+#define portENTER_CRITICAL_ISR(mux) (mux)->m.lock()
+#define portEXIT_CRITICAL_ISR(mux) (mux)->m.unlock()
+
+// 主机上没有中断上下文
+inline BaseType_t xPortInIsrContext() { return pdFALSE; }
+#define portYIELD_FROM_ISR(x) ((void)(x))
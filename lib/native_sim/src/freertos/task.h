@@ -0,0 +1,20 @@
+#pragma once
+#include "freertos/FreeRTOS.h"
+
+typedef void (*TaskFunction_t)(void *);
+
+BaseType_t xTaskCreatePinnedToCore(TaskFunction_t fn, const char *name, uint32_t stackBytes, void *arg,
+                                   UBaseType_t prio, TaskHandle_t *handle, BaseType_t core);
+BaseType_t xTaskCreate(TaskFunction_t fn, const char *name, uint32_t stackBytes, void *arg,
+                       UBaseType_t prio, TaskHandle_t *handle);
+// 只支持删除自己（NULL 或自身句柄），和本项目的用法一致
+void vTaskDelete(TaskHandle_t task);
+void vTaskDelay(TickType_t ticks);
+TickType_t xTaskGetTickCount();
+TaskHandle_t xTaskGetCurrentTaskHandle();
+// 和 ESP-IDF 一样以字节为单位，相对创建任务时申请的栈大小；loop() 所在的主线程不可测，返回 0
+UBaseType_t uxTaskGetStackHighWaterMark(TaskHandle_t task);
+
+void xTaskNotifyGive(TaskHandle_t task);
+void vTaskNotifyGiveFromISR(TaskHandle_t task, BaseType_t *woken);
+uint32_t ulTaskNotifyTake(BaseType_t clearOnExit, TickType_t ticks);
@@ -0,0 +1,13 @@
+#pragma once
+#include <stdint.h>
+
+// 模拟层自身的控制接口（设备上不存在）。
+// 运行参数全部走环境变量，见 README 的 native 一节
+const char *simEnv(const char *name, const char *def);
+uint32_t simEnvInt(const char *name, uint32_t def);
+
+// 请求退出：主循环在当前一轮 loop() 结束后执行退出回调，然后结束进程
+void simRequestQuit(int code);
+bool simQuitRequested();
+// 退出前按注册顺序调用（写完 WAV 头、导出最后一帧等）
+void simAtExit(void (*fn)());
@@ -0,0 +1,217 @@
+#include "Arduino.h"
+#include "sim.h"
+#include "esp_heap_caps.h"
+#include <malloc.h>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <random>
+#include <vector>
+#include <unistd.h>
+
+static const auto g_start = std::chrono::steady_clock::now();
+
+uint32_t millis()
+{
+    return (uint32_t)std::chrono::duration_cast<std::chrono::milliseconds>(
+               std::chrono::steady_clock::now() - g_start)
+        .count();
+}
+
+uint32_t micros()
+{
+    return (uint32_t)std::chrono::duration_cast<std::chrono::microseconds>(
+               std::chrono::steady_clock::now() - g_start)
+        .count();
+}
+
+void delay(uint32_t ms)
+{
+    std::this_thread::sleep_for(std::chrono::milliseconds(ms));
+}
+
+void delayMicroseconds(uint32_t us)
+{
+    std::this_thread::sleep_for(std::chrono::microseconds(us));
+}
+
+void yield()
+{
+    std::this_thread::yield();
+}
+
+// 固定种子，同一份输入脚本每次跑出来的随机播放顺序一致
+static std::mt19937 g_rng(1);
+static std::mutex g_rngLock;
+
+long random(long max)
+{
+    return max <= 0 ? 0 : random(0, max);
+}
+
+long random(long min, long max)
+{
+    if (max <= min)
+        return min;
+    std::lock_guard<std::mutex> lk(g_rngLock);
+    return min + (long)(g_rng() % (uint32_t)(max - min));
+}
+
+void randomSeed(unsigned long seed)
+{
+    std::lock_guard<std::mutex> lk(g_rngLock);
+    g_rng.seed((uint32_t)seed);
+}
+
+long map(long x, long inMin, long inMax, long outMin, long outMax)
+{
+    if (inMax == inMin)
+        return outMin;
+    return (x - inMin) * (outMax - outMin) / (inMax - inMin) + outMin;
+}
+
+bool psramFound()
+{
+    return simEnvInt("SIM_PSRAM", 1) != 0;
+}
+
+// ==========================
+// 串口
+// ==========================
+HardwareSerial Serial;
+
+size_t Print::printf(const char *fmt, ...)
+{
+    char buf[512];
+    va_list ap;
+    va_start(ap, fmt);
+    int n = vsnprintf(buf, sizeof(buf), fmt, ap);
+    va_end(ap);
+    if (n < 0)
+        return 0;
+    if (n >= (int)sizeof(buf))
+        n = sizeof(buf) - 1;
+    return write((const uint8_t *)buf, n);
+}
+
+size_t HardwareSerial::write(uint8_t c)
+{
+    return write(&c, 1);
+}
+
+size_t HardwareSerial::write(const uint8_t *buf, size_t len)
+{
+    return fwrite(buf, 1, len, stdout);
+}
+
+void HardwareSerial::flush()
+{
+    fflush(stdout);
+}
+
+// ==========================
+// ESP / 堆
+// ==========================
+EspClass ESP;
+
+// 主机堆按名义大小报告：绝对值没有意义，但随 malloc/free 变化，前后差值就是真实的分配量
+#define SIM_INTERNAL_HEAP (256u * 1024 * 1024)
+#define SIM_PSRAM_SIZE (8 * 1024 * 1024)
+
+static size_t heapInUse()
+{
+    struct mallinfo2 mi = mallinfo2();
+    return mi.uordblks + mi.hblkhd;
+}
+
+uint32_t EspClass::getFreeHeap() { return heap_caps_get_free_size(MALLOC_CAP_INTERNAL); }
+uint32_t EspClass::getMinFreeHeap() { return getFreeHeap(); }
+uint32_t EspClass::getMaxAllocHeap() { return getFreeHeap(); }
+uint32_t EspClass::getFreePsram() { return psramFound() ? SIM_PSRAM_SIZE : 0; }
+uint32_t EspClass::getPsramSize() { return psramFound() ? SIM_PSRAM_SIZE : 0; }
+
+void EspClass::restart()
+{
+    simRequestQuit(0);
+}
+
+size_t heap_caps_get_free_size(uint32_t caps)
+{
+    // 只有一个堆，所有分配都记在内部 RAM 上，PSRAM 报固定值
+    if (caps & MALLOC_CAP_SPIRAM)
+        return psramFound() ? SIM_PSRAM_SIZE : 0;
+    size_t used = heapInUse();
+    return used < SIM_INTERNAL_HEAP ? SIM_INTERNAL_HEAP - used : 0;
+}
+
+size_t heap_caps_get_largest_free_block(uint32_t caps)
+{
+    return heap_caps_get_free_size(caps);
+}
+
+size_t heap_caps_get_minimum_free_size(uint32_t caps)
+{
+    return heap_caps_get_free_size(caps);
+}
+
+// ==========================
+// 运行控制
+// ==========================
+static std::atomic<bool> g_quit(false);
+static std::atomic<int> g_exitCode(0);
+static std::vector<void (*)()> g_exitHooks;
+
+const char *simEnv(const char *name, const char *def)
+{
+    const char *v = getenv(name);
+    return v && v[0] ? v : def;
+}
+
+uint32_t simEnvInt(const char *name, uint32_t def)
+{
+    const char *v = getenv(name);
+    return v && v[0] ? (uint32_t)strtoul(v, nullptr, 0) : def;
+}
+
+void simRequestQuit(int code)
+{
+    g_exitCode.store(code);
+    g_quit.store(true);
+}
+
+bool simQuitRequested()
+{
+    return g_quit.load();
+}
+
+void simAtExit(void (*fn)())
+{
+    g_exitHooks.push_back(fn);
+}
+
+// Arduino 的 loopTask：setup() 一次，之后反复 loop()。
+// SIM_DURATION_MS 到时或有人调用 simRequestQuit() 后执行退出回调，
+// 其它任务还在跑，不走全局析构，直接 _exit
+// pio test 时 main() 由测试用例（Unity）提供
+#ifndef PIO_UNIT_TESTING
+int main()
+{
+    setvbuf(stdout, nullptr, _IOLBF, 0);
+    uint32_t duration = simEnvInt("SIM_DURATION_MS", 0);
+
+    setup();
+    while (!g_quit.load())
+    {
+        loop();
+        if (duration && millis() >= duration)
+            simRequestQuit(0);
+        yield();
+    }
+
+    for (auto fn : g_exitHooks)
+        fn();
+    fflush(stdout);
+    fflush(stderr);
+    _exit(g_exitCode.load());
+}
+#endif
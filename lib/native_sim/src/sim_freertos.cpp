@@ -0,0 +1,359 @@
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/queue.h"
+#include "freertos/semphr.h"
+#include <pthread.h>
+#include <sys/mman.h>
+#include <chrono>
+#include <thread>
+#include <condition_variable>
+#include <vector>
+#include <string.h>
+#include <stdio.h>
+
+struct SimTask
+{
+    TaskFunction_t fn;
+    void *arg;
+    char name[16];
+    pthread_t thread;
+    uint8_t *stackBase = nullptr; // 自行分配并填充的线程栈，用于统计栈水位
+    size_t stackSize = 0;
+    size_t stackRequested = 0; // 调用方申请的大小，水位按它换算
+    int core = 1;              // 绑定的核心，只用于 xPortGetCoreID()；loop() 在核心 1
+
+    std::mutex m;
+    std::condition_variable cv;
+    uint32_t notify = 0;
+};
+
+struct SimQueue
+{
+    std::mutex m;
+    std::condition_variable notEmpty;
+    std::condition_variable notFull;
+    std::vector<uint8_t> buf;
+    uint32_t itemSize;
+    uint32_t length;
+    uint32_t head = 0;
+    uint32_t count = 0;
+};
+
+struct SimSemaphore
+{
+    std::mutex m;
+    std::condition_variable cv;
+    uint32_t count;
+    uint32_t max;
+};
+
+#define SIM_STACK_FILL 0xA5
+
+static thread_local SimTask *t_self = nullptr;
+
+// loop() 所在的主线程第一次用到任务接口时补一个句柄
+static SimTask *selfTask()
+{
+    if (!t_self)
+    {
+        t_self = new SimTask();
+        t_self->fn = nullptr;
+        t_self->arg = nullptr;
+        strncpy(t_self->name, "loopTask", sizeof(t_self->name));
+        t_self->thread = pthread_self();
+    }
+    return t_self;
+}
+
+// 按 tick 等待：portMAX_DELAY 永久等，0 不等
+template <typename Pred>
+static bool waitFor(std::condition_variable &cv, std::unique_lock<std::mutex> &lk, TickType_t ticks, Pred pred)
+{
+    if (ticks == portMAX_DELAY)
+    {
+        cv.wait(lk, pred);
+        return true;
+    }
+    return cv.wait_for(lk, std::chrono::milliseconds(ticks), pred);
+}
+
+// ==========================
+// 任务
+// ==========================
+static void *taskEntry(void *p)
+{
+    SimTask *t = (SimTask *)p;
+    t_self = t;
+    pthread_setname_np(pthread_self(), t->name);
+    t->fn(t->arg);
+    // FreeRTOS 的任务函数不允许返回
+    fprintf(stderr, "[SIM] task %s returned without vTaskDelete\n", t->name);
+    return nullptr;
+}
+
+BaseType_t xTaskCreatePinnedToCore(TaskFunction_t fn, const char *name, uint32_t stackBytes, void *arg,
+                                   UBaseType_t prio, TaskHandle_t *handle, BaseType_t core)
+{
+    (void)prio;
+    SimTask *t = new SimTask();
+    t->core = core == tskNO_AFFINITY ? 0 : core;
+    t->fn = fn;
+    t->arg = arg;
+    strncpy(t->name, name ? name : "task", sizeof(t->name) - 1);
+    t->name[sizeof(t->name) - 1] = '\0';
+
+    // 主机上的库比设备上吃栈，至少给 256KB；和 FreeRTOS 一样先填满 0xA5，水位按未被改写的字节数计算
+    size_t stack = stackBytes < 256 * 1024 ? 256 * 1024 : stackBytes;
+    void *mem = mmap(nullptr, stack, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (mem == MAP_FAILED)
+    {
+        delete t;
+        return pdFAIL;
+    }
+    memset(mem, SIM_STACK_FILL, stack);
+    t->stackBase = (uint8_t *)mem;
+    t->stackSize = stack;
+    t->stackRequested = stackBytes;
+
+    pthread_attr_t attr;
+    pthread_attr_init(&attr);
+    pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_DETACHED);
+    pthread_attr_setstack(&attr, mem, stack);
+    int rc = pthread_create(&t->thread, &attr, taskEntry, t);
+    pthread_attr_destroy(&attr);
+    if (rc != 0)
+    {
+        munmap(mem, stack);
+        delete t;
+        return pdFAIL;
+    }
+    if (handle)
+        *handle = t;
+    return pdPASS;
+}
+
+BaseType_t xTaskCreate(TaskFunction_t fn, const char *name, uint32_t stackBytes, void *arg,
+                       UBaseType_t prio, TaskHandle_t *handle)
+{
+    return xTaskCreatePinnedToCore(fn, name, stackBytes, arg, prio, handle, tskNO_AFFINITY);
+}
+
+BaseType_t xPortGetCoreID()
+{
+    return selfTask()->core;
+}
+
+void vTaskDelete(TaskHandle_t task)
+{
+    if (task && task != t_self)
+    {
+        fprintf(stderr, "[SIM] vTaskDelete of another task is not supported\n");
+        return;
+    }
+    // 句柄可能仍被别的任务持有（例如还会收到通知），不释放
+    pthread_exit(nullptr);
+}
+
+void vTaskDelay(TickType_t ticks)
+{
+    if (ticks == 0)
+        std::this_thread::yield();
+    else
+        std::this_thread::sleep_for(std::chrono::milliseconds(ticks));
+}
+
+TickType_t xTaskGetTickCount()
+{
+    static const auto start = std::chrono::steady_clock::now();
+    return (TickType_t)std::chrono::duration_cast<std::chrono::milliseconds>(
+               std::chrono::steady_clock::now() - start)
+        .count();
+}
+
+TaskHandle_t xTaskGetCurrentTaskHandle()
+{
+    return selfTask();
+}
+
+UBaseType_t uxTaskGetStackHighWaterMark(TaskHandle_t task)
+{
+    SimTask *t = task ? task : selfTask();
+    if (!t->stackBase)
+        return 0;
+    // 栈向下增长，从低地址数起连续未改写的字节；实际分配的栈可能比申请的大，剩余量按申请的大小换算
+    size_t n = 0;
+    while (n < t->stackSize && t->stackBase[n] == SIM_STACK_FILL)
+        n++;
+    size_t used = t->stackSize - n;
+    return used < t->stackRequested ? (UBaseType_t)(t->stackRequested - used) : 0;
+}
+
+void xTaskNotifyGive(TaskHandle_t task)
+{
+    if (!task)
+        return;
+    {
+        std::lock_guard<std::mutex> lk(task->m);
+        task->notify++;
+    }
+    task->cv.notify_one();
+}
+
+void vTaskNotifyGiveFromISR(TaskHandle_t task, BaseType_t *woken)
+{
+    xTaskNotifyGive(task);
+    if (woken)
+        *woken = pdFALSE;
+}
+
+uint32_t ulTaskNotifyTake(BaseType_t clearOnExit, TickType_t ticks)
+{
+    SimTask *t = selfTask();
+    std::unique_lock<std::mutex> lk(t->m);
+    waitFor(t->cv, lk, ticks, [t]
+            { return t->notify > 0; });
+    uint32_t v = t->notify;
+    if (v > 0)
+        t->notify = clearOnExit ? 0 : v - 1;
+    return v;
+}
+
+// ==========================
+// 队列
+// ==========================
+QueueHandle_t xQueueCreate(UBaseType_t length, UBaseType_t itemSize)
+{
+    SimQueue *q = new SimQueue();
+    q->itemSize = itemSize;
+    q->length = length;
+    q->buf.resize((size_t)length * itemSize);
+    return q;
+}
+
+void vQueueDelete(QueueHandle_t q)
+{
+    delete q;
+}
+
+BaseType_t xQueueSend(QueueHandle_t q, const void *item, TickType_t ticks)
+{
+    std::unique_lock<std::mutex> lk(q->m);
+    if (!waitFor(q->notFull, lk, ticks, [q]
+                 { return q->count < q->length; }))
+        return pdFALSE;
+    uint32_t slot = (q->head + q->count) % q->length;
+    memcpy(&q->buf[(size_t)slot * q->itemSize], item, q->itemSize);
+    q->count++;
+    lk.unlock();
+    q->notEmpty.notify_one();
+    return pdTRUE;
+}
+
+BaseType_t xQueueSendToBack(QueueHandle_t q, const void *item, TickType_t ticks)
+{
+    return xQueueSend(q, item, ticks);
+}
+
+BaseType_t xQueueSendFromISR(QueueHandle_t q, const void *item, BaseType_t *woken)
+{
+    if (woken)
+        *woken = pdFALSE;
+    return xQueueSend(q, item, 0);
+}
+
+BaseType_t xQueueReceive(QueueHandle_t q, void *item, TickType_t ticks)
+{
+    std::unique_lock<std::mutex> lk(q->m);
+    if (!waitFor(q->notEmpty, lk, ticks, [q]
+                 { return q->count > 0; }))
+        return pdFALSE;
+    memcpy(item, &q->buf[(size_t)q->head * q->itemSize], q->itemSize);
+    q->head = (q->head + 1) % q->length;
+    q->count--;
+    lk.unlock();
+    q->notFull.notify_one();
+    return pdTRUE;
+}
+
+UBaseType_t uxQueueMessagesWaiting(QueueHandle_t q)
+{
+    std::lock_guard<std::mutex> lk(q->m);
+    return q->count;
+}
+
+BaseType_t xQueueReset(QueueHandle_t q)
+{
+    {
+        std::lock_guard<std::mutex> lk(q->m);
+        q->head = 0;
+        q->count = 0;
+    }
+    q->notFull.notify_all();
+    return pdPASS;
+}
+
+// ==========================
+// 信号量
+// ==========================
+static SimSemaphore *newSemaphore(uint32_t max, uint32_t initial)
+{
+    SimSemaphore *s = new SimSemaphore();
+    s->max = max;
+    s->count = initial;
+    return s;
+}
+
+SemaphoreHandle_t xSemaphoreCreateMutex()
+{
+    return newSemaphore(1, 1);
+}
+
+SemaphoreHandle_t xSemaphoreCreateBinary()
+{
+    return newSemaphore(1, 0);
+}
+
+SemaphoreHandle_t xSemaphoreCreateCounting(UBaseType_t maxCount, UBaseType_t initial)
+{
+    return newSemaphore(maxCount, initial);
+}
+
+void vSemaphoreDelete(SemaphoreHandle_t s)
+{
+    delete s;
+}
+
+BaseType_t xSemaphoreTake(SemaphoreHandle_t s, TickType_t ticks)
+{
+    std::unique_lock<std::mutex> lk(s->m);
+    if (!waitFor(s->cv, lk, ticks, [s]
+                 { return s->count > 0; }))
+        return pdFALSE;
+    s->count--;
+    return pdTRUE;
+}
+
+BaseType_t xSemaphoreGive(SemaphoreHandle_t s)
+{
+    {
+        std::lock_guard<std::mutex> lk(s->m);
+        if (s->count >= s->max)
+            return pdFALSE;
+        s->count++;
+    }
+    s->cv.notify_one();
+    return pdTRUE;
+}
+
+BaseType_t xSemaphoreGiveFromISR(SemaphoreHandle_t s, BaseType_t *woken)
+{
+    if (woken)
+        *woken = pdFALSE;
+    return xSemaphoreGive(s);
+}
+
+UBaseType_t uxSemaphoreGetCount(SemaphoreHandle_t s)
+{
+    std::lock_guard<std::mutex> lk(s->m);
+    return s->count;
+}
@@ -0,0 +1,268 @@
+#include "FS.h"
+#include "SD.h"
+#include "sim.h"
+#include <dirent.h>
+#include <sys/stat.h>
+#include <sys/statvfs.h>
+#include <unistd.h>
+#include <errno.h>
+
+namespace fs
+{
+    struct FileImpl
+    {
+        std::string path; // 卡内路径，以 / 开头
+        std::string host;
+        const char *leaf = "";
+        FILE *fp = nullptr;
+        DIR *dir = nullptr;
+        size_t size = 0;
+
+        ~FileImpl()
+        {
+            if (fp)
+                fclose(fp);
+            if (dir)
+                closedir(dir);
+        }
+    };
+}
+
+using fs::FileImpl;
+
+static std::string joinPath(const std::string &dir, const char *name)
+{
+    if (dir.empty() || dir.back() != '/')
+        return dir + "/" + name;
+    return dir + name;
+}
+
+static std::shared_ptr<FileImpl> openImpl(const std::string &cardPath, const std::string &host, const char *mode)
+{
+    struct stat st;
+    bool exists = stat(host.c_str(), &st) == 0;
+
+    auto f = std::make_shared<FileImpl>();
+    f->path = cardPath;
+    f->host = host;
+    size_t slash = f->path.find_last_of('/');
+    f->leaf = f->path.c_str() + (slash == std::string::npos ? 0 : slash + 1);
+
+    if (exists && S_ISDIR(st.st_mode))
+    {
+        f->dir = opendir(host.c_str());
+        return f->dir ? f : nullptr;
+    }
+
+    const char *m = "rb";
+    if (mode && mode[0] == 'w')
+        m = "w+b";
+    else if (mode && mode[0] == 'a')
+        m = "a+b";
+    else if (!exists)
+        return nullptr;
+    else if (mode && mode[1] == '+')
+        m = "r+b"; // 原地改写，不截断
+
+    f->fp = fopen(host.c_str(), m);
+    if (!f->fp)
+        return nullptr;
+    if (m[0] == 'r')
+        f->size = st.st_size;
+    else if (m[0] == 'a')
+        f->size = exists ? st.st_size : 0;
+    return f;
+}
+
+// ==========================
+// File
+// ==========================
+namespace fs
+{
+    File::operator bool() const { return impl && (impl->fp || impl->dir); }
+    const char *File::name() const { return impl ? impl->leaf : ""; }
+    const char *File::path() const { return impl ? impl->path.c_str() : ""; }
+    bool File::isDirectory() { return impl && impl->dir; }
+
+    File File::openNextFile(const char *mode)
+    {
+        if (!impl || !impl->dir)
+            return File();
+        struct dirent *e;
+        while ((e = readdir(impl->dir)) != nullptr)
+        {
+            if (strcmp(e->d_name, ".") == 0 || strcmp(e->d_name, "..") == 0)
+                continue;
+            return File(openImpl(joinPath(impl->path, e->d_name), joinPath(impl->host, e->d_name), mode));
+        }
+        return File();
+    }
+
+    void File::rewindDirectory()
+    {
+        if (impl && impl->dir)
+            rewinddir(impl->dir);
+    }
+
+    size_t File::size() const { return impl ? impl->size : 0; }
+
+    size_t File::position() const
+    {
+        if (!impl || !impl->fp)
+            return 0;
+        long p = ftell(impl->fp);
+        return p < 0 ? 0 : (size_t)p;
+    }
+
+    int File::available()
+    {
+        size_t p = position();
+        return impl && impl->size > p ? (int)(impl->size - p) : 0;
+    }
+
+    bool File::seek(uint32_t pos, SeekMode mode)
+    {
+        if (!impl || !impl->fp)
+            return false;
+        int whence = mode == SeekCur ? SEEK_CUR : (mode == SeekEnd ? SEEK_END : SEEK_SET);
+        return fseek(impl->fp, (long)pos, whence) == 0;
+    }
+
+    size_t File::read(uint8_t *buf, size_t len)
+    {
+        if (!impl || !impl->fp)
+            return 0;
+        return fread(buf, 1, len, impl->fp);
+    }
+
+    int File::read()
+    {
+        uint8_t c;
+        return read(&c, 1) == 1 ? c : -1;
+    }
+
+    size_t File::write(const uint8_t *buf, size_t len)
+    {
+        if (!impl || !impl->fp)
+            return 0;
+        size_t n = fwrite(buf, 1, len, impl->fp);
+        size_t end = position();
+        if (end > impl->size)
+            impl->size = end;
+        return n;
+    }
+
+    void File::flush()
+    {
+        if (impl && impl->fp)
+            fflush(impl->fp);
+    }
+
+    time_t File::getLastWrite()
+    {
+        struct stat st;
+        if (!impl || stat(impl->host.c_str(), &st) != 0)
+            return 0;
+        return st.st_mtime;
+    }
+
+    void File::close()
+    {
+        impl.reset();
+    }
+
+    // ==========================
+    // FS
+    // ==========================
+    std::string FS::hostPath(const char *path) const
+    {
+        std::string p = path ? path : "/";
+        if (p.empty() || p[0] != '/')
+            p = "/" + p;
+        return root + p;
+    }
+
+    File FS::open(const char *path, const char *mode, bool create)
+    {
+        (void)create;
+        std::string p = path ? path : "/";
+        if (p.empty() || p[0] != '/')
+            p = "/" + p;
+        return File(openImpl(p, hostPath(p.c_str()), mode));
+    }
+
+    bool FS::exists(const char *path)
+    {
+        struct stat st;
+        return stat(hostPath(path).c_str(), &st) == 0;
+    }
+
+    bool FS::mkdir(const char *path)
+    {
+        return ::mkdir(hostPath(path).c_str(), 0755) == 0 || errno == EEXIST;
+    }
+
+    bool FS::rmdir(const char *path)
+    {
+        return ::rmdir(hostPath(path).c_str()) == 0;
+    }
+
+    bool FS::remove(const char *path)
+    {
+        return ::unlink(hostPath(path).c_str()) == 0;
+    }
+
+    bool FS::rename(const char *from, const char *to)
+    {
+        return ::rename(hostPath(from).c_str(), hostPath(to).c_str()) == 0;
+    }
+}
+
+// ==========================
+// SD
+// ==========================
+SDFS SD;
+
+bool SDFS::begin(uint8_t ssPin, SPIClass *spi, uint32_t frequency)
+{
+    (void)ssPin;
+    (void)spi;
+    (void)frequency;
+    root = simEnv("SIM_SD_ROOT", "./sim_sd");
+    while (root.size() > 1 && root.back() == '/')
+        root.pop_back();
+    struct stat st;
+    mounted = stat(root.c_str(), &st) == 0 && S_ISDIR(st.st_mode);
+    return mounted;
+}
+
+void SDFS::end()
+{
+    mounted = false;
+}
+
+sdcard_type_t SDFS::cardType()
+{
+    return mounted ? CARD_SDHC : CARD_NONE;
+}
+
+uint64_t SDFS::cardSize()
+{
+    return totalBytes();
+}
+
+uint64_t SDFS::totalBytes()
+{
+    struct statvfs v;
+    if (!mounted || statvfs(root.c_str(), &v) != 0)
+        return 0;
+    return (uint64_t)v.f_blocks * v.f_frsize;
+}
+
+uint64_t SDFS::usedBytes()
+{
+    struct statvfs v;
+    if (!mounted || statvfs(root.c_str(), &v) != 0)
+        return 0;
+    return (uint64_t)(v.f_blocks - v.f_bfree) * v.f_frsize;
+}
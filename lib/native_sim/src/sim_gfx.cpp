@@ -0,0 +1,231 @@
+#include "M5Cardputer.h"
+#include <algorithm>
+
+namespace fonts
+{
+    const SimFont Font0 = {6, 6, 8};
+    const SimFont efontCN_16 = {8, 16, 16};
+}
+
+M5CardputerSim M5Cardputer;
+
+static inline uint16_t toPanel(uint16_t c)
+{
+    return (uint16_t)((c << 8) | (c >> 8));
+}
+
+void LGFXBase::resize(int32_t nw, int32_t nh)
+{
+    free(buf);
+    buf = nullptr;
+    w = h = 0;
+    if (nw > 0 && nh > 0)
+    {
+        buf = (uint16_t *)calloc((size_t)nw * nh, sizeof(uint16_t));
+        if (buf)
+        {
+            w = nw;
+            h = nh;
+        }
+    }
+    clearClipRect();
+}
+
+void LGFXBase::putSpan(int32_t x, int32_t y, int32_t len, uint16_t rgb565)
+{
+    if (y < clipY0 || y >= clipY1)
+        return;
+    int32_t x0 = std::max(x, clipX0);
+    int32_t x1 = std::min(x + len, clipX1);
+    uint16_t v = toPanel(rgb565);
+    for (int32_t i = x0; i < x1; i++)
+        buf[y * w + i] = v;
+}
+
+void LGFXBase::fillRect(int32_t x, int32_t y, int32_t rw, int32_t rh, SimColor c)
+{
+    if (!buf || rw <= 0 || rh <= 0)
+        return;
+    for (int32_t j = 0; j < rh; j++)
+        putSpan(x, y + j, rw, c.rgb565);
+}
+
+void LGFXBase::drawRect(int32_t x, int32_t y, int32_t rw, int32_t rh, SimColor c)
+{
+    if (rw <= 0 || rh <= 0)
+        return;
+    drawFastHLine(x, y, rw, c);
+    drawFastHLine(x, y + rh - 1, rw, c);
+    drawFastVLine(x, y, rh, c);
+    drawFastVLine(x + rw - 1, y, rh, c);
+}
+
+void LGFXBase::drawLine(int32_t x0, int32_t y0, int32_t x1, int32_t y1, SimColor c)
+{
+    int32_t dx = abs(x1 - x0), sx = x0 < x1 ? 1 : -1;
+    int32_t dy = -abs(y1 - y0), sy = y0 < y1 ? 1 : -1;
+    int32_t err = dx + dy;
+    while (true)
+    {
+        drawPixel(x0, y0, c);
+        if (x0 == x1 && y0 == y1)
+            break;
+        int32_t e2 = 2 * err;
+        if (e2 >= dy)
+        {
+            err += dy;
+            x0 += sx;
+        }
+        if (e2 <= dx)
+        {
+            err += dx;
+            y0 += sy;
+        }
+    }
+}
+
+void LGFXBase::setClipRect(int32_t x, int32_t y, int32_t cw, int32_t ch)
+{
+    clipX0 = std::max<int32_t>(x, 0);
+    clipY0 = std::max<int32_t>(y, 0);
+    clipX1 = std::min<int32_t>(x + cw, w);
+    clipY1 = std::min<int32_t>(y + ch, h);
+}
+
+void LGFXBase::clearClipRect()
+{
+    clipX0 = clipY0 = 0;
+    clipX1 = w;
+    clipY1 = h;
+}
+
+// UTF-8 逐字符取宽度：CJK 等全角字符用 wideW
+template <typename Fn>
+static int32_t walkUtf8(const char *s, const fonts::SimFont *f, float size, Fn fn)
+{
+    int32_t x = 0;
+    const uint8_t *p = (const uint8_t *)s;
+    while (p && *p)
+    {
+        uint32_t cp = *p;
+        int n = cp < 0x80 ? 1 : (cp < 0xE0 ? 2 : (cp < 0xF0 ? 3 : 4));
+        if (n > 1)
+        {
+            cp &= 0x3F >> (n - 1);
+            for (int i = 1; i < n && p[i]; i++)
+                cp = (cp << 6) | (p[i] & 0x3F);
+        }
+        for (int i = 0; i < n && *p; i++)
+            p++;
+        int32_t cw = (int32_t)((cp >= 0x2E80 ? f->wideW : f->asciiW) * size);
+        fn(cp, x, cw);
+        x += cw;
+    }
+    return x;
+}
+
+int32_t LGFXBase::textWidth(const char *s)
+{
+    return walkUtf8(s, font, textSize, [](uint32_t, int32_t, int32_t) {});
+}
+
+int32_t LGFXBase::fontHeight() const
+{
+    return (int32_t)(font->height * textSize);
+}
+
+int32_t LGFXBase::drawString(const char *s, int32_t x, int32_t y)
+{
+    int32_t fh = fontHeight();
+    return walkUtf8(s, font, textSize, [&](uint32_t cp, int32_t dx, int32_t cw)
+                    {
+        if (cp == ' ')
+            return;
+        // 字形占位：字宽留 1px 间隔，高度取字体中间一半
+        fillRect(x + dx, y + fh / 4, cw > 1 ? cw - 1 : 1, fh / 2, textFg); });
+}
+
+size_t LGFXBase::print(const char *s)
+{
+    int32_t n = drawString(s, cursorX, cursorY);
+    cursorX += n;
+    return strlen(s);
+}
+
+bool LGFXBase::dumpPPM(const char *path) const
+{
+    if (!buf)
+        return false;
+    FILE *fp = fopen(path, "wb");
+    if (!fp)
+        return false;
+    fprintf(fp, "P6\n%d %d\n255\n", (int)w, (int)h);
+    for (int32_t i = 0; i < w * h; i++)
+    {
+        uint16_t c = toPanel(buf[i]); // 屏幕字节序转回 RGB565
+        uint8_t rgb[3] = {
+            (uint8_t)(((c >> 11) & 0x1F) * 255 / 31),
+            (uint8_t)(((c >> 5) & 0x3F) * 255 / 63),
+            (uint8_t)((c & 0x1F) * 255 / 31)};
+        fwrite(rgb, 1, 3, fp);
+    }
+    fclose(fp);
+    return true;
+}
+
+// ==========================
+// 屏幕
+// ==========================
+M5GFX::M5GFX()
+{
+    resize(240, 135);
+}
+
+void M5GFX::setAddrWindow(int32_t x, int32_t y, int32_t aw, int32_t ah)
+{
+    winX = x;
+    winY = y;
+    winW = aw;
+    winH = ah;
+    winPos = 0;
+}
+
+void M5GFX::writePixels(const uint16_t *data, int32_t len, bool swap)
+{
+    for (int32_t i = 0; i < len && winW > 0; i++, winPos++)
+    {
+        int32_t px = winX + winPos % winW;
+        int32_t py = winY + winPos / winW;
+        if (py >= winY + winH)
+            break;
+        if (px >= 0 && px < w && py >= 0 && py < h)
+            buf[py * w + px] = swap ? toPanel(data[i]) : data[i];
+    }
+    written += len;
+}
+
+void M5GFX::pushBlock(const uint16_t *data, int32_t x, int32_t y, int32_t bw, int32_t bh)
+{
+    setAddrWindow(x, y, bw, bh);
+    writePixels(data, bw * bh, false);
+}
+
+// ==========================
+// 画布
+// ==========================
+void *M5Canvas::createSprite(int32_t sw, int32_t sh)
+{
+    resize(sw, sh);
+    return buf;
+}
+
+void M5Canvas::deleteSprite()
+{
+    resize(0, 0);
+}
+
+void M5Canvas::pushSprite(int32_t x, int32_t y)
+{
+    if (parent && buf)
+        parent->pushBlock(buf, x, y, w, h);
+}
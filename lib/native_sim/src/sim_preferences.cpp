@@ -0,0 +1,139 @@
+#include "Preferences.h"
+#include "sim.h"
+#include <sys/stat.h>
+#include <errno.h>
+
+// NVS 的键名上限是 15 字节，超长在设备上会失败，这里照样拒绝
+#define NVS_KEY_MAX 15
+
+bool Preferences::begin(const char *name, bool ro, const char *partition)
+{
+    (void)partition;
+    if (opened)
+        end();
+
+    std::string dir = simEnv("SIM_NVS_DIR", "./sim_nvs");
+    if (::mkdir(dir.c_str(), 0755) != 0 && errno != EEXIST)
+        return false;
+    file = dir + "/" + name + ".nvs";
+    kv.clear();
+
+    FILE *fp = fopen(file.c_str(), "r");
+    if (!fp && ro)
+        return false; // 和设备一致：只读打开不存在的命名空间会失败
+    if (fp)
+    {
+        char line[1024];
+        while (fgets(line, sizeof(line), fp))
+        {
+            char *eq = strchr(line, '=');
+            if (!eq)
+                continue;
+            *eq = '\0';
+            std::vector<uint8_t> bytes;
+            for (char *p = eq + 1; p[0] && p[1] && p[0] != '\n'; p += 2)
+            {
+                char hex[3] = {p[0], p[1], 0};
+                bytes.push_back((uint8_t)strtoul(hex, nullptr, 16));
+            }
+            kv[line] = bytes;
+        }
+        fclose(fp);
+    }
+
+    opened = true;
+    readOnly = ro;
+    return true;
+}
+
+void Preferences::end()
+{
+    opened = false;
+    kv.clear();
+}
+
+bool Preferences::save()
+{
+    std::string tmp = file + ".tmp";
+    FILE *fp = fopen(tmp.c_str(), "w");
+    if (!fp)
+        return false;
+    for (auto &e : kv)
+    {
+        fprintf(fp, "%s=", e.first.c_str());
+        for (uint8_t b : e.second)
+            fprintf(fp, "%02x", b);
+        fputc('\n', fp);
+    }
+    fclose(fp);
+    return ::rename(tmp.c_str(), file.c_str()) == 0;
+}
+
+size_t Preferences::putRaw(const char *key, const void *v, size_t len)
+{
+    if (!opened || readOnly || !key || strlen(key) > NVS_KEY_MAX)
+        return 0;
+    const uint8_t *p = (const uint8_t *)v;
+    kv[key] = std::vector<uint8_t>(p, p + len);
+    return save() ? len : 0;
+}
+
+const std::vector<uint8_t> *Preferences::find(const char *key) const
+{
+    if (!opened || !key)
+        return nullptr;
+    auto it = kv.find(key);
+    return it == kv.end() ? nullptr : &it->second;
+}
+
+bool Preferences::clear()
+{
+    if (!opened || readOnly)
+        return false;
+    kv.clear();
+    return save();
+}
+
+bool Preferences::remove(const char *key)
+{
+    if (!opened || readOnly || !kv.erase(key))
+        return false;
+    return save();
+}
+
+bool Preferences::isKey(const char *key)
+{
+    return find(key) != nullptr;
+}
+
+String Preferences::getString(const char *key, const String &def)
+{
+    const std::vector<uint8_t> *v = find(key);
+    if (!v || v->empty())
+        return def;
+    return String(std::string((const char *)v->data(), strnlen((const char *)v->data(), v->size())));
+}
+
+size_t Preferences::getString(const char *key, char *buf, size_t maxLen)
+{
+    const std::vector<uint8_t> *v = find(key);
+    if (!v || v->size() > maxLen)
+        return 0;
+    memcpy(buf, v->data(), v->size());
+    return v->size();
+}
+
+size_t Preferences::getBytesLength(const char *key)
+{
+    const std::vector<uint8_t> *v = find(key);
+    return v ? v->size() : 0;
+}
+
+size_t Preferences::getBytes(const char *key, void *buf, size_t maxLen)
+{
+    const std::vector<uint8_t> *v = find(key);
+    if (!v || v->size() > maxLen)
+        return 0;
+    memcpy(buf, v->data(), v->size());
+    return v->size();
+}
@@ -0,0 +1,62 @@
+#include "core/audio/audio_command.h"
+#include <atomic>
+#include "log.h"
+
+static_assert((AUDIO_CMD_QUEUE_SIZE & (AUDIO_CMD_QUEUE_SIZE - 1)) == 0, "AUDIO_CMD_QUEUE_SIZE must be a power of two");
+
+// head 只由生产者写，tail 只由消费者写；两者单调递增，取模得到槽位
+static AudioCommand g_ring[AUDIO_CMD_QUEUE_SIZE];
+static std::atomic<uint32_t> g_head(0);
+static std::atomic<uint32_t> g_tail(0);
+
+// 统计只由生产者写
+static uint32_t g_pushed = 0;
+static uint32_t g_dropped = 0;
+static uint32_t g_maxDepth = 0;
+
+bool audioCmdPush(AudioCmdType type, int32_t arg)
+{
+    uint32_t head = g_head.load(std::memory_order_relaxed);
+    uint32_t tail = g_tail.load(std::memory_order_acquire);
+    uint32_t depth = head - tail;
+    if (depth >= AUDIO_CMD_QUEUE_SIZE)
+    {
+        g_dropped++;
+        LOG_AUDIO("cmd queue full, dropped type %d (%lu dropped)", (int)type, (unsigned long)g_dropped);
+        return false;
+    }
+
+    AudioCommand &slot = g_ring[head & (AUDIO_CMD_QUEUE_SIZE - 1)];
+    slot.type = type;
+    slot.arg = arg;
+    // release：槽位内容先于 head 对消费者可见
+    g_head.store(head + 1, std::memory_order_release);
+
+    g_pushed++;
+    if (depth + 1 > g_maxDepth)
+        g_maxDepth = depth + 1;
+    return true;
+}
+
+bool audioCmdPop(AudioCommand &cmd)
+{
+    uint32_t tail = g_tail.load(std::memory_order_relaxed);
+    uint32_t head = g_head.load(std::memory_order_acquire);
+    if (tail == head)
+        return false;
+
+    cmd = g_ring[tail & (AUDIO_CMD_QUEUE_SIZE - 1)];
+    // release：读完槽位之后才允许生产者覆盖
+    g_tail.store(tail + 1, std::memory_order_release);
+    return true;
+}
+
+AudioCmdStats audioCmdGetStats()
+{
+    AudioCmdStats s;
+    s.pushed = g_pushed;
+    s.dropped = g_dropped;
+    s.depth = g_head.load(std::memory_order_acquire) - g_tail.load(std::memory_order_acquire);
+    s.maxDepth = g_maxDepth;
+    return s;
+}
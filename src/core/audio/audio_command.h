@@ -0,0 +1,39 @@
+#pragma once
+#include <stdint.h>
+
+// 输入循环 -> 音频任务的命令队列：单生产者（loop 所在任务）、单消费者（音频任务），无锁。
+// 容量必须是 2 的幂；队列满时新命令被丢弃并计数
+#define AUDIO_CMD_QUEUE_SIZE 16
+
+enum class AudioCmdType : uint8_t
+{
+    PLAY_TRACK, // arg = 曲目句柄（选歌、修复音频都走这里；排队期间列表可能被压缩，不用序号）
+    NEXT,       // 下一首/上一首：随机模式沿洗牌顺序，其它模式按列表序号
+    PREV,
+    RESUME,     // arg = 解码器未运行时要打开的曲目句柄
+    PAUSE,
+    STOP,
+    SEEK,       // arg = 相对当前位置的毫秒数，可为负
+    SET_VOLUME, // arg = 音量 0~100
+    SET_MUTE,   // arg = 1 静音，0 取消静音（音量保留）
+};
+
+struct AudioCommand
+{
+    AudioCmdType type;
+    int32_t arg;
+};
+
+struct AudioCmdStats
+{
+    uint32_t pushed;
+    uint32_t dropped;
+    uint32_t depth;    // 当前积压
+    uint32_t maxDepth; // 历史最大积压
+};
+
+// 只能由生产者调用；队列满返回 false
+bool audioCmdPush(AudioCmdType type, int32_t arg = 0);
+// 只能由音频任务调用；队列空返回 false
+bool audioCmdPop(AudioCommand &cmd);
+AudioCmdStats audioCmdGetStats();
@@ -0,0 +1,44 @@
+#include "core/audio/audio_format.h"
+#include <string.h>
+#include <strings.h>
+
+AudioFormat audioFormatFromName(const char *name)
+{
+    const char *dot = strrchr(name, '.');
+    if (!dot)
+        return AudioFormat::UNKNOWN;
+    if (strcasecmp(dot, ".mp3") == 0)
+        return AudioFormat::MP3;
+    if (strcasecmp(dot, ".wav") == 0)
+        return AudioFormat::WAV;
+    if (strcasecmp(dot, ".flac") == 0)
+        return AudioFormat::FLAC;
+    return AudioFormat::UNKNOWN;
+}
+
+AudioFormat audioFormatSniff(const uint8_t *buf, uint32_t len)
+{
+    if (len >= 12 && memcmp(buf, "RIFF", 4) == 0 && memcmp(buf + 8, "WAVE", 4) == 0)
+        return AudioFormat::WAV;
+    if (len >= 4 && memcmp(buf, "fLaC", 4) == 0)
+        return AudioFormat::FLAC;
+    // MPEG 帧同步（11 位）+ Layer III
+    if (len >= 2 && buf[0] == 0xFF && (buf[1] & 0xE0) == 0xE0 && ((buf[1] >> 1) & 0x03) == 0x01)
+        return AudioFormat::MP3;
+    return AudioFormat::UNKNOWN;
+}
+
+const char *audioFormatName(AudioFormat fmt)
+{
+    switch (fmt)
+    {
+    case AudioFormat::MP3:
+        return "MP3";
+    case AudioFormat::WAV:
+        return "WAV";
+    case AudioFormat::FLAC:
+        return "FLAC";
+    default:
+        return "?";
+    }
+}
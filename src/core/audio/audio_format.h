@@ -0,0 +1,28 @@
+#pragma once
+#include <stdint.h>
+
+// 曲目格式。数值写进曲库索引（TrackRecord::flags 的低位），只能追加不能改
+enum class AudioFormat : uint8_t
+{
+    UNKNOWN = 0,
+    MP3 = 1,
+    WAV = 2,
+    FLAC = 3,
+};
+#define AUDIO_FORMAT_COUNT 4
+
+// 扫描时按扩展名判断（不打开文件）；不认识的返回 UNKNOWN
+AudioFormat audioFormatFromName(const char *name);
+
+// 打开时按文件头判断（至少给 12 字节）；ID3v2 开头无法区分 MP3/FLAC，返回 UNKNOWN
+AudioFormat audioFormatSniff(const uint8_t *buf, uint32_t len);
+
+const char *audioFormatName(AudioFormat fmt);
+
+// 曲库读标签时记下的流范围：start 为所有 ID3v2 标签之后的第一个字节，end 为 ID3v1 之前（没有时为文件末尾）。
+// 打开曲目时带上它就不用从文件开头逐个读标签头、也不用读文件末尾；文件改动后由曲库作废
+struct TrackLayout
+{
+    uint32_t start;
+    uint32_t end;
+};
@@ -0,0 +1,25 @@
+#include "core/audio/audio_load.h"
+#include "platform/platform.h"
+#include <atomic>
+
+static std::atomic<uint32_t> g_decodeUs(0);
+static uint32_t g_lastSampleUs = 0;
+
+void audioLoadAddDecodeUs(uint32_t us)
+{
+    g_decodeUs.fetch_add(us, std::memory_order_relaxed);
+}
+
+AudioLoad audioLoadSample()
+{
+    uint32_t now = micros();
+    uint32_t busy = g_decodeUs.exchange(0, std::memory_order_relaxed);
+    uint32_t wall = now - g_lastSampleUs;
+    g_lastSampleUs = now;
+
+    AudioLoad l;
+    l.bufferFill = platformAudioGetBufferFill();
+    uint32_t pct = wall ? (uint32_t)((uint64_t)busy * 100 / wall) : 0;
+    l.decodeLoad = pct > 100 ? 100 : (uint8_t)pct;
+    return l;
+}
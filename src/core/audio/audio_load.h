@@ -0,0 +1,15 @@
+#pragma once
+#include <stdint.h>
+
+// 音频负载：音频任务给每次解码器 loop() 计时，UI 侧周期性取样，
+// 用来判断解码是否吃紧（帧率调节器据此降低画面开销）
+struct AudioLoad
+{
+    uint8_t bufferFill; // 输出缓冲填充量，0~100
+    uint8_t decodeLoad; // 上次取样以来解码占用的墙钟时间，0~100
+};
+
+// 音频任务调用，只做一次原子加
+void audioLoadAddDecodeUs(uint32_t us);
+// 只应由一个任务调用：解码占用率按两次调用之间的时间计算
+AudioLoad audioLoadSample();
@@ -0,0 +1,239 @@
+#include "core/audio/audio_telemetry.h"
+#include "core/audio/audio_load.h"
+#include "platform/platform.h"
+#include <atomic>
+#include <string.h>
+#include <freertos/FreeRTOS.h>
+#include "log.h"
+
+static std::atomic<bool> g_enabled(false);
+// 清零请求由 loop() 发出、音频任务执行，窗口统计始终只有一个写者
+static std::atomic<bool> g_resetReq(false);
+
+// 音频任务写
+static uint32_t g_decodeCalls = 0;
+static uint32_t g_decodeSumUs = 0;
+static uint32_t g_decodeMaxUs = 0;
+static uint32_t g_decodeHist[AUDIO_TELEM_BUCKETS];
+static uint8_t g_fillNow = 0;
+static uint8_t g_fillLow = 100;
+static uint8_t g_fillHigh = 0;
+static uint32_t g_bufferEmpties = 0;
+static uint32_t g_openMs = 0;
+static uint32_t g_openMaxMs = 0;
+static uint32_t g_firstSampleMs = 0;
+static uint32_t g_firstSampleMaxMs = 0;
+
+// 各格式累计：解码耗时 / 播放墙钟时间。两次 loop() 相隔太久（暂停、切歌）的那一段不计入墙钟。
+// 64 位在 32 位核上不是一次写完，loop() 读时可能读到一半：读写都在临界区里做
+#define FORMAT_WALL_GAP_US 200000
+static AudioFormat g_format = AudioFormat::UNKNOWN;
+static uint64_t g_formatBusyUs[AUDIO_FORMAT_COUNT];
+static uint64_t g_formatWallUs[AUDIO_FORMAT_COUNT];
+static portMUX_TYPE g_formatMux = portMUX_INITIALIZER_UNLOCKED;
+static uint32_t g_lastDecodeAt = 0;
+
+// 当前曲目和预开的下一首各有一个 I/O 任务，SD 统计用原子量
+static std::atomic<uint32_t> g_sdReads(0);
+static std::atomic<uint32_t> g_sdSumUs(0);
+static std::atomic<uint32_t> g_sdMaxUs(0);
+
+static uint32_t g_lastLog = 0;
+
+static void resetWindow()
+{
+    g_decodeCalls = 0;
+    g_decodeSumUs = 0;
+    g_decodeMaxUs = 0;
+    memset(g_decodeHist, 0, sizeof(g_decodeHist));
+    g_fillLow = 100;
+    g_fillHigh = 0;
+    g_sdReads.store(0, std::memory_order_relaxed);
+    g_sdSumUs.store(0, std::memory_order_relaxed);
+    g_sdMaxUs.store(0, std::memory_order_relaxed);
+}
+
+void audioTelemetrySetEnabled(bool on)
+{
+    if (on && !g_enabled.load(std::memory_order_relaxed))
+    {
+        g_resetReq.store(true, std::memory_order_relaxed);
+        g_lastLog = millis();
+    }
+    g_enabled.store(on, std::memory_order_relaxed);
+    LOG_AUDIO("telemetry %s", on ? "on" : "off");
+}
+
+bool audioTelemetryEnabled()
+{
+    return g_enabled.load(std::memory_order_relaxed);
+}
+
+static inline int bucketOf(uint32_t us)
+{
+    int b = 0;
+    us >>= 7; // < 128us 落在第 0 桶
+    while (us && b < AUDIO_TELEM_BUCKETS - 1)
+    {
+        us >>= 1;
+        b++;
+    }
+    return b;
+}
+
+void audioTelemetryDecode(uint32_t us, bool running)
+{
+    audioLoadAddDecodeUs(us);
+    if (!g_enabled.load(std::memory_order_relaxed))
+        return;
+
+    if (g_resetReq.exchange(false, std::memory_order_relaxed))
+        resetWindow();
+
+    g_decodeCalls++;
+    g_decodeSumUs += us;
+    if (us > g_decodeMaxUs)
+        g_decodeMaxUs = us;
+    g_decodeHist[bucketOf(us)]++;
+
+    uint32_t now = micros();
+    uint32_t since = now - g_lastDecodeAt;
+    g_lastDecodeAt = now;
+    int f = (int)g_format;
+    portENTER_CRITICAL(&g_formatMux);
+    g_formatBusyUs[f] += us;
+    if (since < FORMAT_WALL_GAP_US)
+        g_formatWallUs[f] += since;
+    portEXIT_CRITICAL(&g_formatMux);
+
+    // 曲目结束后缓冲自然放空，不算读空；只看解码器仍在运行时
+    if (!running)
+        return;
+    uint8_t fill = platformAudioGetBufferFill();
+    if (fill == 0 && g_fillNow > 0)
+        g_bufferEmpties++;
+    g_fillNow = fill;
+    if (fill < g_fillLow)
+        g_fillLow = fill;
+    if (fill > g_fillHigh)
+        g_fillHigh = fill;
+}
+
+void audioTelemetryTrackOpen(uint32_t ms)
+{
+    if (!g_enabled.load(std::memory_order_relaxed))
+        return;
+    g_openMs = ms;
+    if (ms > g_openMaxMs)
+        g_openMaxMs = ms;
+    // 新曲目从空缓冲开始填，首次读到 0 不算读空
+    g_fillNow = 0;
+}
+
+void audioTelemetryFirstSample(uint32_t ms)
+{
+    if (!g_enabled.load(std::memory_order_relaxed))
+        return;
+    g_firstSampleMs = ms;
+    if (ms > g_firstSampleMaxMs)
+        g_firstSampleMaxMs = ms;
+}
+
+void audioTelemetryTrackFormat(AudioFormat fmt)
+{
+    g_format = fmt;
+}
+
+// 在临界区里整份拷出来再算，避免读到写了一半的 64 位值
+static void copyFormatTimes(uint64_t busy[AUDIO_FORMAT_COUNT], uint64_t wall[AUDIO_FORMAT_COUNT])
+{
+    portENTER_CRITICAL(&g_formatMux);
+    memcpy(busy, g_formatBusyUs, sizeof(g_formatBusyUs));
+    memcpy(wall, g_formatWallUs, sizeof(g_formatWallUs));
+    portEXIT_CRITICAL(&g_formatMux);
+}
+
+static uint8_t formatLoad(uint64_t busy, uint64_t wall)
+{
+    if (!wall)
+        return 0;
+    uint64_t pct = busy * 100 / wall;
+    return pct > 100 ? 100 : (uint8_t)pct;
+}
+
+void audioTelemetrySdRead(uint32_t us)
+{
+    if (!g_enabled.load(std::memory_order_relaxed))
+        return;
+    g_sdReads.fetch_add(1, std::memory_order_relaxed);
+    g_sdSumUs.fetch_add(us, std::memory_order_relaxed);
+    uint32_t prev = g_sdMaxUs.load(std::memory_order_relaxed);
+    while (us > prev && !g_sdMaxUs.compare_exchange_weak(prev, us, std::memory_order_relaxed))
+    {
+    }
+}
+
+AudioTelemetry audioTelemetryGet()
+{
+    AudioTelemetry t;
+    t.decodeCalls = g_decodeCalls;
+    t.decodeAvgUs = g_decodeCalls ? g_decodeSumUs / g_decodeCalls : 0;
+    t.decodeMaxUs = g_decodeMaxUs;
+    memcpy(t.decodeHist, g_decodeHist, sizeof(t.decodeHist));
+    t.fillNow = g_fillNow;
+    t.fillLow = g_fillLow <= g_fillHigh ? g_fillLow : 0;
+    t.fillHigh = g_fillHigh;
+    t.sdReads = g_sdReads.load(std::memory_order_relaxed);
+    t.sdAvgUs = t.sdReads ? g_sdSumUs.load(std::memory_order_relaxed) / t.sdReads : 0;
+    t.sdMaxUs = g_sdMaxUs.load(std::memory_order_relaxed);
+    t.bufferEmpties = g_bufferEmpties;
+    t.openMs = g_openMs;
+    t.openMaxMs = g_openMaxMs;
+    t.firstSampleMs = g_firstSampleMs;
+    t.firstSampleMaxMs = g_firstSampleMaxMs;
+    t.format = g_format;
+    uint64_t busy[AUDIO_FORMAT_COUNT];
+    uint64_t wall[AUDIO_FORMAT_COUNT];
+    copyFormatTimes(busy, wall);
+    for (int f = 0; f < AUDIO_FORMAT_COUNT; f++)
+        t.formatLoad[f] = formatLoad(busy[f], wall[f]);
+    return t;
+}
+
+void audioTelemetryPoll()
+{
+    if (!g_enabled.load(std::memory_order_relaxed))
+        return;
+    if (millis() - g_lastLog < AUDIO_TELEM_LOG_INTERVAL)
+        return;
+    g_lastLog = millis();
+
+    AudioTelemetry t = audioTelemetryGet();
+    g_resetReq.store(true, std::memory_order_relaxed);
+
+    // 一行一条，字段固定顺序，方便脚本解析
+    char hist[AUDIO_TELEM_BUCKETS * 11];
+    int n = 0;
+    for (int i = 0; i < AUDIO_TELEM_BUCKETS; i++)
+        n += snprintf(hist + n, sizeof(hist) - n, i ? ",%lu" : "%lu", (unsigned long)t.decodeHist[i]);
+
+    // 各格式 CPU 占用：只列播放过的格式，如 "MP3:14,WAV:1"
+    char cpu[AUDIO_FORMAT_COUNT * 8] = "-";
+    uint64_t busy[AUDIO_FORMAT_COUNT];
+    uint64_t wall[AUDIO_FORMAT_COUNT];
+    copyFormatTimes(busy, wall);
+    n = 0;
+    for (int f = 1; f < AUDIO_FORMAT_COUNT; f++)
+    {
+        if (wall[f])
+            n += snprintf(cpu + n, sizeof(cpu) - n, n ? ",%s:%u" : "%s:%u", audioFormatName((AudioFormat)f), t.formatLoad[f]);
+    }
+
+    LOG_AUDIO("telem fill=%u/%u/%u dec=%lu/%lu/%lu hist=%s empty=%lu sd=%lu/%lu/%lu open=%lu/%lu ttfs=%lu/%lu cpu=%s",
+              t.fillNow, t.fillLow, t.fillHigh,
+              (unsigned long)t.decodeCalls, (unsigned long)t.decodeAvgUs, (unsigned long)t.decodeMaxUs, hist,
+              (unsigned long)t.bufferEmpties,
+              (unsigned long)t.sdReads, (unsigned long)t.sdAvgUs, (unsigned long)t.sdMaxUs,
+              (unsigned long)t.openMs, (unsigned long)t.openMaxMs,
+              (unsigned long)t.firstSampleMs, (unsigned long)t.firstSampleMaxMs, cpu);
+}
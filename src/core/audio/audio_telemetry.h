@@ -0,0 +1,54 @@
+#pragma once
+#include <stdint.h>
+#include "core/audio/audio_format.h"
+
+// 音频链路遥测：解码耗时直方图、输出缓冲高低水位、缓冲读空次数、SD 读取延迟、打开曲目耗时、点播首样本延迟、各格式的解码 CPU 占用。
+// 默认关闭；关闭时各记录函数只做一次标志检查（解码耗时照常交给 audio_load 给帧率调节器用）。
+// 打开后由 UI 画调试浮层，并每 AUDIO_TELEM_LOG_INTERVAL 毫秒在串口打一行紧凑记录
+#define AUDIO_TELEM_BUCKETS 10 // 解码耗时按 2 的幂分桶：<128us, <256us, ... , <32ms, >=32ms
+#define AUDIO_TELEM_LOG_INTERVAL 5000
+
+struct AudioTelemetry
+{
+    // 以下为当前统计窗口（每条串口记录之后清零）
+    uint32_t decodeCalls;
+    uint32_t decodeAvgUs;
+    uint32_t decodeMaxUs;
+    uint32_t decodeHist[AUDIO_TELEM_BUCKETS];
+    uint8_t fillNow; // 输出缓冲填充量 %
+    uint8_t fillLow;
+    uint8_t fillHigh;
+    uint32_t sdReads;
+    uint32_t sdAvgUs;
+    uint32_t sdMaxUs;
+
+    // 以下为累计值
+    // 解码器在跑、输出缓冲（AudioOutputBuffer）却被读空的次数。这不是 I2S DMA 欠载：
+    // AudioOutputI2S 装驱动时没要事件队列，DMA 真正断粮看不到，读空是最接近的可观测量
+    uint32_t bufferEmpties;
+    uint32_t openMs;    // 最近一次打开曲目（含解析流信息）耗时
+    uint32_t openMaxMs;
+    uint32_t firstSampleMs; // 最近一次点播到第一个样本送出的耗时（含打开曲目）
+    uint32_t firstSampleMaxMs;
+    AudioFormat format;                     // 当前曲目格式
+    uint8_t formatLoad[AUDIO_FORMAT_COUNT]; // 各格式播放期间解码占用的墙钟时间 %，没播过为 0
+};
+
+void audioTelemetrySetEnabled(bool on);
+bool audioTelemetryEnabled();
+
+// 音频任务：每次解码器 loop() 之后调用，同时采样输出缓冲
+void audioTelemetryDecode(uint32_t us, bool running);
+// 音频任务：打开曲目耗时
+void audioTelemetryTrackOpen(uint32_t ms);
+// 音频任务：点播后第一个样本送出的耗时
+void audioTelemetryFirstSample(uint32_t ms);
+// 音频任务：开始解码一首歌，之后的解码耗时记到这个格式名下
+void audioTelemetryTrackFormat(AudioFormat fmt);
+// 任意 I/O 任务：一次 SD 读取耗时
+void audioTelemetrySdRead(uint32_t us);
+
+// 读当前窗口（不清零），给调试浮层用
+AudioTelemetry audioTelemetryGet();
+// loop() 里调用：到时间就打一行记录并开始新窗口
+void audioTelemetryPoll();
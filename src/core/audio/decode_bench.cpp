@@ -0,0 +1,359 @@
+#include "core/audio/decode_bench.h"
+#include "core/audio/mp3_seek.h"
+#include "core/audio/wav_source.h"
+#include "core/audio/flac_source.h"
+#include "core/audio/track_open.h"
+#include "core/audio/readahead_source.h"
+#include "core/audio/resample_output.h"
+#include "platform/platform.h"
+#include "log.h"
+#include <SD.h>
+#include <esp_heap_caps.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
+#include <freertos/task.h>
+#include <string.h>
+
+// 结果格式版本：字段增删时递增，对比脚本据此判断能否直接比较
+#define DECODE_BENCH_FORMAT 3
+// 输出端每接收这么多样本就拒收一次，让 loop() 返回（相当于 DMA 缓冲写满），
+// 在两次 loop() 之间采样堆占用
+#define DECODE_BENCH_CHUNK 1152
+
+#ifndef DECODE_BENCH_LIB
+#define DECODE_BENCH_LIB "ESP8266Audio"
+#endif
+
+// 不限速的输出端：只计数，不做任何处理
+class BenchSink : public AudioOutput
+{
+public:
+    BenchSink() : samples(0), sinceYield(0)
+    {
+        hertz = 0;
+        bps = 16;
+        channels = 2;
+    }
+
+    virtual bool begin() override { return true; }
+    virtual bool stop() override { return true; }
+
+    virtual bool ConsumeSample(int16_t sample[2]) override
+    {
+        (void)sample;
+        if (sinceYield >= DECODE_BENCH_CHUNK)
+        {
+            sinceYield = 0;
+            return false;
+        }
+        sinceYield++;
+        samples++;
+        return true;
+    }
+
+    uint32_t rate() const { return hertz; }
+
+    uint64_t samples;
+
+private:
+    uint32_t sinceYield;
+};
+
+struct HeapProbe
+{
+    size_t internalStart;
+    size_t psramStart;
+    size_t internalMin;
+    size_t psramMin;
+
+    void begin()
+    {
+        internalStart = internalMin = heap_caps_get_free_size(MALLOC_CAP_INTERNAL);
+        psramStart = psramMin = heap_caps_get_free_size(MALLOC_CAP_SPIRAM);
+    }
+
+    void sample()
+    {
+        size_t i = heap_caps_get_free_size(MALLOC_CAP_INTERNAL);
+        size_t p = heap_caps_get_free_size(MALLOC_CAP_SPIRAM);
+        if (i < internalMin)
+            internalMin = i;
+        if (p < psramMin)
+            psramMin = p;
+    }
+};
+
+static const char *platformName()
+{
+    switch (platformGetModel())
+    {
+    case PlatformModel::CARDPUTER_V1:
+        return "cardputer";
+    case PlatformModel::CARDPUTER_ADV:
+        return "cardputer-adv";
+    case PlatformModel::NATIVE_SIM:
+        return "native";
+    default:
+        return "unknown";
+    }
+}
+
+// 文件名里的引号和反斜杠转义，其余控制字符替换掉
+static void jsonEscape(const char *src, char *dst, size_t cap)
+{
+    size_t o = 0;
+    for (; *src && o + 2 < cap; src++)
+    {
+        char c = *src;
+        if (c == '"' || c == '\\')
+            dst[o++] = '\\';
+        else if ((uint8_t)c < 0x20)
+            c = '?';
+        dst[o++] = c;
+    }
+    dst[o] = '\0';
+}
+
+bool decodeBenchFile(const char *path, DecodeBenchResult &r)
+{
+    memset(&r, 0, sizeof(r));
+    const char *slash = strrchr(path, '/');
+    strncpy(r.name, slash ? slash + 1 : path, sizeof(r.name) - 1);
+
+    HeapProbe heap;
+    heap.begin();
+
+    // 和播放时一样：按文件头确认格式，直接从第一帧音频开始
+    uint32_t t0 = micros();
+    TrackSource *src = trackOpen(path, audioFormatFromName(path));
+    if (!src)
+        return false;
+    r.format = src->format();
+    r.fileBytes = src->getSize();
+    r.sampleRate = src->sampleRate();
+
+    uint32_t spf = 0;
+    if (r.format == AudioFormat::MP3)
+    {
+        const Mp3StreamInfo &info = static_cast<Mp3SeekSource *>(src)->getInfo();
+        r.channels = info.channels;
+        r.bitrateKbps = info.bitrateKbps;
+        r.audioStart = info.audioStart;
+        r.vbr = info.isVbr;
+        spf = info.samplesPerFrame ? info.samplesPerFrame : (r.sampleRate < 32000 ? 576 : 1152);
+    }
+    else if (r.format == AudioFormat::WAV)
+    {
+        const WavStreamInfo &info = static_cast<WavSource *>(src)->getInfo();
+        r.channels = info.channels;
+        r.bitrateKbps = (uint16_t)(info.sampleRate * info.blockAlign * 8 / 1000);
+        r.audioStart = info.dataStart;
+    }
+    else
+    {
+        const FlacStreamInfo &info = static_cast<FlacSource *>(src)->getInfo();
+        r.channels = info.channels;
+        uint32_t ms = src->durationMs();
+        r.bitrateKbps = ms ? (uint16_t)((uint64_t)(info.audioEnd - info.audioStart) * 8 / ms) : 0;
+        r.audioStart = info.audioStart;
+        r.vbr = true;
+    }
+
+    BenchSink *sink = new BenchSink();
+    AudioGenerator *dec = trackNewDecoder(src);
+    bool started = dec->begin(src, sink);
+    r.openUs = micros() - t0;
+    heap.sample();
+
+    while (started && dec->isRunning())
+    {
+        uint32_t s = micros();
+        bool running = dec->loop();
+        r.decodeUs += micros() - s;
+        heap.sample();
+        if (!running)
+            break;
+    }
+    dec->stop();
+
+    ReadAheadStats st = static_cast<ReadAheadSource *>(src->getInner())->getStats();
+    r.stalls = st.stalls;
+
+    if (sink->rate())
+        r.sampleRate = sink->rate();
+    r.samples = sink->samples;
+    r.frames = spf ? (uint32_t)((r.samples + spf - 1) / spf) : 0;
+    r.audioMs = r.sampleRate ? (uint32_t)(r.samples * 1000 / r.sampleRate) : 0;
+
+    r.heapPeak = (uint32_t)(heap.internalStart - heap.internalMin);
+    r.psramPeak = (uint32_t)(heap.psramStart - heap.psramMin);
+    r.ok = started && r.samples > 0;
+
+    delete dec;
+    delete sink;
+    delete src;
+    return r.ok;
+}
+
+// ==========================
+// 逐文件任务
+// ==========================
+struct BenchJob
+{
+    const char *path;
+    DecodeBenchResult result;
+    SemaphoreHandle_t done;
+};
+
+static void benchTaskEntry(void *arg)
+{
+    BenchJob *job = (BenchJob *)arg;
+    decodeBenchFile(job->path, job->result);
+    job->result.stackPeak = DECODE_BENCH_STACK - (uint32_t)uxTaskGetStackHighWaterMark(nullptr);
+    xSemaphoreGive(job->done);
+    vTaskDelete(nullptr);
+}
+
+static void printHeader(const char *dir)
+{
+    char d[96];
+    jsonEscape(dir, d, sizeof(d));
+    Serial.printf("BENCH {\"bench\":\"decode\",\"format\":%d,\"platform\":\"%s\",\"cpu_mhz\":%lu,"
+                  "\"psram\":%s,\"lib\":\"%s\",\"compiler\":\"%s\",\"dir\":\"%s\"}\n",
+                  DECODE_BENCH_FORMAT, platformName(), (unsigned long)ESP.getCpuFreqMHz(),
+                  psramFound() ? "true" : "false", DECODE_BENCH_LIB, __VERSION__, d);
+}
+
+static void printResult(const DecodeBenchResult &r)
+{
+    char name[96];
+    jsonEscape(r.name, name, sizeof(name));
+
+    // fps：每秒解码的 MP3 帧数（其它格式为 0）；rtf：解码耗时 / 音频时长，小于 1 才能实时播放，
+    // 也就是播放这个文件时解码占用的 CPU 比例
+    double decodeS = r.decodeUs / 1000000.0;
+    double fps = decodeS > 0 ? r.frames / decodeS : 0;
+    double rtf = r.audioMs ? (r.decodeUs / 1000.0) / r.audioMs : 0;
+
+    Serial.printf("BENCH {\"file\":\"%s\",\"fmt\":\"%s\",\"ok\":%s,\"bytes\":%lu,\"rate\":%lu,\"ch\":%u,\"kbps\":%u,"
+                  "\"vbr\":%s,\"audio_start\":%lu,\"frames\":%lu,\"audio_ms\":%lu,\"decode_ms\":%.1f,"
+                  "\"open_ms\":%.1f,\"fps\":%.1f,\"rtf\":%.4f,\"heap_peak\":%lu,\"psram_peak\":%lu,"
+                  "\"stack_peak\":%lu,\"stalls\":%lu}\n",
+                  name, audioFormatName(r.format), r.ok ? "true" : "false", (unsigned long)r.fileBytes, (unsigned long)r.sampleRate,
+                  (unsigned)r.channels, (unsigned)r.bitrateKbps, r.vbr ? "true" : "false",
+                  (unsigned long)r.audioStart, (unsigned long)r.frames, (unsigned long)r.audioMs,
+                  r.decodeUs / 1000.0, r.openUs / 1000.0, fps, rtf, (unsigned long)r.heapPeak,
+                  (unsigned long)r.psramPeak, (unsigned long)r.stackPeak, (unsigned long)r.stalls);
+}
+
+int decodeBenchRun(const char *dir)
+{
+    printHeader(dir);
+
+    File d = SD.open(dir);
+    if (!d || !d.isDirectory())
+    {
+        LOG_AUDIO("bench: %s not found", dir);
+        return 0;
+    }
+
+    // 先收集文件名并排序，保证每次输出顺序一致，便于逐行对比
+    static char names[DECODE_BENCH_MAX_FILES][64];
+    int count = 0;
+    while (count < DECODE_BENCH_MAX_FILES)
+    {
+        File e = d.openNextFile();
+        if (!e)
+            break;
+        const char *name = e.name();
+        if (!e.isDirectory() && name[0] != '.' && audioFormatFromName(name) != AudioFormat::UNKNOWN && strlen(name) < sizeof(names[0]))
+            strcpy(names[count++], name);
+        e.close();
+    }
+    d.close();
+    qsort(names, count, sizeof(names[0]), [](const void *a, const void *b)
+          { return strcmp((const char *)a, (const char *)b); });
+
+    BenchJob job;
+    job.done = xSemaphoreCreateBinary();
+    char path[160];
+    int passed = 0;
+    for (int i = 0; i < count; i++)
+    {
+        int n = snprintf(path, sizeof(path), "%s/%s", dir, names[i]);
+        if (n <= 0 || n >= (int)sizeof(path))
+            continue;
+        job.path = path;
+        // 和音频任务相同的栈、优先级和核心
+        if (xTaskCreatePinnedToCore(benchTaskEntry, "DecBench", DECODE_BENCH_STACK, &job, 2, nullptr, 0) != pdPASS)
+        {
+            LOG_AUDIO("bench: cannot create task");
+            break;
+        }
+        xSemaphoreTake(job.done, portMAX_DELAY);
+        printResult(job.result);
+        if (job.result.ok)
+            passed++;
+    }
+    vSemaphoreDelete(job.done);
+
+    Serial.printf("BENCH {\"done\":%d,\"failed\":%d}\n", passed, count - passed);
+    return passed;
+}
+
+// ==========================
+// 重采样
+// ==========================
+// 解码器可能输出的采样率（MPEG-1/2/2.5 全部九种）
+static const uint32_t BENCH_IN_RATES[] = {8000, 11025, 12000, 16000, 22050, 24000, 32000, 44100, 48000};
+
+void resampleBenchRun()
+{
+    const uint32_t *rates;
+    uint8_t rateCount = platformAudioGetOutputRates(&rates);
+
+    // 固定种子的噪声，每次运行输入相同
+    static int16_t src[256 * 2];
+    uint32_t seed = 0x12345678;
+    for (int i = 0; i < 256 * 2; i++)
+    {
+        seed = seed * 1664525 + 1013904223;
+        src[i] = (int16_t)(seed >> 17) - 16384;
+    }
+
+    for (uint32_t in : BENCH_IN_RATES)
+    {
+        BenchSink sink;
+        ResampleOutput rs(&sink);
+        rs.setOutputRates(rates, rateCount);
+        rs.SetRate((int)in);
+        if (!rs.isResampling())
+            continue;
+        rs.begin();
+
+        uint32_t frames = in * RESAMPLE_BENCH_MS / 1000;
+        uint32_t us = 0;
+        for (uint32_t done = 0; done < frames;)
+        {
+            // 按块计时，和解码循环一样每块之间让出 CPU
+            uint32_t n = frames - done < 256 ? frames - done : 256;
+            uint32_t t0 = micros();
+            for (uint32_t i = 0; i < n; i++)
+            {
+                while (!rs.ConsumeSample(src + 2 * i))
+                    rs.loop();
+            }
+            us += micros() - t0;
+            done += n;
+            vTaskDelay(0);
+        }
+
+        uint64_t out = sink.samples;
+        double outMs = rs.outputRate() ? out * 1000.0 / rs.outputRate() : 0;
+        Serial.printf("BENCH {\"resample\":\"%lu->%lu\",\"l\":%u,\"m\":%u,\"taps\":%d,\"in_frames\":%lu,"
+                      "\"out_frames\":%lu,\"ms\":%.2f,\"ns_per_frame\":%.1f,\"rtf\":%.4f}\n",
+                      (unsigned long)in, (unsigned long)rs.outputRate(), (unsigned)rs.ratioL(), (unsigned)rs.ratioM(),
+                      RESAMPLE_TAPS, (unsigned long)frames, (unsigned long)out, us / 1000.0,
+                      out ? us * 1000.0 / out : 0.0, outMs > 0 ? (us / 1000.0) / outMs : 0.0);
+    }
+}
@@ -0,0 +1,48 @@
+#pragma once
+#include <stdint.h>
+#include "core/audio/audio_format.h"
+
+// 解码吞吐测试（编译时加 -D DECODE_BENCHMARK，开机时运行一次）：
+//   - 依次解码 DECODE_BENCH_DIR 下的每个 .mp3/.wav/.flac，走和播放相同的 trackOpen() + 按格式选的解码器，
+//     输出端不限速，只计数；rtf 即播放该文件时解码占用的 CPU 比例，可据此决定曲库转成哪种格式更省电
+//   - 每个文件在独立任务里解码（栈大小同音频任务），分别统计栈水位和堆峰值
+//   - 结果逐行输出，每行 "BENCH " + 一个 JSON 对象，便于从串口日志里 grep 出来对比
+//   - 之后对输出端不直接支持的每个常见采样率跑一遍重采样，同样输出 BENCH 行
+// 夹具由 tools/bench/gen_fixtures.sh 生成，字段说明见 tools/bench/README.md
+#ifndef DECODE_BENCH_DIR
+#define DECODE_BENCH_DIR "/.bench" // 隐藏目录，不会被扫描进曲库
+#endif
+#define DECODE_BENCH_STACK 65536
+#define DECODE_BENCH_MAX_FILES 64
+#define RESAMPLE_BENCH_MS 2000 // 每个比值处理的输入时长
+
+struct DecodeBenchResult
+{
+    char name[64];
+    AudioFormat format;
+    uint32_t fileBytes;
+    uint32_t sampleRate;
+    uint8_t channels;
+    uint16_t bitrateKbps; // MP3 为首帧码率，WAV/FLAC 为平均码率
+    bool vbr;             // 有 Xing 或 VBRI 头；FLAC 恒为 true
+    uint32_t audioStart;  // 第一帧位置，反映 ID3v2 / FLAC 元数据（封面）大小
+
+    uint32_t frames; // MP3 帧数，其它格式为 0
+    uint64_t samples;
+    uint32_t audioMs;  // 解码出的音频时长
+    uint32_t decodeUs; // 所有 loop() 调用的累计耗时
+    uint32_t openUs;   // 打开文件、解析流信息、begin() 的耗时
+
+    uint32_t heapPeak;  // 内部 RAM：解码期间相对开始前的最大占用
+    uint32_t psramPeak; // PSRAM：同上
+    uint32_t stackPeak; // 解码任务栈的最大使用量
+    uint32_t stalls;    // 预读缓冲读空次数（>0 说明结果受 SD 速度影响）
+    bool ok;
+};
+
+// 同步执行，逐个文件输出结果；返回成功解码的文件数
+int decodeBenchRun(const char *dir);
+// 按平台的输出采样率，逐个比值测重采样开销
+void resampleBenchRun();
+// 单个文件；由 decodeBenchRun 在独立任务里调用，也可在已有足够栈的任务中直接调用
+bool decodeBenchFile(const char *path, DecodeBenchResult &r);
@@ -0,0 +1,266 @@
+#include "core/audio/flac_source.h"
+#include "core/audio/mp3_info.h"
+#include <stdlib.h>
+#include <string.h>
+
+// 最多看多少个元数据块（每张封面、每个 PADDING 各是一块）
+#define FLAC_MAX_META_BLOCKS 128
+// 帧头最长 16 字节（同步 2 + 参数 2 + UTF-8 序号最多 7 + 块长 2 + 采样率 2 + CRC 1）
+#define FLAC_MAX_FRAME_HEADER 16
+
+static const uint32_t kFrameRates[12] = {0, 88200, 176400, 192000, 8000, 16000,
+                                         22050, 24000, 32000, 44100, 48000, 96000};
+static const uint8_t kFrameBits[8] = {0, 8, 12, 0, 16, 20, 24, 32};
+
+static inline uint32_t be24(const uint8_t *p)
+{
+    return ((uint32_t)p[0] << 16) | ((uint32_t)p[1] << 8) | p[2];
+}
+
+static inline uint32_t be32(const uint8_t *p)
+{
+    return ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) | ((uint32_t)p[2] << 8) | p[3];
+}
+
+static bool parseStreamInfo(const uint8_t *s, FlacStreamInfo &info)
+{
+    info.minBlock = (uint16_t)((s[0] << 8) | s[1]);
+    info.maxBlock = (uint16_t)((s[2] << 8) | s[3]);
+    info.maxFrameBytes = be24(s + 7);
+    info.sampleRate = ((uint32_t)s[10] << 12) | ((uint32_t)s[11] << 4) | (s[12] >> 4);
+    info.channels = ((s[12] >> 1) & 0x07) + 1;
+    info.bitsPerSample = (((s[12] & 0x01) << 4) | (s[13] >> 4)) + 1;
+    // 总样本数有 36 位，超过 32 位（44.1kHz 下约 27 小时）当作未知
+    info.totalSamples = (s[13] & 0x0F) ? 0 : be32(s + 14);
+    memcpy(info.streamInfo, s, sizeof(info.streamInfo));
+
+    return info.sampleRate > 0 && info.channels <= 2 && info.bitsPerSample <= 24 &&
+           info.maxBlock >= 16 && info.maxBlock <= FLAC_MAX_BLOCK_SIZE;
+}
+
+bool flacReadStreamInfo(AudioFileSource *src, FlacStreamInfo &info, const TrackLayout *layout)
+{
+    memset(&info, 0, sizeof(info));
+    uint32_t size = src->getSize();
+    info.audioEnd = size;
+
+    uint8_t hdr[10];
+    uint32_t pos = 0;
+
+    if (layout && layout->start + 4 <= size && mp3ReadAt(src, layout->start, hdr, 4) == 4 &&
+        memcmp(hdr, "fLaC", 4) == 0)
+    {
+        pos = layout->start;
+    }
+    else
+    {
+        // 1. 跳过 ID3v2 标签（少数工具会给 FLAC 也加上）
+        while (pos + 10 <= size && mp3ReadAt(src, pos, hdr, 10) == 10 && memcmp(hdr, "ID3", 3) == 0)
+        {
+            uint32_t tagSize = ((uint32_t)(hdr[6] & 0x7F) << 21) | ((uint32_t)(hdr[7] & 0x7F) << 14) |
+                               ((uint32_t)(hdr[8] & 0x7F) << 7) | (uint32_t)(hdr[9] & 0x7F);
+            pos += 10 + tagSize + ((hdr[5] & 0x10) ? 10 : 0);
+        }
+        if (mp3ReadAt(src, pos, hdr, 4) != 4 || memcmp(hdr, "fLaC", 4) != 0)
+            return false;
+    }
+    info.tagEnd = pos;
+    pos += 4;
+
+    // 2. 元数据块：第一块必须是 STREAMINFO，其余只看块头跳过
+    bool haveInfo = false;
+    for (int i = 0; i < FLAC_MAX_META_BLOCKS && pos + 4 <= size; i++)
+    {
+        if (mp3ReadAt(src, pos, hdr, 4) != 4)
+            return false;
+        bool last = hdr[0] & 0x80;
+        uint8_t type = hdr[0] & 0x7F;
+        uint32_t len = be24(hdr + 1);
+
+        if (i == 0)
+        {
+            uint8_t s[34];
+            if (type != 0 || len < sizeof(s) || mp3ReadAt(src, pos + 4, s, sizeof(s)) != sizeof(s))
+                return false;
+            if (!parseStreamInfo(s, info))
+                return false;
+            haveInfo = true;
+        }
+        pos += 4 + len;
+        if (last)
+        {
+            info.audioStart = pos;
+            return haveInfo && pos < size;
+        }
+    }
+    return false;
+}
+
+static uint8_t crc8(const uint8_t *p, uint32_t n)
+{
+    uint8_t crc = 0;
+    while (n--)
+    {
+        crc ^= *p++;
+        for (int i = 0; i < 8; i++)
+            crc = (crc & 0x80) ? (uint8_t)((crc << 1) ^ 0x07) : (uint8_t)(crc << 1);
+    }
+    return crc;
+}
+
+// 解析 p 处的帧头并核对 CRC-8 和流参数；通过时输出该帧第一个样本的序号
+static bool parseFrameHeader(const uint8_t *p, uint32_t avail, const FlacStreamInfo &info, uint32_t *sample)
+{
+    if (avail < 6 || p[0] != 0xFF || (p[1] & 0xFE) != 0xF8)
+        return false;
+    bool variable = p[1] & 0x01;
+    uint8_t bsCode = p[2] >> 4;
+    uint8_t srCode = p[2] & 0x0F;
+    uint8_t chCode = p[3] >> 4;
+    uint8_t ssCode = (p[3] >> 1) & 0x07;
+    if (bsCode == 0 || srCode == 15 || chCode > 10 || ssCode == 3 || (p[3] & 0x01))
+        return false;
+
+    // 其余参数要和 STREAMINFO 一致，挡住音频数据里碰巧出现的同步字
+    if (srCode >= 1 && srCode <= 11 && kFrameRates[srCode] != info.sampleRate)
+        return false;
+    if (ssCode && kFrameBits[ssCode] != info.bitsPerSample)
+        return false;
+    if ((chCode < 8 ? chCode + 1 : 2) != info.channels)
+        return false;
+
+    // UTF-8 形式编码的帧号/样本号
+    uint32_t i = 4;
+    uint8_t b = p[i++];
+    int ones = 0;
+    while (ones < 8 && (b & (0x80 >> ones)))
+        ones++;
+    if (ones == 1 || ones == 8)
+        return false;
+    int more = ones ? ones - 1 : 0;
+    uint64_t num = b & (0xFF >> (ones + 1));
+    if (i + more + 1 > avail)
+        return false;
+    for (int k = 0; k < more; k++)
+    {
+        uint8_t c = p[i++];
+        if ((c & 0xC0) != 0x80)
+            return false;
+        num = (num << 6) | (c & 0x3F);
+    }
+
+    i += bsCode == 6 ? 1 : bsCode == 7 ? 2 : 0;
+    i += srCode == 12 ? 1 : (srCode == 13 || srCode == 14) ? 2 : 0;
+    if (i + 1 > avail || crc8(p, i) != p[i])
+        return false;
+
+    uint64_t s = variable ? num : num * info.minBlock;
+    if (s > 0xFFFFFFFFu)
+        return false;
+    *sample = (uint32_t)s;
+    return true;
+}
+
+FlacSource::FlacSource(AudioFileSource *inner, const FlacStreamInfo &info)
+    : TrackSource(inner, AudioFormat::FLAC), info(info), headPos(0)
+{
+    memcpy(head, "fLaC", 4);
+    head[4] = 0x80; // 最后一个元数据块，类型 0（STREAMINFO）
+    head[5] = 0;
+    head[6] = 0;
+    head[7] = sizeof(info.streamInfo);
+    memcpy(head + 8, info.streamInfo, sizeof(info.streamInfo));
+}
+
+uint32_t FlacSource::takeHead(uint8_t *data, uint32_t len)
+{
+    uint32_t n = sizeof(head) - headPos;
+    if (n > len)
+        n = len;
+    memcpy(data, head + headPos, n);
+    headPos += n;
+    return n;
+}
+
+uint32_t FlacSource::read(void *data, uint32_t len)
+{
+    uint32_t n = headPos < sizeof(head) ? takeHead((uint8_t *)data, len) : 0;
+    if (n < len)
+        n += inner->read((uint8_t *)data + n, len - n);
+    return n;
+}
+
+uint32_t FlacSource::readNonBlock(void *data, uint32_t len)
+{
+    uint32_t n = headPos < sizeof(head) ? takeHead((uint8_t *)data, len) : 0;
+    if (n < len)
+        n += inner->readNonBlock((uint8_t *)data + n, len - n);
+    return n;
+}
+
+bool FlacSource::seek(int32_t pos, int dir)
+{
+    headPos = sizeof(head);
+    return inner->seek(pos, dir);
+}
+
+uint32_t FlacSource::durationMs()
+{
+    return (uint32_t)((uint64_t)info.totalSamples * 1000 / info.sampleRate);
+}
+
+bool FlacSource::locate(uint32_t ms, TrackSeekPoint &pt)
+{
+    if (!info.totalSamples)
+        return false;
+
+    uint32_t target = (uint32_t)((uint64_t)ms * info.sampleRate / 1000);
+    if (target >= info.totalSamples)
+        target = info.totalSamples - 1;
+
+    // 按字节比例估算，再往回退一帧，让落点尽量不晚于目标
+    uint32_t bytes = info.audioEnd - info.audioStart;
+    uint32_t off = info.audioStart + (uint32_t)((uint64_t)bytes * target / info.totalSamples);
+    uint32_t back = info.maxFrameBytes ? info.maxFrameBytes : FLAC_SYNC_WINDOW / 2;
+    off = off > info.audioStart + back ? off - back : info.audioStart;
+
+    uint8_t *buf = (uint8_t *)malloc(FLAC_SYNC_WINDOW);
+    if (!buf)
+        return false;
+
+    uint32_t restore = inner->getPos();
+    bool found = false;
+    for (int t = 0; t < FLAC_SYNC_TRIES && !found && off < info.audioEnd; t++)
+    {
+        uint32_t got = mp3ReadAt(inner, off, buf, FLAC_SYNC_WINDOW);
+        if (got < FLAC_MAX_FRAME_HEADER)
+            break;
+        for (uint32_t i = 0; i < got; i++)
+        {
+            uint32_t sample;
+            if (parseFrameHeader(buf + i, got - i, info, &sample))
+            {
+                pt.offset = off + i;
+                pt.sample = sample;
+                pt.exact = true;
+                found = true;
+                break;
+            }
+        }
+        // 下一个窗口和这个重叠一个帧头的长度，跨窗口的帧头不会漏掉
+        off += got - FLAC_MAX_FRAME_HEADER;
+    }
+    free(buf);
+
+    if (!found)
+        inner->seek(restore, SEEK_SET);
+    return found;
+}
+
+bool FlacSource::seekTo(const TrackSeekPoint &pt)
+{
+    if (!inner->seek(pt.offset, SEEK_SET))
+        return false;
+    headPos = 0;
+    return true;
+}
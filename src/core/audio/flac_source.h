@@ -0,0 +1,64 @@
+#pragma once
+#include <stdint.h>
+#include "core/audio/track_source.h"
+
+// 接受的最大块长（流式子集的上限）。解码器按块长分配输出缓冲，块长越界的文件直接拒绝，内存有上界
+#define FLAC_MAX_BLOCK_SIZE 4608
+// seek 时在估算位置附近找帧头的窗口
+#define FLAC_SYNC_WINDOW 4096
+#define FLAC_SYNC_TRIES 4
+
+// 曲目打开时解析的流信息：ID3v2 之后的 "fLaC" 标记、STREAMINFO，以及元数据块之后第一个音频帧的位置
+struct FlacStreamInfo
+{
+    uint32_t tagEnd;     // 所有 ID3v2 标签之后的第一个字节（"fLaC" 所在位置）
+    uint32_t audioStart; // 第一个音频帧（已跳过所有元数据块，包括封面）
+    uint32_t audioEnd;
+
+    uint32_t sampleRate;
+    uint8_t channels;
+    uint8_t bitsPerSample;
+    uint16_t minBlock;
+    uint16_t maxBlock;
+    uint32_t maxFrameBytes; // 0 表示未知
+    uint32_t totalSamples;  // 0 表示未知
+
+    uint8_t streamInfo[34]; // 原样保存，解码器启动时重放
+};
+
+// 从 src 当前文件读取流信息；只读元数据块头，不读封面等块的内容。
+// 声道 > 2、位深 > 24 或块长超过 FLAC_MAX_BLOCK_SIZE 时返回 false。
+// 给出 layout 时直接在 layout->start 找 "fLaC"，找不到时退回从文件开头跳过标签。
+// 返回后 src 的读写位置未定义，调用方需要自行 seek
+bool flacReadStreamInfo(AudioFileSource *src, FlacStreamInfo &info, const TrackLayout *layout = nullptr);
+
+// FLAC 曲目输入：给解码器看的是一条拼出来的流 = "fLaC" + 只有 STREAMINFO 的元数据 + 从读位置开始的音频帧。
+//   - 开头的大封面、PADDING 等元数据块不经过解码器，打开时不用读过去
+//   - seek：按字节比例估算位置，在附近找一个能通过 CRC-8 的帧头，帧头里带着样本序号，落点是精确的；
+//     seekTo() 之后重启解码器，解码器看到的仍是完整的流头，接着就是落点所在帧
+// 读位置（getPos）始终是文件中的真实位置，不含拼上去的流头
+class FlacSource : public TrackSource
+{
+public:
+    FlacSource(AudioFileSource *inner, const FlacStreamInfo &info);
+
+    virtual uint32_t read(void *data, uint32_t len) override;
+    virtual uint32_t readNonBlock(void *data, uint32_t len) override;
+    // 任意位置 seek 之后不再重放流头
+    virtual bool seek(int32_t pos, int dir) override;
+
+    const FlacStreamInfo &getInfo() const { return info; }
+
+    virtual uint32_t sampleRate() const override { return info.sampleRate; }
+    virtual uint32_t validSamples() const override { return info.totalSamples; }
+    virtual uint32_t durationMs() override;
+    virtual bool locate(uint32_t ms, TrackSeekPoint &pt) override;
+    virtual bool seekTo(const TrackSeekPoint &pt) override;
+
+private:
+    uint32_t takeHead(uint8_t *data, uint32_t len);
+
+    FlacStreamInfo info;
+    uint8_t head[42];
+    uint8_t headPos; // 流头已送出的字节数
+};
@@ -0,0 +1,131 @@
+#include "core/audio/gapless_output.h"
+#include "log.h"
+
+GaplessOutput::GaplessOutput(AudioOutput *sink)
+    : sink(sink), started(false), transition(false), seeking(false), transitionStartUs(0), gapUs(0),
+      opening(false), firstSampleReady(false), openStartUs(0), firstSampleUs(0),
+      samplePos(0), skipSamples(0), validSamples(0)
+{
+    hertz = 0;
+    bps = 0;
+    channels = 0;
+}
+
+void GaplessOutput::beginTrack(uint32_t skip, uint32_t valid)
+{
+    samplePos = 0;
+    skipSamples = skip;
+    validSamples = valid;
+}
+
+void GaplessOutput::beginTransition()
+{
+    transition = true;
+    transitionStartUs = micros();
+}
+
+void GaplessOutput::beginOpen()
+{
+    opening = true;
+    firstSampleReady = false;
+    openStartUs = micros();
+}
+
+bool GaplessOutput::takeFirstSampleUs(uint32_t &us)
+{
+    if (!firstSampleReady)
+        return false;
+    firstSampleReady = false;
+    us = firstSampleUs;
+    return true;
+}
+
+void GaplessOutput::beginSeek(uint32_t pos, bool exact)
+{
+    seeking = true;
+    samplePos = pos;
+    if (!exact)
+        validSamples = 0;
+}
+
+uint32_t GaplessOutput::positionMs() const
+{
+    if (hertz <= 0 || samplePos <= skipSamples)
+        return 0;
+    return (uint32_t)((uint64_t)(samplePos - skipSamples) * 1000 / hertz);
+}
+
+bool GaplessOutput::SetRate(int hz)
+{
+    if (started && hz == hertz)
+        return true;
+    hertz = hz;
+    return sink->SetRate(hz);
+}
+
+bool GaplessOutput::SetBitsPerSample(int bits)
+{
+    if (started && bits == bps)
+        return true;
+    bps = bits;
+    return sink->SetBitsPerSample(bits);
+}
+
+bool GaplessOutput::SetChannels(int chan)
+{
+    if (started && chan == channels)
+        return true;
+    channels = chan;
+    return sink->SetChannels(chan);
+}
+
+bool GaplessOutput::begin()
+{
+    if (started)
+        return true;
+    started = sink->begin();
+    return started;
+}
+
+bool GaplessOutput::ConsumeSample(int16_t sample[2])
+{
+    // 开头的 delay 和结尾的 padding 直接吞掉，对解码器而言等同于已输出
+    if (samplePos < skipSamples || (validSamples && samplePos >= skipSamples + validSamples))
+    {
+        samplePos++;
+        return true;
+    }
+
+    if (!sink->ConsumeSample(sample))
+        return false;
+    samplePos++;
+    seeking = false;
+
+    if (transition)
+    {
+        transition = false;
+        gapUs = micros() - transitionStartUs;
+        LOG_AUDIO("gapless: inter-track gap %lu.%02lu ms",
+                  (unsigned long)(gapUs / 1000), (unsigned long)(gapUs % 1000 / 10));
+    }
+    if (opening)
+    {
+        opening = false;
+        firstSampleUs = micros() - openStartUs;
+        firstSampleReady = true;
+    }
+    return true;
+}
+
+bool GaplessOutput::stop()
+{
+    if (transition || seeking)
+        return true;
+    started = false;
+    return sink->stop();
+}
+
+bool GaplessOutput::loop()
+{
+    return sink->loop();
+}
@@ -0,0 +1,57 @@
+#pragma once
+#include <AudioOutput.h>
+
+// 解码器与输出缓冲之间的一级：
+//   - 按 LAME 头裁掉每首歌开头的 encoder/decoder delay 和结尾的 padding
+//   - 切歌过渡期间吞掉 stop()，I2S 不停、不清 DMA，下一首直接接上
+//   - 采样率/声道没变时不重复配置下游（避免 I2S 重新设时钟）
+//   - 测量两首歌之间输出端的断流时长，以及点播后第一个样本送出的延迟
+class GaplessOutput : public AudioOutput
+{
+public:
+    explicit GaplessOutput(AudioOutput *sink);
+
+    // 每首歌开始前调用；validSamples 为 0 表示不裁结尾
+    void beginTrack(uint32_t skipSamples, uint32_t validSamples);
+    // 曲内 seek：在解码器重启前调用，之后的 stop() 不下传。
+    // samplePos 为落点帧之前的解码样本数；不精确时放弃结尾裁剪
+    void beginSeek(uint32_t samplePos, bool exact);
+    // 当前曲目已播放时长（按送出的解码样本计，不含被裁掉的开头）
+    uint32_t positionMs() const;
+
+    // 过渡开始：之后的 stop() 不下传，直到下一首第一个样本送出
+    void beginTransition();
+    // 下一首没能起播时撤销过渡，否则之后的 stop() 会一直被吞掉
+    void cancelTransition() { transition = false; }
+    bool inTransition() const { return transition; }
+    uint32_t lastGapUs() const { return gapUs; }
+
+    // 点播（切歌、开始播放）时调用：从这里计时，到之后第一个样本送出为止。
+    // 测到后 takeFirstSampleUs() 返回一次 true
+    void beginOpen();
+    bool takeFirstSampleUs(uint32_t &us);
+
+    virtual bool SetRate(int hz) override;
+    virtual bool SetBitsPerSample(int bits) override;
+    virtual bool SetChannels(int chan) override;
+    virtual bool begin() override;
+    virtual bool ConsumeSample(int16_t sample[2]) override;
+    virtual bool stop() override;
+    virtual bool loop() override;
+
+private:
+    AudioOutput *sink;
+    bool started;
+    bool transition;
+    bool seeking;
+    uint32_t transitionStartUs;
+    uint32_t gapUs;
+    bool opening;
+    bool firstSampleReady;
+    uint32_t openStartUs;
+    uint32_t firstSampleUs;
+
+    uint32_t samplePos; // 本曲已解码的样本（含被裁掉的）
+    uint32_t skipSamples;
+    uint32_t validSamples;
+};
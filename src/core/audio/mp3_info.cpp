@@ -0,0 +1,264 @@
+#include "core/audio/mp3_info.h"
+#include <string.h>
+
+#define MP3_SCAN_WINDOW 2048
+
+static const uint16_t kBitrateV1[16] = {0, 32, 40, 48, 56, 64, 80, 96, 112, 128, 160, 192, 224, 256, 320, 0};
+static const uint16_t kBitrateV2[16] = {0, 8, 16, 24, 32, 40, 48, 56, 64, 80, 96, 112, 128, 144, 160, 0};
+static const uint32_t kRateV1[3] = {44100, 48000, 32000};
+
+static inline uint32_t be32(const uint8_t *p)
+{
+    return ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) | ((uint32_t)p[2] << 8) | p[3];
+}
+
+static inline uint16_t be16(const uint8_t *p)
+{
+    return (uint16_t)((p[0] << 8) | p[1]);
+}
+
+bool mp3ParseFrameHeader(const uint8_t *h, Mp3FrameHeader &out)
+{
+    if (h[0] != 0xFF || (h[1] & 0xE0) != 0xE0)
+        return false;
+
+    uint8_t ver = (h[1] >> 3) & 0x03; // 0 = 2.5, 2 = MPEG2, 3 = MPEG1
+    uint8_t layer = (h[1] >> 1) & 0x03;
+    uint8_t brIdx = h[2] >> 4;
+    uint8_t srIdx = (h[2] >> 2) & 0x03;
+    uint8_t pad = (h[2] >> 1) & 0x01;
+    bool mono = (h[3] >> 6) == 0x03;
+
+    if (ver == 1 || layer != 1 || brIdx == 0 || brIdx == 15 || srIdx == 3)
+        return false;
+
+    bool v1 = ver == 3;
+    out.bitrateKbps = v1 ? kBitrateV1[brIdx] : kBitrateV2[brIdx];
+    out.sampleRate = kRateV1[srIdx] >> (v1 ? 0 : (ver == 2 ? 1 : 2));
+    out.samplesPerFrame = v1 ? 1152 : 576;
+    out.channels = mono ? 1 : 2;
+    out.frameBytes = (uint16_t)((v1 ? 144000u : 72000u) * out.bitrateKbps / out.sampleRate + pad);
+    out.sideInfoBytes = v1 ? (mono ? 17 : 32) : (mono ? 9 : 17);
+    return true;
+}
+
+uint32_t mp3ReadAt(AudioFileSource *src, uint32_t pos, uint8_t *buf, uint32_t len)
+{
+    if (!src->seek(pos, SEEK_SET))
+        return 0;
+    uint32_t n = 0;
+    while (n < len)
+    {
+        uint32_t r = src->read(buf + n, len - n);
+        if (r == 0)
+            break;
+        n += r;
+    }
+    return n;
+}
+
+static bool readAt(AudioFileSource *src, uint32_t pos, uint8_t *buf, uint32_t len, uint32_t *got)
+{
+    *got = mp3ReadAt(src, pos, buf, len);
+    return *got > 0;
+}
+
+int mp3FindFrameSync(const uint8_t *buf, uint32_t len, Mp3FrameHeader &fh)
+{
+    for (uint32_t i = 0; i + 4 <= len; i++)
+    {
+        if (!mp3ParseFrameHeader(buf + i, fh))
+            continue;
+        Mp3FrameHeader next;
+        uint32_t n = i + fh.frameBytes;
+        if (n + 4 <= len && !mp3ParseFrameHeader(buf + n, next))
+            continue;
+        return (int)i;
+    }
+    return -1;
+}
+
+// 解析 Xing/Info 帧（以及其后的 LAME 扩展）；frame 指向帧头，len 为可用字节
+static bool parseXing(const uint8_t *frame, uint32_t len, const Mp3FrameHeader &fh, Mp3StreamInfo &info)
+{
+    uint32_t off = 4 + fh.sideInfoBytes;
+    if (off + 8 > len)
+        return false;
+    const uint8_t *x = frame + off;
+    if (memcmp(x, "Xing", 4) != 0 && memcmp(x, "Info", 4) != 0)
+        return false;
+
+    uint32_t flags = be32(x + 4);
+    uint32_t p = off + 8;
+    if ((flags & 0x01) && p + 4 <= len)
+    {
+        info.frameCount = be32(frame + p);
+        p += 4;
+    }
+    if ((flags & 0x02) && p + 4 <= len)
+    {
+        info.streamBytes = be32(frame + p);
+        p += 4;
+    }
+    if (flags & 0x04)
+    {
+        if (p + 100 <= len)
+        {
+            memcpy(info.toc, frame + p, 100);
+            info.hasToc = true;
+        }
+        p += 100;
+    }
+    if (flags & 0x08)
+        p += 4; // quality
+
+    // LAME 扩展：9 字节编码器标识，偏移 21 处 3 字节 = delay(12bit) + padding(12bit)
+    if (p + 24 <= len)
+    {
+        const uint8_t *lame = frame + p;
+        if (memcmp(lame, "LAME", 4) == 0 || memcmp(lame, "Lavf", 4) == 0 || memcmp(lame, "Lavc", 4) == 0)
+        {
+            info.hasLame = true;
+            info.encoderDelay = (uint16_t)((lame[21] << 4) | (lame[22] >> 4));
+            info.encoderPadding = (uint16_t)(((lame[22] & 0x0F) << 8) | lame[23]);
+        }
+    }
+    info.hasXing = true;
+    info.isVbr = x[0] == 'X'; // LAME 给 CBR 写 Info，VBR/ABR 写 Xing
+    return true;
+}
+
+// VBRI（Fraunhofer）头固定在帧头后 32 字节
+static bool parseVbri(const uint8_t *frame, uint32_t len, uint32_t framePos, Mp3StreamInfo &info)
+{
+    const uint32_t off = 4 + 32;
+    if (off + 18 > len || memcmp(frame + off, "VBRI", 4) != 0)
+        return false;
+    const uint8_t *v = frame + off;
+    info.encoderDelay = be16(v + 6);
+    info.streamBytes = be32(v + 10);
+    info.frameCount = be32(v + 14);
+    info.vbriPos = framePos + off;
+    info.hasXing = true;
+    info.isVbr = true;
+    return true;
+}
+
+bool mp3ReadStreamInfo(AudioFileSource *src, Mp3StreamInfo &info, const TrackLayout *layout)
+{
+    memset(&info, 0, sizeof(info));
+    uint32_t size = src->getSize();
+    info.audioEnd = size;
+
+    uint8_t hdr[10];
+    uint32_t got = 0;
+    uint32_t pos = 0;
+
+    if (layout && layout->start < layout->end && layout->end <= size)
+    {
+        pos = layout->start;
+        info.audioEnd = layout->end;
+    }
+    else
+    {
+        layout = nullptr;
+
+        // 1. 跳过（可能连续出现的）ID3v2 标签，只读 10 字节头
+        while (pos + 10 <= size && readAt(src, pos, hdr, 10, &got) && got == 10 && memcmp(hdr, "ID3", 3) == 0)
+        {
+            uint32_t tagSize = ((uint32_t)(hdr[6] & 0x7F) << 21) | ((uint32_t)(hdr[7] & 0x7F) << 14) |
+                               ((uint32_t)(hdr[8] & 0x7F) << 7) | (uint32_t)(hdr[9] & 0x7F);
+            pos += 10 + tagSize + ((hdr[5] & 0x10) ? 10 : 0);
+        }
+
+        // 2. ID3v1 尾部
+        if (size >= 128 && readAt(src, size - 128, hdr, 3, &got) && got == 3 && memcmp(hdr, "TAG", 3) == 0)
+            info.audioEnd = size - 128;
+    }
+    info.tagEnd = pos;
+
+    if (pos >= info.audioEnd)
+        return false;
+
+    // 3. 在窗口内找第一个帧头（要求紧随的下一帧也合法，避免误判）
+    uint8_t *buf = (uint8_t *)malloc(MP3_SCAN_WINDOW);
+    if (!buf)
+        return false;
+
+    bool found = false;
+    Mp3FrameHeader fh;
+    if (readAt(src, pos, buf, MP3_SCAN_WINDOW, &got))
+    {
+        int i = mp3FindFrameSync(buf, got, fh);
+        if (i >= 0)
+        {
+            pos += i;
+            found = true;
+            // 让帧位于缓冲区开头，方便解析 Xing/LAME
+            if (i > 0)
+                readAt(src, pos, buf, MP3_SCAN_WINDOW, &got);
+        }
+    }
+
+    if (found)
+    {
+        info.audioStart = pos;
+        info.sampleRate = fh.sampleRate;
+        info.samplesPerFrame = fh.samplesPerFrame;
+        info.channels = fh.channels;
+        info.bitrateKbps = fh.bitrateKbps;
+
+        uint32_t avail = got < fh.frameBytes ? got : fh.frameBytes;
+        if (parseXing(buf, avail, fh, info))
+        {
+            // Xing/Info 帧本身不含音频（解码出来是一帧静音），直接跳过
+            info.audioStart = pos + fh.frameBytes;
+        }
+        else if (parseVbri(buf, avail, pos, info))
+        {
+            // VBRI 同样放在一个不含音频的帧里，TOC 从下一帧开始计
+            info.audioStart = pos + fh.frameBytes;
+        }
+    }
+
+    free(buf);
+    // 记下的范围与文件对不上（不该发生，文件改动后曲库会作废它）：按完整流程重来
+    if (!found && layout)
+        return mp3ReadStreamInfo(src, info, nullptr);
+    return found;
+}
+
+uint32_t mp3LeadingTrim(const Mp3StreamInfo &info)
+{
+    if (!info.hasLame)
+        return 0;
+    return info.encoderDelay + MP3_DECODER_DELAY;
+}
+
+uint32_t mp3ValidSamples(const Mp3StreamInfo &info)
+{
+    if (!info.hasLame || info.frameCount == 0)
+        return 0;
+    uint32_t total = info.frameCount * info.samplesPerFrame;
+    uint32_t pad = info.encoderDelay + info.encoderPadding;
+    return total > pad ? total - pad : 0;
+}
+
+uint32_t mp3DurationMs(const Mp3StreamInfo &info, uint32_t frames)
+{
+    if (!info.sampleRate)
+        return 0;
+
+    if (!frames && info.hasXing)
+        frames = info.frameCount;
+    if (frames)
+    {
+        uint64_t samples = (uint64_t)frames * info.samplesPerFrame;
+        uint32_t pad = info.hasLame ? info.encoderDelay + info.encoderPadding : 0;
+        samples = samples > pad ? samples - pad : 0;
+        return (uint32_t)(samples * 1000 / info.sampleRate);
+    }
+    if (info.bitrateKbps)
+        return (uint32_t)((uint64_t)(info.audioEnd - info.audioStart) * 8 / info.bitrateKbps);
+    return 0;
+}
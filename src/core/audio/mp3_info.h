@@ -0,0 +1,63 @@
+#pragma once
+#include <stdint.h>
+#include <AudioFileSource.h>
+#include "core/audio/audio_format.h"
+
+// MP3 解码器固有延迟（合成滤波器组 528 + 1），LAME 的 encoder delay 不含这一部分
+#define MP3_DECODER_DELAY 529
+
+struct Mp3FrameHeader
+{
+    uint32_t sampleRate;
+    uint16_t bitrateKbps;
+    uint16_t frameBytes;
+    uint16_t samplesPerFrame;
+    uint8_t channels;
+    uint8_t sideInfoBytes;
+};
+
+// 解析 4 字节帧头（只接受 Layer III）；非法帧头返回 false
+bool mp3ParseFrameHeader(const uint8_t *h, Mp3FrameHeader &out);
+
+// 在 buf 中找第一个帧头（要求紧随的下一帧也合法，避免误判），返回下标，没有则 -1
+int mp3FindFrameSync(const uint8_t *buf, uint32_t len, Mp3FrameHeader &fh);
+
+// seek 到 pos 后读满 len 字节（文件结束时可能不足），返回实际读到的字节数
+uint32_t mp3ReadAt(AudioFileSource *src, uint32_t pos, uint8_t *buf, uint32_t len);
+
+// 曲目打开时解析的流信息：ID3v2 范围、首帧参数、Xing/Info/LAME/VBRI 头
+struct Mp3StreamInfo
+{
+    uint32_t tagEnd;     // 所有 ID3v2 标签之后的第一个字节
+    uint32_t audioStart; // 第一帧音频的位置（已跳过 ID3v2 和 Xing/Info/VBRI 帧）
+    uint32_t audioEnd;   // 音频结束位置（已排除 ID3v1 尾部）
+
+    uint32_t sampleRate;
+    uint16_t samplesPerFrame;
+    uint8_t channels;
+    uint16_t bitrateKbps; // 首帧码率
+
+    bool hasXing; // Xing/Info 或 VBRI
+    bool isVbr;   // Xing 或 VBRI；Info 表示 CBR
+    uint32_t frameCount;
+    uint32_t streamBytes;
+
+    bool hasToc;     // Xing TOC：时间百分比 -> 字节位置（1/256）
+    uint8_t toc[100];
+    uint32_t vbriPos; // VBRI 头在文件中的位置（0 表示没有），TOC 表由 seek 索引按需读取
+
+    bool hasLame;
+    uint16_t encoderDelay;
+    uint16_t encoderPadding;
+};
+
+// 从 src 当前文件读取流信息；只读取头部附近和末尾 128 字节。
+// 给出 layout 时直接从 layout->start 找帧同步，不读标签头和文件末尾；在那里找不到时退回完整流程。
+// 返回后 src 的读写位置未定义，调用方需要自行 seek
+bool mp3ReadStreamInfo(AudioFileSource *src, Mp3StreamInfo &info, const TrackLayout *layout = nullptr);
+
+// 解码后需要丢弃的开头样本数 / 有效样本总数（未知时为 0）
+uint32_t mp3LeadingTrim(const Mp3StreamInfo &info);
+uint32_t mp3ValidSamples(const Mp3StreamInfo &info);
+// 时长：frames 为 0 时用 Xing/VBRI 记录的帧数，都没有就按首帧码率估算；扣除 LAME 记录的延迟和填充
+uint32_t mp3DurationMs(const Mp3StreamInfo &info, uint32_t frames);
@@ -0,0 +1,395 @@
+#include "core/audio/mp3_seek.h"
+#include <esp_heap_caps.h>
+#include <string.h>
+
+// 估算位置附近找帧同步的窗口
+#define MP3_SYNC_WINDOW 2048
+
+// ==========================
+// 索引缓存（按曲目，LRU）
+// ==========================
+static Mp3SeekIndex *g_slots[MP3_INDEX_CACHE_SLOTS] = {};
+static uint32_t g_useClock = 0;
+
+static uint32_t trackKey(const char *path, uint32_t size)
+{
+    uint32_t h = 2166136261u;
+    for (const char *p = path; *p; p++)
+        h = (h ^ (uint8_t)*p) * 16777619u;
+    return h ^ size;
+}
+
+static void indexReset(Mp3SeekIndex *idx, uint32_t key)
+{
+    idx->key = key;
+    idx->users = 0;
+    idx->exact = true;
+    idx->complete = false;
+    idx->stride = 1;
+    idx->count = 0;
+    idx->frames = 0;
+}
+
+static Mp3SeekIndex *indexAcquire(uint32_t key, bool *fresh)
+{
+    Mp3SeekIndex *victim = nullptr;
+    int freeSlot = -1;
+    for (int i = 0; i < MP3_INDEX_CACHE_SLOTS; i++)
+    {
+        Mp3SeekIndex *idx = g_slots[i];
+        if (!idx)
+        {
+            if (freeSlot < 0)
+                freeSlot = i;
+            continue;
+        }
+        if (idx->key == key)
+        {
+            idx->users++;
+            idx->lastUse = ++g_useClock;
+            *fresh = false;
+            return idx;
+        }
+        if (idx->users == 0 && (!victim || idx->lastUse < victim->lastUse))
+            victim = idx;
+    }
+
+    if (freeSlot >= 0)
+    {
+        size_t bytes = sizeof(Mp3SeekIndex);
+        victim = (Mp3SeekIndex *)(psramFound() ? heap_caps_malloc(bytes, MALLOC_CAP_SPIRAM) : malloc(bytes));
+        if (victim)
+            g_slots[freeSlot] = victim;
+    }
+    if (!victim)
+        return nullptr;
+
+    indexReset(victim, key);
+    victim->users = 1;
+    victim->lastUse = ++g_useClock;
+    *fresh = true;
+    return victim;
+}
+
+// 只接受紧接在已知范围后面的帧；条目满了就隔一丢一、步长加倍
+static void indexAddFrame(Mp3SeekIndex *idx, uint32_t frame, uint32_t off)
+{
+    if (frame != idx->frames)
+        return;
+    if (frame % idx->stride == 0)
+    {
+        if (idx->count == MP3_INDEX_MAX_ENTRIES)
+        {
+            for (uint32_t i = 0; i < MP3_INDEX_MAX_ENTRIES / 2; i++)
+                idx->offsets[i] = idx->offsets[i * 2];
+            idx->count = MP3_INDEX_MAX_ENTRIES / 2;
+            idx->stride *= 2;
+        }
+        if (frame % idx->stride == 0)
+            idx->offsets[idx->count++] = off;
+    }
+    idx->frames++;
+}
+
+// 把 VBRI 表（每项 = 一段帧的字节数）换算成稀疏索引
+static void indexSeedVbri(Mp3SeekIndex *idx, AudioFileSource *src, const Mp3StreamInfo &info)
+{
+    uint8_t h[26];
+    if (mp3ReadAt(src, info.vbriPos, h, sizeof(h)) != sizeof(h))
+        return;
+    uint32_t entries = (h[18] << 8) | h[19];
+    uint32_t scale = (h[20] << 8) | h[21];
+    uint32_t entrySize = (h[22] << 8) | h[23];
+    uint32_t perEntry = (h[24] << 8) | h[25];
+    if (entries == 0 || perEntry == 0 || entrySize == 0 || entrySize > 4)
+        return;
+
+    // 表项多于索引容量时合并相邻几项
+    uint32_t merge = (entries + MP3_INDEX_MAX_ENTRIES - 1) / MP3_INDEX_MAX_ENTRIES;
+    idx->stride = perEntry * merge;
+    idx->exact = false;
+    idx->count = 0;
+
+    uint8_t buf[256];
+    uint32_t tableLen = entries * entrySize;
+    uint32_t done = 0;
+    uint32_t off = info.audioStart;
+    uint32_t item = 0;
+    while (done < tableLen)
+    {
+        uint32_t want = tableLen - done;
+        if (want > sizeof(buf) - sizeof(buf) % entrySize)
+            want = sizeof(buf) - sizeof(buf) % entrySize;
+        if (mp3ReadAt(src, info.vbriPos + 26 + done, buf, want) != want)
+            break;
+        for (uint32_t i = 0; i + entrySize <= want; i += entrySize, item++)
+        {
+            if (item % merge == 0 && idx->count < MP3_INDEX_MAX_ENTRIES)
+                idx->offsets[idx->count++] = off;
+            uint32_t v = 0;
+            for (uint32_t b = 0; b < entrySize; b++)
+                v = (v << 8) | buf[i + b];
+            off += v * scale;
+        }
+        done += want;
+    }
+
+    idx->frames = info.frameCount;
+    idx->complete = idx->count > 0;
+}
+
+// ==========================
+// Mp3SeekSource
+// ==========================
+Mp3SeekSource::Mp3SeekSource(AudioFileSource *inner, const Mp3StreamInfo &info, const char *path)
+    : TrackSource(inner, AudioFormat::MP3), info(info), index(nullptr),
+      walking(false), nextOff(info.audioStart), nextFrame(0), hdrHave(0)
+{
+    bool fresh = false;
+    if (info.sampleRate)
+        index = indexAcquire(trackKey(path, inner->getSize()), &fresh);
+
+    if (index && fresh && info.vbriPos)
+    {
+        // 读 VBRI 表会移动读位置，读完回到第一帧
+        uint32_t pos = inner->getPos();
+        indexSeedVbri(index, inner, info);
+        inner->seek(pos, SEEK_SET);
+    }
+    walking = index && index->exact && !index->complete && inner->getPos() == info.audioStart;
+}
+
+Mp3SeekSource::~Mp3SeekSource()
+{
+    if (index && index->users > 0)
+        index->users--;
+}
+
+// 沿帧头前进：每个帧头告诉我们下一帧在哪，解码器读到哪里就走到哪里
+void Mp3SeekSource::walk(uint32_t at, const uint8_t *p, uint32_t n)
+{
+    uint32_t end = at + n;
+    while (walking && nextOff + hdrHave < end)
+    {
+        if (nextOff + hdrHave < at)
+        {
+            walking = false; // 中间有数据没经过这里
+            break;
+        }
+        while (hdrHave < 4 && nextOff + hdrHave < end)
+        {
+            hdr[hdrHave] = p[nextOff + hdrHave - at];
+            hdrHave++;
+        }
+        if (hdrHave < 4)
+            break;
+        hdrHave = 0;
+
+        Mp3FrameHeader fh;
+        if (!mp3ParseFrameHeader(hdr, fh))
+        {
+            walking = false;
+            break;
+        }
+        indexAddFrame(index, nextFrame, nextOff);
+        nextFrame++;
+        nextOff += fh.frameBytes;
+        if (nextOff >= info.audioEnd)
+        {
+            index->complete = index->frames == nextFrame;
+            walking = false;
+        }
+    }
+}
+
+uint32_t Mp3SeekSource::read(void *data, uint32_t len)
+{
+    uint32_t at = inner->getPos();
+    uint32_t n = inner->read(data, len);
+    if (walking)
+        walk(at, (const uint8_t *)data, n);
+    return n;
+}
+
+uint32_t Mp3SeekSource::readNonBlock(void *data, uint32_t len)
+{
+    uint32_t at = inner->getPos();
+    uint32_t n = inner->readNonBlock(data, len);
+    if (walking)
+        walk(at, (const uint8_t *)data, n);
+    return n;
+}
+
+bool Mp3SeekSource::seek(int32_t pos, int dir)
+{
+    // 任意位置 seek 后不知道帧号，停止补索引
+    walking = false;
+    return inner->seek(pos, dir);
+}
+
+uint32_t Mp3SeekSource::durationMs()
+{
+    return mp3DurationMs(info, index && index->complete ? index->frames : 0);
+}
+
+// 从估算位置起找第一个可靠的帧头
+uint32_t Mp3SeekSource::syncFrom(uint32_t off)
+{
+    uint8_t *buf = (uint8_t *)malloc(MP3_SYNC_WINDOW);
+    if (!buf)
+        return off;
+    uint32_t got = mp3ReadAt(inner, off, buf, MP3_SYNC_WINDOW);
+    Mp3FrameHeader fh;
+    int i = mp3FindFrameSync(buf, got, fh);
+    free(buf);
+    return i >= 0 ? off + i : off;
+}
+
+// 目标时间所在的帧号（已夹到总帧数以内）；total 输出已知的总帧数，未知为 0
+uint32_t Mp3SeekSource::frameAt(uint32_t ms, uint32_t *total)
+{
+    uint64_t sample = (uint64_t)ms * info.sampleRate / 1000 + mp3LeadingTrim(info);
+    uint32_t frame = (uint32_t)(sample / info.samplesPerFrame);
+
+    *total = 0;
+    if (index && index->complete)
+        *total = index->frames;
+    else if (info.hasXing)
+        *total = info.frameCount;
+    if (*total && frame >= *total)
+        frame = *total - 1;
+    return frame;
+}
+
+bool Mp3SeekSource::locateQuick(uint32_t ms, TrackSeekPoint &pt)
+{
+    if (!info.sampleRate || !info.samplesPerFrame || !index || !index->exact || index->count == 0)
+        return false;
+
+    uint32_t total;
+    uint32_t frame = frameAt(ms, &total);
+    if (frame >= index->frames)
+        return false;
+
+    uint32_t k = frame / index->stride;
+    if (k >= index->count)
+        k = index->count - 1;
+    pt.offset = index->offsets[k];
+    pt.sample = k * index->stride * info.samplesPerFrame;
+    pt.exact = true;
+    return true;
+}
+
+// 一小时的混音步长会涨到 256 帧（约 6.7 秒），不走这一段的话 5 秒的快进可能落回原地
+bool Mp3SeekSource::refineTo(uint32_t ms, TrackSeekPoint &pt)
+{
+    if (!pt.exact || !info.sampleRate || !info.samplesPerFrame)
+        return true;
+    uint32_t total;
+    uint32_t target = frameAt(ms, &total);
+    uint32_t frame = pt.sample / info.samplesPerFrame;
+    if (target <= frame)
+        return true;
+
+    uint8_t *buf = (uint8_t *)malloc(MP3_SYNC_WINDOW);
+    if (!buf)
+        return false;
+    uint32_t off = pt.offset;
+    uint32_t bufAt = 0;
+    uint32_t got = 0;
+    while (true)
+    {
+        if (off < bufAt || off + 4 > bufAt + got)
+        {
+            bufAt = off;
+            got = mp3ReadAt(inner, off, buf, MP3_SYNC_WINDOW);
+            if (got < 4)
+                break;
+        }
+        Mp3FrameHeader fh;
+        if (!mp3ParseFrameHeader(buf + (off - bufAt), fh))
+            break;
+        // off 处确认是帧头才更新落点；中途解析失败就停在最后一个好的帧头
+        pt.offset = off;
+        pt.sample = frame * info.samplesPerFrame;
+        if (frame == target || off + fh.frameBytes >= info.audioEnd)
+            break;
+        off += fh.frameBytes;
+        frame++;
+    }
+    free(buf);
+    return true;
+}
+
+bool Mp3SeekSource::locate(uint32_t ms, TrackSeekPoint &pt)
+{
+    if (!info.sampleRate || !info.samplesPerFrame)
+        return false;
+
+    // 1. 已走过的范围：查索引取前一个条目，再沿帧头走到目标帧
+    if (locateQuick(ms, pt))
+        return refineTo(ms, pt);
+
+    uint32_t total;
+    uint32_t frame = frameAt(ms, &total);
+
+    // 2. 其余情况先估算字节位置
+    uint32_t audioBytes = info.audioEnd - info.audioStart;
+    uint32_t off;
+    uint32_t estFrame = frame;
+    if (index && !index->exact && index->count > 0)
+    {
+        uint32_t k = frame / index->stride;
+        if (k >= index->count)
+            k = index->count - 1;
+        off = index->offsets[k];
+        estFrame = k * index->stride;
+    }
+    else if (info.hasToc && total)
+    {
+        float pct = (float)frame * 100.0f / total;
+        int i = (int)pct;
+        if (i > 99)
+            i = 99;
+        float a = info.toc[i];
+        float b = i < 99 ? info.toc[i + 1] : 256.0f;
+        float frac = (a + (b - a) * (pct - i)) / 256.0f;
+        uint32_t bytes = info.streamBytes ? info.streamBytes : audioBytes;
+        off = info.audioStart + (uint32_t)(frac * bytes);
+    }
+    else if (index && index->count > 1)
+    {
+        // 按已走过部分的平均帧长外推
+        uint32_t lastFrame = (index->count - 1) * index->stride;
+        uint32_t last = index->offsets[index->count - 1];
+        float bpf = (float)(last - info.audioStart) / lastFrame;
+        off = last + (uint32_t)((frame - lastFrame) * bpf);
+    }
+    else
+    {
+        // 按首帧码率当作 CBR
+        float bpf = (float)info.samplesPerFrame * 125.0f * info.bitrateKbps / info.sampleRate;
+        off = info.audioStart + (uint32_t)(frame * bpf);
+    }
+
+    if (off >= info.audioEnd)
+        off = info.audioEnd > MP3_SYNC_WINDOW ? info.audioEnd - MP3_SYNC_WINDOW : info.audioStart;
+    if (off < info.audioStart)
+        off = info.audioStart;
+
+    pt.offset = syncFrom(off);
+    pt.sample = estFrame * info.samplesPerFrame;
+    pt.exact = false;
+    return true;
+}
+
+bool Mp3SeekSource::seekTo(const TrackSeekPoint &pt)
+{
+    if (!inner->seek(pt.offset, SEEK_SET))
+        return false;
+    nextOff = pt.offset;
+    nextFrame = info.samplesPerFrame ? pt.sample / info.samplesPerFrame : 0;
+    hdrHave = 0;
+    walking = pt.exact && index && index->exact && !index->complete;
+    return true;
+}
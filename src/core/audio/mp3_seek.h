@@ -0,0 +1,69 @@
+#pragma once
+#include <stdint.h>
+#include "core/audio/mp3_info.h"
+#include "core/audio/track_source.h"
+
+// 稀疏帧索引最多记录的条目数；超出时隔一丢一、步长加倍（4KB/首）
+#define MP3_INDEX_MAX_ENTRIES 1024
+// 同时保留索引的曲目数（当前曲目 + 预开的下一首 + 最近播过的一首）
+#define MP3_INDEX_CACHE_SLOTS 3
+
+// 稀疏帧索引：offsets[i] 为第 i * stride 帧帧头的文件位置
+struct Mp3SeekIndex
+{
+    uint32_t key;   // 曲目标识（路径哈希 ^ 文件大小）
+    uint8_t users;  // 正在使用的 Mp3SeekSource 个数，为 0 才能被挤出缓存
+    bool exact;     // 条目是否都是实际走过的帧头（VBRI 表换算出来的不是）
+    bool complete;  // 已覆盖到文件末尾，frames 即总帧数
+    uint32_t stride;
+    uint32_t count;
+    uint32_t frames; // 从第一帧起连续已知的帧数
+    uint32_t lastUse;
+    uint32_t offsets[MP3_INDEX_MAX_ENTRIES];
+};
+
+// 包在预读源外面的解码输入：
+//   - 解码器顺序读取时沿帧头走一遍，顺手补全该曲目的稀疏帧索引（按曲目缓存）
+//   - 按时间定位：已索引范围用索引，其余依次用 Xing TOC / VBRI 表 / 平均帧长估算，
+//     估算出的位置再在附近找帧同步，保证落在帧边界上
+// 落点 offset 是帧头位置，sample 是该帧之前的样本数
+class Mp3SeekSource : public TrackSource
+{
+public:
+    Mp3SeekSource(AudioFileSource *inner, const Mp3StreamInfo &info, const char *path);
+    virtual ~Mp3SeekSource() override;
+
+    virtual uint32_t read(void *data, uint32_t len) override;
+    virtual uint32_t readNonBlock(void *data, uint32_t len) override;
+    virtual bool seek(int32_t pos, int dir) override;
+
+    const Mp3StreamInfo &getInfo() const { return info; }
+
+    virtual uint32_t sampleRate() const override { return info.sampleRate; }
+    virtual uint32_t leadingTrim() const override { return mp3LeadingTrim(info); }
+    virtual uint32_t validSamples() const override { return mp3ValidSamples(info); }
+    // 没有 Xing/VBRI 且索引未走完时按首帧码率估算
+    virtual uint32_t durationMs() override;
+    virtual bool locate(uint32_t ms, TrackSeekPoint &pt) override;
+    // 只查已走过的帧索引，落点是不晚于 ms 的索引条目（最多差 stride - 1 帧）
+    virtual bool locateQuick(uint32_t ms, TrackSeekPoint &pt) override;
+    // 从索引条目沿帧头往后走到 ms 所在的帧
+    virtual bool refineTo(uint32_t ms, TrackSeekPoint &pt) override;
+    // seek 之后让帧索引从落点接着走（仅 exact 时）
+    virtual bool seekTo(const TrackSeekPoint &pt) override;
+
+private:
+    void walk(uint32_t at, const uint8_t *p, uint32_t n);
+    uint32_t syncFrom(uint32_t off);
+    uint32_t frameAt(uint32_t ms, uint32_t *total);
+
+    Mp3StreamInfo info;
+    Mp3SeekIndex *index;
+
+    // 帧头遍历状态
+    bool walking;
+    uint32_t nextOff;
+    uint32_t nextFrame;
+    uint8_t hdr[4];
+    uint8_t hdrHave;
+};
@@ -0,0 +1,326 @@
+#include "core/audio/readahead_source.h"
+#include "core/audio/audio_telemetry.h"
+#include <esp_heap_caps.h>
+#include "log.h"
+
+// I/O 任务放在核心 1（与输入循环同核），解码在核心 0；优先级高于 UI，SD 读完立即补货
+#define READAHEAD_TASK_STACK 4096
+#define READAHEAD_TASK_PRIO 2
+#define READAHEAD_TASK_CORE 1
+// 读空时单次等待上限；超时后重新检查状态，避免 I/O 任务异常时永久阻塞
+#define READAHEAD_WAIT_MS 50
+
+ReadAheadSource::ReadAheadSource()
+    : opened(false), size(0), ring(nullptr), cap(0), chunk(0), ringInPsram(false),
+      lock(nullptr), pos(0), ioPos(0), seekGen(0), ioError(false), primed(false),
+      dataReady(nullptr), exited(nullptr), task(nullptr), quit(false),
+      stalls(0), stallMs(0), ioReads(0), maxReadUs(0)
+{
+}
+
+ReadAheadSource::ReadAheadSource(const char *path, uint32_t ringBytes, uint32_t startPos)
+    : ReadAheadSource()
+{
+    open(path, ringBytes, startPos);
+}
+
+ReadAheadSource::~ReadAheadSource()
+{
+    // close() 已等 I/O 任务退出，之后没有人再用这几个信号量（每首歌都会新建一个本对象）
+    close();
+    if (lock)
+        vSemaphoreDelete(lock);
+    if (dataReady)
+        vSemaphoreDelete(dataReady);
+    if (exited)
+        vSemaphoreDelete(exited);
+}
+
+bool ReadAheadSource::open(const char *path, uint32_t ringBytes, uint32_t startPos)
+{
+    close();
+
+    f = SD.open(path, FILE_READ);
+    if (!f)
+        return false;
+    size = f.size();
+
+    // 分配环形缓冲：优先 PSRAM，失败时退回内部 RAM 的小缓冲
+    bool psram = psramFound();
+    if (ringBytes == 0)
+        ringBytes = psram ? READAHEAD_RING_PSRAM : READAHEAD_RING_DRAM;
+    ring = psram ? (uint8_t *)heap_caps_malloc(ringBytes, MALLOC_CAP_SPIRAM) : nullptr;
+    ringInPsram = ring != nullptr;
+    if (!ring)
+    {
+        if (ringBytes > READAHEAD_RING_DRAM)
+            ringBytes = READAHEAD_RING_DRAM;
+        ring = (uint8_t *)malloc(ringBytes);
+    }
+    if (!ring)
+    {
+        LOG_AUDIO("readahead: no memory for %lu byte ring", (unsigned long)ringBytes);
+        f.close();
+        return false;
+    }
+
+    // 单次读取取 2 的幂，容量取其整数倍，保证对齐后的读取不跨越缓冲末尾
+    chunk = READAHEAD_IO_CHUNK_MAX;
+    while (chunk > READAHEAD_IO_CHUNK_MIN && chunk * 4 > ringBytes)
+        chunk >>= 1;
+    cap = ringBytes - ringBytes % chunk;
+
+    if (!lock)
+        lock = xSemaphoreCreateMutex();
+    if (!dataReady)
+        dataReady = xSemaphoreCreateBinary();
+    if (!exited)
+        exited = xSemaphoreCreateBinary();
+
+    pos = ioPos = startPos < size ? startPos : size;
+    seekGen++;
+    ioError = false;
+    primed = false;
+    stalls = stallMs = ioReads = maxReadUs = 0;
+    quit = false;
+    opened = true;
+
+    if (xTaskCreatePinnedToCore(ioTaskEntry, "SDRead", READAHEAD_TASK_STACK, this,
+                                READAHEAD_TASK_PRIO, &task, READAHEAD_TASK_CORE) != pdPASS)
+    {
+        task = nullptr;
+        close();
+        return false;
+    }
+    return true;
+}
+
+bool ReadAheadSource::close()
+{
+    if (task)
+    {
+        // 等 I/O 任务把在途的读取做完再释放缓冲
+        quit = true;
+        xTaskNotifyGive(task);
+        xSemaphoreTake(exited, portMAX_DELAY);
+        task = nullptr;
+
+        if (stalls > 0)
+            LOG_AUDIO("readahead: %lu stalls, %lu ms, slowest read %lu us",
+                      (unsigned long)stalls, (unsigned long)stallMs, (unsigned long)maxReadUs);
+    }
+    if (ring)
+    {
+        if (ringInPsram)
+            heap_caps_free(ring);
+        else
+            free(ring);
+        ring = nullptr;
+    }
+    if (opened)
+        f.close();
+    opened = false;
+    return true;
+}
+
+void ReadAheadSource::ioTaskEntry(void *arg)
+{
+    ReadAheadSource *self = (ReadAheadSource *)arg;
+    self->ioTask();
+    xSemaphoreGive(self->exited);
+    vTaskDelete(NULL);
+}
+
+void ReadAheadSource::ioTask()
+{
+    uint32_t filePos = 0;
+    while (!quit)
+    {
+        xSemaphoreTake(lock, portMAX_DELAY);
+        uint32_t gen = seekGen;
+        uint32_t off = ioPos;
+        uint32_t space = cap - (ioPos - pos);
+        bool idle = ioError || off >= size;
+        xSemaphoreGive(lock);
+
+        // 读到下一个块边界；seek 之后的第一次读取可能不足一块
+        uint32_t want = chunk - off % chunk;
+        if (want > size - off)
+            want = size - off;
+        if (idle || space < want)
+        {
+            ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(100));
+            continue;
+        }
+
+        if (filePos != off && !f.seek(off))
+        {
+            xSemaphoreTake(lock, portMAX_DELAY);
+            if (gen == seekGen)
+                ioError = true;
+            xSemaphoreGive(lock);
+            xSemaphoreGive(dataReady);
+            continue;
+        }
+
+        uint32_t t0 = micros();
+        int n = f.read(ring + off % cap, want);
+        uint32_t us = micros() - t0;
+        filePos = n > 0 ? off + n : 0xFFFFFFFFu;
+        audioTelemetrySdRead(us);
+
+        xSemaphoreTake(lock, portMAX_DELAY);
+        ioReads++;
+        if (us > maxReadUs)
+            maxReadUs = us;
+        // 读取期间发生过 seek：这块数据作废，下标区域也不会被新一代数据以外的读者看到
+        if (gen == seekGen)
+        {
+            if (n > 0)
+                ioPos += n;
+            else
+                ioError = true;
+        }
+        xSemaphoreGive(lock);
+        xSemaphoreGive(dataReady);
+    }
+}
+
+void ReadAheadSource::kick()
+{
+    if (task)
+        xTaskNotifyGive(task);
+}
+
+// 从缓冲取出不超过 len 的数据；[pos, ioPos) 只有解码线程会读，拷贝不需要持锁
+uint32_t ReadAheadSource::take(uint8_t *dst, uint32_t len)
+{
+    xSemaphoreTake(lock, portMAX_DELAY);
+    uint32_t avail = ioPos - pos;
+    uint32_t at = pos;
+    xSemaphoreGive(lock);
+
+    if (len > avail)
+        len = avail;
+    if (len == 0)
+        return 0;
+
+    uint32_t idx = at % cap;
+    uint32_t first = cap - idx;
+    if (first > len)
+        first = len;
+    memcpy(dst, ring + idx, first);
+    if (len > first)
+        memcpy(dst + first, ring, len - first);
+
+    xSemaphoreTake(lock, portMAX_DELAY);
+    pos += len;
+    primed = true;
+    uint32_t space = cap - (ioPos - pos);
+    xSemaphoreGive(lock);
+
+    if (space >= chunk)
+        kick();
+    return len;
+}
+
+uint32_t ReadAheadSource::read(void *data, uint32_t len)
+{
+    if (!opened)
+        return 0;
+
+    uint8_t *dst = (uint8_t *)data;
+    uint32_t n = 0;
+    uint32_t stallStart = 0;
+    bool stalled = false;
+
+    while (n < len)
+    {
+        uint32_t got = take(dst + n, len - n);
+        if (got > 0)
+        {
+            n += got;
+            continue;
+        }
+
+        xSemaphoreTake(lock, portMAX_DELAY);
+        bool ended = ioError || pos >= size;
+        bool countStall = primed && !stalled;
+        xSemaphoreGive(lock);
+        if (ended)
+            break;
+
+        if (countStall)
+        {
+            stalled = true;
+            stallStart = millis();
+            stalls++;
+        }
+        kick();
+        xSemaphoreTake(dataReady, pdMS_TO_TICKS(READAHEAD_WAIT_MS));
+    }
+
+    if (stalled)
+        stallMs += millis() - stallStart;
+    return n;
+}
+
+uint32_t ReadAheadSource::readNonBlock(void *data, uint32_t len)
+{
+    if (!opened)
+        return 0;
+    return take((uint8_t *)data, len);
+}
+
+bool ReadAheadSource::seek(int32_t offset, int dir)
+{
+    if (!opened)
+        return false;
+
+    int64_t target = offset;
+    if (dir == SEEK_CUR)
+        target += pos;
+    else if (dir == SEEK_END)
+        target += size;
+    if (target < 0 || target > size)
+        return false;
+
+    xSemaphoreTake(lock, portMAX_DELAY);
+    if ((uint32_t)target >= pos && (uint32_t)target <= ioPos)
+    {
+        // 目标已在缓冲里：直接跳过，不丢数据
+        pos = (uint32_t)target;
+    }
+    else
+    {
+        pos = ioPos = (uint32_t)target;
+        seekGen++;
+        ioError = false;
+        primed = false;
+    }
+    xSemaphoreGive(lock);
+
+    kick();
+    return true;
+}
+
+uint32_t ReadAheadSource::getFill()
+{
+    xSemaphoreTake(lock, portMAX_DELAY);
+    uint32_t fill = opened ? ioPos - pos : 0;
+    xSemaphoreGive(lock);
+    return fill;
+}
+
+ReadAheadStats ReadAheadSource::getStats()
+{
+    ReadAheadStats s;
+    s.capacity = cap;
+    s.fill = lock ? getFill() : 0;
+    s.stalls = stalls;
+    s.stallMs = stallMs;
+    s.ioReads = ioReads;
+    s.maxReadUs = maxReadUs;
+    s.psram = ringInPsram;
+    return s;
+}
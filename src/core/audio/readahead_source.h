@@ -0,0 +1,84 @@
+#pragma once
+#include <AudioFileSource.h>
+#include <SD.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
+#include <freertos/task.h>
+
+// 环形缓冲默认大小：有 PSRAM 时 256KB（320kbps 约 6.5 秒），否则在内部 RAM 里放 16KB
+#define READAHEAD_RING_PSRAM (256 * 1024)
+#define READAHEAD_RING_DRAM (16 * 1024)
+// 单次 SD 读取的上限；按文件偏移对齐，常见 SDHC 簇大小为 32KB
+#define READAHEAD_IO_CHUNK_MAX (32 * 1024)
+#define READAHEAD_IO_CHUNK_MIN (4 * 1024)
+
+struct ReadAheadStats
+{
+    uint32_t capacity;  // 环形缓冲字节数
+    uint32_t fill;      // 当前已缓冲、尚未被解码器读走的字节数
+    uint32_t stalls;    // 缓冲读空、解码器被迫等待的次数（不含打开/seek 后的首次填充）
+    uint32_t stallMs;   // 累计等待时长
+    uint32_t ioReads;   // SD 读取次数
+    uint32_t maxReadUs; // 单次 SD 读取的最长耗时
+    bool psram;
+};
+
+// 带预读的 SD 文件源：独立 I/O 任务按块对齐大块读取到环形缓冲，
+// 解码循环只做内存拷贝，SD 延迟尖峰被缓冲吸收。
+// 环形缓冲下标 = 文件偏移 % 容量，块对齐的读取不会跨越缓冲末尾。
+// 除 I/O 任务外只允许一个线程（解码线程）调用 read/seek。
+class ReadAheadSource : public AudioFileSource
+{
+public:
+    ReadAheadSource();
+    // ringBytes 为 0 时按是否有 PSRAM 取默认值；预读从 startPos 开始（读位置也在那里），
+    // 打开时已知音频起点就不会先把开头的封面等标签读进缓冲
+    explicit ReadAheadSource(const char *path, uint32_t ringBytes = 0, uint32_t startPos = 0);
+    virtual ~ReadAheadSource() override;
+
+    bool open(const char *path, uint32_t ringBytes, uint32_t startPos = 0);
+    virtual bool open(const char *path) override { return open(path, 0); }
+    virtual uint32_t read(void *data, uint32_t len) override;
+    virtual uint32_t readNonBlock(void *data, uint32_t len) override;
+    virtual bool seek(int32_t pos, int dir) override;
+    virtual bool close() override;
+    virtual bool isOpen() override { return opened; }
+    virtual uint32_t getSize() override { return size; }
+    virtual uint32_t getPos() override { return pos; }
+
+    uint32_t getFill();
+    ReadAheadStats getStats();
+
+private:
+    static void ioTaskEntry(void *arg);
+    void ioTask();
+    uint32_t take(uint8_t *dst, uint32_t len);
+    void kick();
+
+    File f;
+    bool opened;
+    uint32_t size;
+
+    uint8_t *ring;
+    uint32_t cap;
+    uint32_t chunk;
+    bool ringInPsram;
+
+    // 以下由 lock 保护；pos 只由解码线程修改，ioPos 由 I/O 任务推进、seek 时重置
+    SemaphoreHandle_t lock;
+    uint32_t pos;     // 解码器读位置（文件偏移）
+    uint32_t ioPos;   // 已缓冲数据的末尾（文件偏移），有效数据为 [pos, ioPos)
+    uint32_t seekGen; // 每次丢弃缓冲递增，I/O 任务据此作废在途的读取
+    bool ioError;
+    bool primed; // 打开/seek 后已拿到过数据，之后再读空才算卡顿
+
+    SemaphoreHandle_t dataReady; // I/O 任务每提交一块就 give 一次
+    SemaphoreHandle_t exited;
+    TaskHandle_t task;
+    volatile bool quit;
+
+    uint32_t stalls;
+    uint32_t stallMs;
+    uint32_t ioReads;
+    uint32_t maxReadUs;
+};
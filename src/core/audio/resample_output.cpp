@@ -0,0 +1,226 @@
+#include "core/audio/resample_output.h"
+#include "log.h"
+#include <math.h>
+#include <string.h>
+
+// 截止频率相对于输入/输出中较低那个奈奎斯特频率的比例，留出过渡带
+#define RESAMPLE_CUTOFF 0.90f
+
+static uint32_t gcd32(uint32_t a, uint32_t b)
+{
+    while (b)
+    {
+        uint32_t t = a % b;
+        a = b;
+        b = t;
+    }
+    return a;
+}
+
+ResampleOutput::ResampleOutput(AudioOutput *sink)
+    : sink(sink), rateCount(0), inRate(0), outRate(0), L(0), M(0), phase(0), histPos(0), pendLen(0), pendPos(0)
+{
+    hertz = 0;
+    bps = 16;
+    channels = 2;
+    memset(coef, 0, sizeof(coef));
+    memset(hist, 0, sizeof(hist));
+}
+
+void ResampleOutput::setOutputRates(const uint32_t *r, uint8_t count)
+{
+    rateCount = count > RESAMPLE_MAX_OUTPUT_RATES ? RESAMPLE_MAX_OUTPUT_RATES : count;
+    memcpy(rates, r, rateCount * sizeof(uint32_t));
+}
+
+void ResampleOutput::reset()
+{
+    memset(hist, 0, sizeof(hist));
+    histPos = 0;
+    phase = 0;
+    pendLen = pendPos = 0;
+}
+
+// 加窗 sinc 原型滤波器（长度 L * TAPS，工作在 L 倍输入采样率上），拆成 L 相；
+// 每相单独归一化到直流增益 1，避免各相之间的增益差变成 L 倍频的纹波
+void ResampleOutput::design()
+{
+    const int n = L * RESAMPLE_TAPS;
+    const float fc = 0.5f * RESAMPLE_CUTOFF / (L > M ? L : M); // 周期/原型采样
+    const float center = (n - 1) * 0.5f;
+    float proto[RESAMPLE_MAX_PHASES * RESAMPLE_TAPS];
+    for (int i = 0; i < n; i++)
+    {
+        float x = i - center;
+        float s = x == 0.0f ? 2.0f * fc : sinf(2.0f * (float)M_PI * fc * x) / ((float)M_PI * x);
+        float w = 0.42f - 0.5f * cosf(2.0f * (float)M_PI * (i + 0.5f) / n) + 0.08f * cosf(4.0f * (float)M_PI * (i + 0.5f) / n);
+        proto[i] = s * w;
+    }
+
+    for (int p = 0; p < L; p++)
+    {
+        float sum = 0;
+        for (int j = 0; j < RESAMPLE_TAPS; j++)
+            sum += proto[p + j * L];
+        for (int j = 0; j < RESAMPLE_TAPS; j++)
+        {
+            // 第 j 个抽头作用于倒数第 j 个输入帧，窗口按从旧到新排列，所以倒序存放
+            float c = proto[p + j * L] / sum * 32768.0f;
+            coef[p][RESAMPLE_TAPS - 1 - j] = (int16_t)lrintf(c > 32767.0f ? 32767.0f : c);
+        }
+    }
+}
+
+bool ResampleOutput::SetRate(int hz)
+{
+    if (hz <= 0)
+        return false;
+    if ((uint32_t)hz == inRate)
+        return true;
+    inRate = hz;
+
+    bool native = rateCount == 0;
+    for (uint8_t i = 0; i < rateCount; i++)
+        native |= rates[i] == inRate;
+    if (native)
+    {
+        L = M = 0;
+        outRate = inRate;
+        hertz = outRate;
+        return sink->SetRate(hz);
+    }
+
+    // 选 L 最小的输出采样率，L 相同时优先升采样（不损失高频）
+    uint32_t best = 0;
+    uint32_t bestL = 0, bestM = 0;
+    for (uint8_t i = 0; i < rateCount; i++)
+    {
+        uint32_t g = gcd32(inRate, rates[i]);
+        uint32_t l = rates[i] / g;
+        uint32_t m = inRate / g;
+        if (l > RESAMPLE_MAX_PHASES)
+            continue;
+        bool better = !best || l < bestL || (l == bestL && rates[i] >= inRate && best < inRate);
+        if (better)
+        {
+            best = rates[i];
+            bestL = l;
+            bestM = m;
+        }
+    }
+    if (!best)
+    {
+        best = rates[0];
+        bestL = RESAMPLE_MAX_PHASES;
+        bestM = (uint32_t)(((uint64_t)inRate * RESAMPLE_MAX_PHASES + best / 2) / best);
+        LOG_AUDIO("resample: %lu Hz has no exact ratio to %lu Hz, using %lu/%lu",
+                  (unsigned long)inRate, (unsigned long)best, (unsigned long)bestL, (unsigned long)bestM);
+    }
+
+    L = (uint16_t)bestL;
+    M = (uint16_t)bestM;
+    outRate = best;
+    hertz = outRate;
+    design();
+    reset();
+    LOG_AUDIO("resample: %lu -> %lu Hz (L=%u M=%u)", (unsigned long)inRate, (unsigned long)outRate,
+              (unsigned)L, (unsigned)M);
+    return sink->SetRate((int)outRate);
+}
+
+// 8 位样本在这里转成 16 位（重采样需要），下游始终是 16 位
+bool ResampleOutput::SetBitsPerSample(int bits)
+{
+    bps = bits;
+    return sink->SetBitsPerSample(16);
+}
+
+bool ResampleOutput::SetChannels(int chan)
+{
+    channels = chan;
+    return sink->SetChannels(chan);
+}
+
+bool ResampleOutput::SetGain(float f)
+{
+    return sink->SetGain(f);
+}
+
+bool ResampleOutput::begin()
+{
+    reset();
+    return sink->begin();
+}
+
+// 把上一个输入帧产生的输出帧送给下游；全部送出返回 true
+bool ResampleOutput::drain()
+{
+    while (pendPos < pendLen)
+    {
+        if (!sink->ConsumeSample(pending + pendPos * 2))
+            return false;
+        pendPos++;
+    }
+    pendLen = pendPos = 0;
+    return true;
+}
+
+bool ResampleOutput::ConsumeSample(int16_t sample[2])
+{
+    int16_t s[2] = {sample[0], sample[1]};
+    MakeSampleStereo16(s);
+    if (!L)
+        return sink->ConsumeSample(s);
+
+    if (pendLen && !drain())
+        return false;
+
+    int16_t *slot = hist + histPos * 2;
+    slot[0] = slot[RESAMPLE_TAPS * 2] = s[0];
+    slot[1] = slot[RESAMPLE_TAPS * 2 + 1] = s[1];
+    if (++histPos == RESAMPLE_TAPS)
+        histPos = 0;
+    const int16_t *win = hist + histPos * 2; // 最近 TAPS 帧，从旧到新
+
+    while (phase < L)
+    {
+        const int16_t *c = coef[phase];
+        int32_t accL = 0, accR = 0;
+        for (int k = 0; k < RESAMPLE_TAPS; k++)
+        {
+            accL += c[k] * win[2 * k];
+            accR += c[k] * win[2 * k + 1];
+        }
+        accL = (accL + (1 << 14)) >> 15;
+        accR = (accR + (1 << 14)) >> 15;
+        int16_t *o = pending + pendLen * 2;
+        o[0] = (int16_t)(accL > 32767 ? 32767 : accL < -32768 ? -32768 : accL);
+        o[1] = (int16_t)(accR > 32767 ? 32767 : accR < -32768 ? -32768 : accR);
+        pendLen++;
+        phase += M;
+    }
+    phase -= L;
+
+    drain();
+    return true;
+}
+
+bool ResampleOutput::stop()
+{
+    drain();
+    reset();
+    return sink->stop();
+}
+
+void ResampleOutput::flush()
+{
+    drain();
+    sink->flush();
+}
+
+bool ResampleOutput::loop()
+{
+    if (pendLen)
+        drain();
+    return sink->loop();
+}
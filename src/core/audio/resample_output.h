@@ -0,0 +1,60 @@
+#pragma once
+#include <stdint.h>
+#include <AudioOutput.h>
+
+// 解码器（GaplessOutput）与输出缓冲之间的采样率适配：
+//   - 流的采样率在输出端支持的列表里：直通，下游（I2S）切到该采样率
+//   - 否则选一个比值最简单的输出采样率，用定点多相 FIR 做 L/M 有理数重采样
+//     （每个输出帧固定 RESAMPLE_TAPS 次乘加，每个输入帧最多产生 ceil(L/M) 个输出帧，单块开销有上界）
+//   - 找不到 L <= RESAMPLE_MAX_PHASES 的比值时，以 L = RESAMPLE_MAX_PHASES 近似，会有微小的音高误差
+#define RESAMPLE_TAPS 16
+#define RESAMPLE_MAX_PHASES 16
+#define RESAMPLE_MAX_OUTPUT_RATES 4
+
+class ResampleOutput : public AudioOutput
+{
+public:
+    explicit ResampleOutput(AudioOutput *sink);
+
+    // 输出端原生支持的采样率，按优先顺序；未设置时一律直通
+    void setOutputRates(const uint32_t *rates, uint8_t count);
+
+    bool isResampling() const { return L != 0; }
+    uint32_t inputRate() const { return inRate; }
+    uint32_t outputRate() const { return outRate; }
+    uint16_t ratioL() const { return L; }
+    uint16_t ratioM() const { return M; }
+
+    virtual bool SetRate(int hz) override;
+    virtual bool SetBitsPerSample(int bits) override;
+    virtual bool SetChannels(int chan) override;
+    virtual bool SetGain(float f) override;
+    virtual bool begin() override;
+    virtual bool ConsumeSample(int16_t sample[2]) override;
+    virtual bool stop() override;
+    virtual void flush() override;
+    virtual bool loop() override;
+
+private:
+    void design();
+    void reset();
+    bool drain();
+
+    AudioOutput *sink;
+    uint32_t rates[RESAMPLE_MAX_OUTPUT_RATES];
+    uint8_t rateCount;
+
+    uint32_t inRate;
+    uint32_t outRate;
+    uint16_t L; // 0 表示直通
+    uint16_t M;
+    uint16_t phase;
+
+    int16_t coef[RESAMPLE_MAX_PHASES][RESAMPLE_TAPS]; // Q15，每相抽头按从旧到新排列，和历史窗口直接点乘
+    int16_t hist[RESAMPLE_TAPS * 2 * 2];              // 立体声交错，存两份让窗口在内存里连续
+    uint8_t histPos;
+
+    int16_t pending[RESAMPLE_MAX_PHASES * 2]; // 一个输入帧产生、还没送出的输出帧
+    uint8_t pendLen;
+    uint8_t pendPos;
+};
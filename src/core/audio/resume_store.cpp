@@ -0,0 +1,185 @@
+#include "core/audio/resume_store.h"
+#include "core/audio/shuffle_order.h"
+#include "core/library/library.h"
+#include <SD.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
+#include <freertos/task.h>
+#include <string.h>
+#include "log.h"
+
+#define RESUME_MAGIC 0x50525343u // "CSRP"
+#define RESUME_WRITER_STACK 4096
+
+// 磁盘上的一格，正好 512 字节
+struct ResumeSlot
+{
+    uint32_t magic;
+    uint32_t seq;   // 单调递增，最大的是最新的一格
+    uint32_t check; // 整格（check 字段为 0 时）的 FNV-1a
+    uint32_t pathHash;
+    uint32_t size;
+    uint32_t offset;
+    uint32_t sample;
+    uint32_t positionMs;
+    int32_t index;
+    uint8_t exact;
+    uint8_t reserved;
+    uint16_t pathLen;
+    char path[RESUME_PATH_MAX];
+};
+static_assert(sizeof(ResumeSlot) == 512, "resume slot must be one sector");
+
+static uint32_t g_seq = 0;
+
+// 交给写入任务的最新检查点；锁只护住这一份拷贝，不在持锁时读写 SD
+static SemaphoreHandle_t g_pendingLock = nullptr;
+static ResumePoint g_pending;
+static bool g_hasPending = false;
+static TaskHandle_t g_writer = nullptr;
+
+static uint32_t fnv1a(const void *data, size_t n, uint32_t h)
+{
+    const uint8_t *p = (const uint8_t *)data;
+    while (n--)
+    {
+        h ^= *p++;
+        h *= 16777619u;
+    }
+    return h;
+}
+
+uint32_t resumePathHash(const char *path)
+{
+    return fnv1a(path, strlen(path), 2166136261u);
+}
+
+static uint32_t slotCheck(ResumeSlot s)
+{
+    s.check = 0;
+    return fnv1a(&s, sizeof(s), 2166136261u);
+}
+
+static bool slotValid(const ResumeSlot &s)
+{
+    return s.magic == RESUME_MAGIC && s.pathLen > 0 && s.pathLen < RESUME_PATH_MAX &&
+           s.path[s.pathLen] == '\0' && s.check == slotCheck(s) &&
+           s.pathHash == resumePathHash(s.path);
+}
+
+bool resumeStoreLoad(ResumePoint &out)
+{
+    File f = SD.open(RESUME_STORE_PATH, FILE_READ);
+    if (!f)
+        return false;
+
+    ResumeSlot s;
+    bool found = false;
+    uint32_t best = 0;
+    for (int i = 0; i < RESUME_SLOTS; i++)
+    {
+        if (f.read((uint8_t *)&s, sizeof(s)) != sizeof(s))
+            break;
+        if (!slotValid(s) || (found && (int32_t)(s.seq - best) <= 0))
+            continue;
+        found = true;
+        best = s.seq;
+        out.pathHash = s.pathHash;
+        out.size = s.size;
+        out.at.offset = s.offset;
+        out.at.sample = s.sample;
+        out.at.exact = s.exact != 0;
+        out.positionMs = s.positionMs;
+        out.index = s.index;
+        memcpy(out.path, s.path, s.pathLen + 1);
+    }
+    f.close();
+
+    if (found)
+        g_seq = best;
+    return found;
+}
+
+bool resumeStoreSave(const ResumePoint &pt)
+{
+    size_t len = strlen(pt.path);
+    if (len == 0 || len >= RESUME_PATH_MAX)
+        return false;
+
+    ResumeSlot s;
+    memset(&s, 0, sizeof(s));
+    s.magic = RESUME_MAGIC;
+    s.seq = g_seq + 1;
+    s.pathHash = pt.pathHash;
+    s.size = pt.size;
+    s.offset = pt.at.offset;
+    s.sample = pt.at.sample;
+    s.exact = pt.at.exact ? 1 : 0;
+    s.positionMs = pt.positionMs;
+    s.index = pt.index;
+    s.pathLen = (uint16_t)len;
+    memcpy(s.path, pt.path, len);
+    s.check = slotCheck(s);
+
+    // 原地改写其中一格；文件不存在时先建好整个环
+    File f = SD.open(RESUME_STORE_PATH, "r+");
+    if (!f)
+    {
+        if (!SD.exists(LIBRARY_INDEX_DIR))
+            SD.mkdir(LIBRARY_INDEX_DIR);
+        f = SD.open(RESUME_STORE_PATH, FILE_WRITE);
+        if (!f)
+            return false;
+        ResumeSlot empty;
+        memset(&empty, 0, sizeof(empty));
+        for (int i = 0; i < RESUME_SLOTS; i++)
+            f.write((const uint8_t *)&empty, sizeof(empty));
+    }
+
+    bool ok = f.seek((s.seq % RESUME_SLOTS) * sizeof(s)) &&
+              f.write((const uint8_t *)&s, sizeof(s)) == sizeof(s);
+    f.close();
+    if (ok)
+        g_seq = s.seq;
+    else
+        LOG_AUDIO("resume: checkpoint write failed");
+    return ok;
+}
+
+static void writerTask(void *)
+{
+    ResumePoint pt;
+    while (true)
+    {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+        shuffleFlush();
+
+        xSemaphoreTake(g_pendingLock, portMAX_DELAY);
+        bool has = g_hasPending;
+        if (has)
+            pt = g_pending;
+        g_hasPending = false;
+        xSemaphoreGive(g_pendingLock);
+        if (has)
+            resumeStoreSave(pt);
+    }
+}
+
+void resumeWriterStart()
+{
+    if (g_writer)
+        return;
+    g_pendingLock = xSemaphoreCreateMutex();
+    xTaskCreatePinnedToCore(writerTask, "Resume", RESUME_WRITER_STACK, NULL, 1, &g_writer, 0);
+}
+
+void resumeWriterPost(const ResumePoint &pt)
+{
+    if (!g_writer)
+        return;
+    xSemaphoreTake(g_pendingLock, portMAX_DELAY);
+    g_pending = pt;
+    g_hasPending = true;
+    xSemaphoreGive(g_pendingLock);
+    xTaskNotifyGive(g_writer);
+}
@@ -0,0 +1,37 @@
+#pragma once
+#include <stdint.h>
+#include "core/audio/track_source.h"
+
+// 续播检查点：当前曲目的身份（完整路径 + 路径哈希 + 文件大小）和帧对齐的字节位置。
+// 存在 SD 卡上一个固定大小的环里，每次写下一格（只改写一格的几个扇区，不截断、不改目录项），
+// 写到一半断电只坏掉这一格，开机取序号最大且校验通过的一格。
+// 开机直接按记下的路径打开文件、定位到该位置，不用在曲库里查找
+#define RESUME_STORE_PATH "/.synthcard/resume.bin"
+#define RESUME_SLOTS 8
+// 播放中每隔多久写一次；暂停、停止时另外各写一次，切歌后等几秒再写（不拖慢无缝衔接）
+#define RESUME_CHECKPOINT_MS 30000
+#define RESUME_TRACK_SETTLE_MS 5000
+// 恢复时往回退一点，接上断点前的内容（也抵消输出缓冲里还没播出去的部分）
+#define RESUME_REWIND_MS 2000
+#define RESUME_PATH_MAX 472 // 含 '\0'；每格连同头部正好一个扇区（512 字节），更长的路径不记
+
+struct ResumePoint
+{
+    uint32_t pathHash;
+    uint32_t size;        // 文件大小，和哈希一起确认还是同一个文件
+    TrackSeekPoint at;    // 帧/块边界的字节位置及之前的样本数
+    uint32_t positionMs;  // 界面显示用
+    int32_t index;        // 写入时的列表序号，只作提示，开机时先按它核对路径
+    char path[RESUME_PATH_MAX];
+};
+
+uint32_t resumePathHash(const char *path);
+
+// 开机时在 setup() 里读；写只在后台写入任务里做
+bool resumeStoreLoad(ResumePoint &out);
+bool resumeStoreSave(const ResumePoint &pt);
+
+// 后台写入任务（core 0，低于音频任务的优先级），setup() 里启动一次。
+// 音频任务只填好检查点交给它（没写完又来新的就只留最新的），SD 写入连同随机顺序都由它完成
+void resumeWriterStart();
+void resumeWriterPost(const ResumePoint &pt);
@@ -0,0 +1,359 @@
+#include "core/audio/shuffle_order.h"
+#include "core/library/library.h"
+#include <Arduino.h>
+#include <SD.h>
+#include <esp_heap_caps.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
+#include <string.h>
+#include "log.h"
+
+#define SHUFFLE_MAGIC 0x32485353u // "SSH2"；文件头加了 tail，旧格式直接作废
+
+static_assert(LIBRARY_MAX_TRACKS <= 0xFFFF, "shuffle order stores list positions as uint16_t");
+
+// 文件头之后是 count 个 uint16_t（排列）
+struct ShuffleHeader
+{
+    uint32_t magic;
+    uint32_t count;
+    int32_t cursor;
+    uint32_t check; // 排列部分的 FNV-1a
+    uint32_t tail;  // 排列覆盖的最后一首（列表序号 count-1）路径的 FNV-1a；库重排/压缩过就对不上
+};
+
+static uint16_t *g_perm = nullptr;  // 第 k 个播放的列表序号
+static uint16_t *g_where = nullptr; // 列表序号在排列里的位置（g_perm 的逆）
+static int g_n = 0;
+static int g_cap = 0;
+static int g_cursor = -1; // 当前曲目在排列里的位置；-1 = 新一轮还没开始
+static TrackHandle g_tail = PATH_STORE_INVALID_HANDLE; // 排列覆盖的最后一首，用来判断列表是否只在末尾追加
+static uint32_t g_tailHash = 0; // 同一首的路径哈希，存盘用（句柄不跨重启）
+static bool g_permDirty = false;
+static bool g_cursorDirty = false;
+// 一轮走到头时预先选好的下一轮第一首（列表序号）；不改排列，真正播到它时才在 align() 里重新洗牌
+static int g_nextFirst = -1;
+
+// 交给写入任务的快照：音频任务只拷内存，写入任务持锁写 SD；
+// 写入任务正在写时音频任务不等锁，脏标记留着下次再拷
+static SemaphoreHandle_t g_saveLock = nullptr;
+static ShuffleHeader g_saveHead;
+static uint16_t *g_savePerm = nullptr;
+static int g_saveCap = 0;
+static int g_saveCount = 0; // 快照里有效的排列长度；文件头原地改写失败时要整份重写，所以快照总跟着排列
+static bool g_saveHeadPending = false;
+static bool g_savePermPending = false;
+
+static uint32_t fnv1a(const void *data, size_t n)
+{
+    const uint8_t *p = (const uint8_t *)data;
+    uint32_t h = 2166136261u;
+    while (n--)
+    {
+        h ^= *p++;
+        h *= 16777619u;
+    }
+    return h;
+}
+
+// 列表序号 n-1 的路径哈希；取不到路径时返回 0
+static uint32_t tailHash(int n)
+{
+    char path[LIBRARY_MAX_PATH_LEN];
+    if (n <= 0 || !libraryCopyPath(n - 1, path, sizeof(path)))
+        return 0;
+    return fnv1a(path, strlen(path));
+}
+
+static bool reserve(int n)
+{
+    if (n <= g_cap)
+        return true;
+    int cap = g_cap ? g_cap * 2 : 256;
+    while (cap < n)
+        cap *= 2;
+    if (cap > LIBRARY_MAX_TRACKS)
+        cap = LIBRARY_MAX_TRACKS;
+    size_t bytes = cap * sizeof(uint16_t);
+
+    bool psram = psramFound();
+    uint16_t *perm = (uint16_t *)(psram ? heap_caps_realloc(g_perm, bytes, MALLOC_CAP_SPIRAM) : realloc(g_perm, bytes));
+    if (perm)
+        g_perm = perm;
+    uint16_t *where = (uint16_t *)(psram ? heap_caps_realloc(g_where, bytes, MALLOC_CAP_SPIRAM) : realloc(g_where, bytes));
+    if (where)
+        g_where = where;
+    if (!perm || !where)
+        return false;
+    g_cap = cap;
+    return true;
+}
+
+static void swapAt(int a, int b)
+{
+    uint16_t x = g_perm[a];
+    uint16_t y = g_perm[b];
+    g_perm[a] = y;
+    g_perm[b] = x;
+    g_where[y] = a;
+    g_where[x] = b;
+}
+
+static void shuffleAll()
+{
+    for (int i = g_n - 1; i > 0; i--)
+        swapAt(i, random(0, i + 1));
+    g_permDirty = true;
+}
+
+// 全部重新洗牌；current 有效时排在第一并作为当前曲目
+static bool rebuild(int total, int current)
+{
+    if (!reserve(total))
+    {
+        LOG_AUDIO("shuffle: no memory for %d tracks", total);
+        g_n = 0;
+        return false;
+    }
+    g_n = total;
+    for (int i = 0; i < g_n; i++)
+        g_perm[i] = g_where[i] = i;
+    shuffleAll();
+    g_cursor = -1;
+    if (current >= 0 && current < g_n)
+    {
+        swapAt(g_where[current], 0);
+        g_cursor = 0;
+    }
+    g_cursorDirty = true;
+    LOG_AUDIO("shuffle: new order over %d tracks", g_n);
+    return true;
+}
+
+// 列表末尾新增的曲目：每首随机换到还没播的部分（[游标+1, i]），已经播过的顺序不变
+static bool extend(int total)
+{
+    if (!reserve(total))
+        return false;
+    for (int i = g_n; i < total; i++)
+    {
+        g_perm[i] = g_where[i] = i;
+        swapAt(i, random(g_cursor + 1, i + 1));
+    }
+    LOG_AUDIO("shuffle: +%d tracks", total - g_n);
+    g_n = total;
+    g_permDirty = true;
+    return true;
+}
+
+// 列表变了才做事：只在末尾追加时扩展，否则重新洗牌
+static bool sync(int current)
+{
+    int total = libraryGetCount();
+    if (total <= 0)
+        return false;
+    bool appendOnly = g_n > 0 && total >= g_n && libraryGetHandle(g_n - 1) == g_tail;
+    if (!(appendOnly && total == g_n))
+    {
+        g_nextFirst = -1;
+        if (!(appendOnly ? extend(total) : rebuild(total, current)))
+            return false;
+        g_tail = libraryGetHandle(g_n - 1);
+        g_tailHash = tailHash(g_n);
+    }
+    return true;
+}
+
+// 游标跟上实际在播的曲目：上一首/下一首按位置移动；点播了本轮还没播的曲目时把它换到游标后面；
+// 点播本轮早先播过的曲目时游标不动；本轮已走到头、开始播预选的下一轮第一首时才重新洗牌
+static void align(int current)
+{
+    if (current < 0 || current >= g_n)
+        return;
+    int p = g_where[current];
+    if (p == g_cursor)
+        return;
+    if (g_cursor == g_n - 1 && current == g_nextFirst)
+    {
+        shuffleAll();
+        swapAt(g_where[current], 0);
+        g_cursor = 0;
+        g_nextFirst = -1;
+    }
+    else if (p == g_cursor + 1 || p == g_cursor - 1)
+    {
+        g_cursor = p;
+    }
+    else if (p > g_cursor + 1)
+    {
+        swapAt(p, g_cursor + 1);
+        g_cursor++;
+        g_permDirty = true;
+    }
+    else
+    {
+        return;
+    }
+    g_cursorDirty = true;
+}
+
+int shuffleNext(int current)
+{
+    if (!sync(current))
+        return 0;
+    align(current);
+    if (g_cursor + 1 < g_n)
+        return g_perm[g_cursor + 1];
+
+    // 一轮放完：只选出下一轮第一首，同一位置上多次调用（无缝预开、播完、按下一首）结果一致。
+    // 不选当前曲目；也不选上一首，否则按上一首回到它会被 align() 当成新一轮开始
+    int prev = g_cursor > 0 ? g_perm[g_cursor - 1] : -1;
+    if (g_nextFirst < 0 || g_nextFirst >= g_n || (g_n > 1 && g_nextFirst == current) ||
+        (g_n > 2 && g_nextFirst == prev))
+    {
+        do
+            g_nextFirst = random(0, g_n);
+        while ((g_n > 1 && g_nextFirst == current) || (g_n > 2 && g_nextFirst == prev));
+    }
+    return g_nextFirst;
+}
+
+int shufflePrev(int current)
+{
+    if (!sync(current))
+        return 0;
+    align(current);
+    return g_cursor > 0 ? g_perm[g_cursor - 1] : current;
+}
+
+bool shuffleLoad()
+{
+    File f = SD.open(SHUFFLE_STORE_PATH, FILE_READ);
+    if (!f)
+        return false;
+
+    ShuffleHeader h;
+    bool ok = f.read((uint8_t *)&h, sizeof(h)) == sizeof(h) && h.magic == SHUFFLE_MAGIC && h.count > 0 &&
+              (int)h.count <= libraryGetCount() && h.cursor >= -1 && h.cursor < (int32_t)h.count &&
+              reserve(h.count);
+    if (ok)
+    {
+        size_t bytes = h.count * sizeof(uint16_t);
+        ok = f.read((uint8_t *)g_perm, bytes) == bytes && fnv1a(g_perm, bytes) == h.check;
+    }
+    // 只看数量会把“重排/压缩后又追加”的库当成只在末尾追加；末尾那首的路径也得对上
+    if (ok)
+        ok = h.tail != 0 && tailHash(h.count) == h.tail;
+    f.close();
+
+    // 校验通过后再确认是一个排列
+    if (ok)
+    {
+        memset(g_where, 0xFF, h.count * sizeof(uint16_t));
+        for (uint32_t i = 0; ok && i < h.count; i++)
+        {
+            uint16_t v = g_perm[i];
+            ok = v < h.count && g_where[v] == 0xFFFF;
+            if (ok)
+                g_where[v] = i;
+        }
+    }
+    if (!ok)
+    {
+        g_n = 0;
+        LOG_AUDIO("shuffle: saved order does not match the library, reshuffling on demand");
+        return false;
+    }
+
+    g_n = h.count;
+    g_cursor = h.cursor;
+    g_nextFirst = -1;
+    g_tail = libraryGetHandle(g_n - 1);
+    g_tailHash = h.tail;
+    LOG_AUDIO("shuffle: restored order over %d tracks at %d", g_n, g_cursor);
+    return true;
+}
+
+void shuffleCapture()
+{
+    if (g_n <= 0 || !(g_permDirty || g_cursorDirty))
+        return;
+    if (!g_saveLock)
+        g_saveLock = xSemaphoreCreateMutex();
+    if (!g_saveLock || xSemaphoreTake(g_saveLock, 0) != pdTRUE)
+        return;
+
+    size_t bytes = g_n * sizeof(uint16_t);
+    bool ok = true;
+    if (g_permDirty || g_saveCount != g_n)
+    {
+        if (g_saveCap < g_n)
+        {
+            bool psram = psramFound();
+            size_t capBytes = g_cap * sizeof(uint16_t);
+            uint16_t *perm = (uint16_t *)(psram ? heap_caps_realloc(g_savePerm, capBytes, MALLOC_CAP_SPIRAM)
+                                                : realloc(g_savePerm, capBytes));
+            if (perm)
+            {
+                g_savePerm = perm;
+                g_saveCap = g_cap;
+            }
+        }
+        ok = g_saveCap >= g_n;
+        if (ok)
+        {
+            memcpy(g_savePerm, g_perm, bytes);
+            g_saveCount = g_n;
+            g_savePermPending = g_savePermPending || g_permDirty;
+        }
+    }
+    if (ok)
+    {
+        g_saveHead.magic = SHUFFLE_MAGIC;
+        g_saveHead.count = g_n;
+        g_saveHead.cursor = g_cursor;
+        g_saveHead.check = fnv1a(g_perm, bytes);
+        g_saveHead.tail = g_tailHash;
+        g_saveHeadPending = true;
+        g_permDirty = g_cursorDirty = false;
+    }
+    xSemaphoreGive(g_saveLock);
+}
+
+void shuffleFlush()
+{
+    if (!g_saveLock)
+        return;
+    xSemaphoreTake(g_saveLock, portMAX_DELAY);
+    if (!g_saveHeadPending)
+    {
+        xSemaphoreGive(g_saveLock);
+        return;
+    }
+
+    // 只有游标变了时原地改写文件头
+    File f = g_savePermPending ? File() : SD.open(SHUFFLE_STORE_PATH, "r+");
+    bool ok;
+    if (f)
+    {
+        ok = f.write((const uint8_t *)&g_saveHead, sizeof(g_saveHead)) == sizeof(g_saveHead);
+    }
+    else
+    {
+        if (!SD.exists(LIBRARY_INDEX_DIR))
+            SD.mkdir(LIBRARY_INDEX_DIR);
+        size_t bytes = g_saveHead.count * sizeof(uint16_t);
+        f = SD.open(SHUFFLE_STORE_PATH, FILE_WRITE);
+        ok = f && f.write((const uint8_t *)&g_saveHead, sizeof(g_saveHead)) == sizeof(g_saveHead) &&
+             f.write((const uint8_t *)g_savePerm, bytes) == bytes;
+    }
+    if (f)
+        f.close();
+
+    // 失败时快照留着，下次检查点再写
+    if (ok)
+        g_saveHeadPending = g_savePermPending = false;
+    else
+        LOG_AUDIO("shuffle: write failed");
+    xSemaphoreGive(g_saveLock);
+}
@@ -0,0 +1,24 @@
+#pragma once
+#include <stdint.h>
+
+// 随机播放顺序：对列表序号做一次 Fisher-Yates 洗牌，游标沿着排列走，一轮放完之前不重复，
+// 上一首就是排列里游标前面那首（真正播过的那首），下一首/上一首都是 O(1)。
+// 曲库只在末尾追加新曲目、删除时保持其余曲目的相对顺序，所以：
+//   - 列表变长且原来的最后一首没挪位置：新序号随机插进还没播的部分，不打乱已经走过的顺序
+//   - 其它变化（有曲目被删）：用到时重新洗牌，当前曲目排在第一
+// 排列（每首 2 字节）和游标存在 SD 卡上，只在排列变了时整份重写，平时只改写文件头里的游标
+#define SHUFFLE_STORE_PATH "/.synthcard/shuffle.bin"
+
+// setup() 里曲库加载之后调用一次；之后除 shuffleFlush() 外都只在音频任务里调用
+bool shuffleLoad();
+
+// 当前曲目之后的一首，不移动游标也不改排列（无缝衔接会提前调用）；一轮放完时只选出新一轮的第一首
+// （不会是当前曲目），等它真正开始播放、下一次调用对齐游标时才重新洗牌
+int shuffleNext(int current);
+// 当前曲目之前播过的一首，已在本轮开头时返回 current
+int shufflePrev(int current);
+
+// 游标或排列变了才拷一份快照，只拷内存不碰 SD；由音频任务在填检查点时顺带调用
+void shuffleCapture();
+// 把快照写到 SD 卡；只在后台写入任务里调用（见 resumeWriterStart()）
+void shuffleFlush();
@@ -0,0 +1,363 @@
+#include "core/audio/spectrum.h"
+#include <atomic>
+#include <math.h>
+#include <string.h>
+#include <freertos/FreeRTOS.h>
+#include "log.h"
+
+#if __has_include(<dsps_fft2r.h>)
+#include <dsps_fft2r.h>
+#define SPECTRUM_USE_DSP 1
+#else
+#define SPECTRUM_USE_DSP 0
+#endif
+
+// 采样窗口：单生产者（音频任务）写、UI 读；读者拷贝前后各看一次写位置，被覆盖就放弃本帧
+#define SPECTRUM_RING 1024
+#define SPECTRUM_RING_MASK (SPECTRUM_RING - 1)
+
+#define SPECTRUM_FMIN 60.0f
+#define SPECTRUM_FMAX 16000.0f
+// 电平映射：功率的 log2（1/16 精度）从 FLOOR 到 FLOOR+RANGE 线性映射到 0~255
+#define SPECTRUM_LOG_FLOOR (6 * 16)
+#define SPECTRUM_LOG_RANGE (20 * 16)
+
+#define SPECTRUM_RELEASE 12     // 每帧下落
+#define SPECTRUM_PEAK_HOLD 12   // 峰值停留帧数
+#define SPECTRUM_PEAK_DECAY 6   // 停留结束后每帧下落
+#define SPECTRUM_LOG_INTERVAL 10000
+
+static_assert((SPECTRUM_RING & SPECTRUM_RING_MASK) == 0, "SPECTRUM_RING must be a power of two");
+static_assert(SPECTRUM_RING >= SPECTRUM_FFT_SIZE * 2, "ring must hold two FFT windows");
+
+static int16_t g_ring[SPECTRUM_RING];
+static std::atomic<uint32_t> g_writePos(0);
+static std::atomic<uint32_t> g_rate(44100);
+
+alignas(16) static int16_t g_fft[SPECTRUM_FFT_SIZE * 2]; // 复数交错 re, im
+static int16_t g_hann[SPECTRUM_FFT_SIZE / 2];             // 对称，只存一半
+#if !SPECTRUM_USE_DSP
+static int16_t g_twiddle[SPECTRUM_FFT_SIZE]; // k < N/2：cos, -sin（Q15）
+#endif
+
+static uint16_t g_bandEdge[SPECTRUM_BANDS + 1]; // 每个频段的起始 bin
+static uint32_t g_bandRate = 0;
+
+static uint8_t g_levels[SPECTRUM_BANDS];
+static uint8_t g_peaks[SPECTRUM_BANDS];
+static uint8_t g_peakHold[SPECTRUM_BANDS];
+
+static bool g_inited = false;
+static uint32_t g_lastWrite = 0;
+static uint32_t g_skip = 0;
+static uint32_t g_lastLog = 0;
+static SpectrumStats g_stats = {};
+
+// ==========================
+// PCM 抽头
+// ==========================
+SpectrumTap::SpectrumTap(AudioOutput *sink) : sink(sink)
+{
+}
+
+bool SpectrumTap::SetRate(int hz)
+{
+    hertz = hz;
+    g_rate.store(hz, std::memory_order_relaxed);
+    return sink->SetRate(hz);
+}
+
+bool SpectrumTap::SetBitsPerSample(int bits)
+{
+    bps = bits;
+    return sink->SetBitsPerSample(bits);
+}
+
+bool SpectrumTap::SetChannels(int chan)
+{
+    channels = chan;
+    return sink->SetChannels(chan);
+}
+
+bool SpectrumTap::SetGain(float f)
+{
+    return sink->SetGain(f);
+}
+
+bool SpectrumTap::begin()
+{
+    return sink->begin();
+}
+
+bool SpectrumTap::ConsumeSample(int16_t sample[2])
+{
+    // 下游可能原地改写样本（增益），先取单声道
+    int16_t mono = (int16_t)(((int32_t)sample[0] + sample[1]) >> 1);
+    if (!sink->ConsumeSample(sample))
+        return false;
+
+    uint32_t w = g_writePos.load(std::memory_order_relaxed);
+    g_ring[w & SPECTRUM_RING_MASK] = mono;
+    g_writePos.store(w + 1, std::memory_order_release);
+    return true;
+}
+
+bool SpectrumTap::stop()
+{
+    return sink->stop();
+}
+
+void SpectrumTap::flush()
+{
+    sink->flush();
+}
+
+bool SpectrumTap::loop()
+{
+    return sink->loop();
+}
+
+// ==========================
+// 定点 FFT
+// ==========================
+#if !SPECTRUM_USE_DSP
+static void fftQ15(int16_t *x, int n)
+{
+    // 位反转重排
+    for (int i = 1, j = 0; i < n; i++)
+    {
+        int bit = n >> 1;
+        for (; j & bit; bit >>= 1)
+            j ^= bit;
+        j ^= bit;
+        if (i < j)
+        {
+            int16_t t = x[2 * i];
+            x[2 * i] = x[2 * j];
+            x[2 * j] = t;
+            t = x[2 * i + 1];
+            x[2 * i + 1] = x[2 * j + 1];
+            x[2 * j + 1] = t;
+        }
+    }
+
+    // 基 2 蝶形，每级右移 1 位防溢出（总缩放 1/N）
+    for (int len = 2; len <= n; len <<= 1)
+    {
+        int half = len >> 1;
+        int step = n / len;
+        for (int i = 0; i < n; i += len)
+        {
+            for (int j = 0; j < half; j++)
+            {
+                int32_t wr = g_twiddle[2 * j * step];
+                int32_t wi = g_twiddle[2 * j * step + 1];
+                int16_t *a = x + 2 * (i + j);
+                int16_t *b = x + 2 * (i + j + half);
+                int32_t tr = (b[0] * wr - b[1] * wi) >> 15;
+                int32_t ti = (b[0] * wi + b[1] * wr) >> 15;
+                int32_t ar = a[0];
+                int32_t ai = a[1];
+                a[0] = (int16_t)((ar + tr) >> 1);
+                a[1] = (int16_t)((ai + ti) >> 1);
+                b[0] = (int16_t)((ar - tr) >> 1);
+                b[1] = (int16_t)((ai - ti) >> 1);
+            }
+        }
+    }
+}
+#endif
+
+// 功率的 log2，1/16 精度
+static inline int32_t log2q4(uint32_t v)
+{
+    if (v == 0)
+        return 0;
+    int msb = 31 - __builtin_clz(v);
+    uint32_t frac = msb >= 4 ? (v >> (msb - 4)) & 0x0F : (v << (4 - msb)) & 0x0F;
+    return msb * 16 + (int32_t)frac;
+}
+
+static void computeBands(uint32_t rate)
+{
+    float fmax = SPECTRUM_FMAX < rate * 0.5f ? SPECTRUM_FMAX : rate * 0.5f;
+    float binHz = (float)rate / SPECTRUM_FFT_SIZE;
+    int prev = 0;
+    for (int k = 0; k <= SPECTRUM_BANDS; k++)
+    {
+        float f = SPECTRUM_FMIN * powf(fmax / SPECTRUM_FMIN, (float)k / SPECTRUM_BANDS);
+        int bin = (int)(f / binHz + 0.5f);
+        // 低频段 bin 很稀，至少占一个
+        if (k > 0 && bin <= prev)
+            bin = prev + 1;
+        if (bin > SPECTRUM_FFT_SIZE / 2)
+            bin = SPECTRUM_FFT_SIZE / 2;
+        g_bandEdge[k] = (uint16_t)bin;
+        prev = bin;
+    }
+    g_bandRate = rate;
+}
+
+void spectrumInit()
+{
+    if (g_inited)
+        return;
+
+    const float pi = 3.14159265f;
+    for (int i = 0; i < SPECTRUM_FFT_SIZE / 2; i++)
+        g_hann[i] = (int16_t)(32767.0f * 0.5f * (1.0f - cosf(2.0f * pi * i / (SPECTRUM_FFT_SIZE - 1))));
+
+#if SPECTRUM_USE_DSP
+    g_stats.simd = dsps_fft2r_init_sc16(NULL, SPECTRUM_FFT_SIZE) == ESP_OK;
+#else
+    for (int k = 0; k < SPECTRUM_FFT_SIZE / 2; k++)
+    {
+        g_twiddle[2 * k] = (int16_t)(32767.0f * cosf(2.0f * pi * k / SPECTRUM_FFT_SIZE));
+        g_twiddle[2 * k + 1] = (int16_t)(-32767.0f * sinf(2.0f * pi * k / SPECTRUM_FFT_SIZE));
+    }
+    g_stats.simd = false;
+#endif
+
+    computeBands(g_rate.load(std::memory_order_relaxed));
+    g_inited = true;
+}
+
+// 拷贝最近 N 个样本并加窗；拷贝期间被生产者追上则返回 false
+static bool captureWindow(uint32_t w)
+{
+    uint32_t start = w - SPECTRUM_FFT_SIZE;
+    for (int i = 0; i < SPECTRUM_FFT_SIZE; i++)
+    {
+        int h = i < SPECTRUM_FFT_SIZE / 2 ? i : SPECTRUM_FFT_SIZE - 1 - i;
+        g_fft[2 * i] = (int16_t)((g_ring[(start + i) & SPECTRUM_RING_MASK] * (int32_t)g_hann[h]) >> 15);
+        g_fft[2 * i + 1] = 0;
+    }
+    uint32_t after = g_writePos.load(std::memory_order_acquire);
+    return after - start <= SPECTRUM_RING;
+}
+
+static void analyze()
+{
+#if SPECTRUM_USE_DSP
+    dsps_fft2r_sc16(g_fft, SPECTRUM_FFT_SIZE);
+    dsps_bit_rev_sc16_ansi(g_fft, SPECTRUM_FFT_SIZE);
+#else
+    fftQ15(g_fft, SPECTRUM_FFT_SIZE);
+#endif
+
+    for (int b = 0; b < SPECTRUM_BANDS; b++)
+    {
+        uint32_t best = 0;
+        int end = g_bandEdge[b + 1] > g_bandEdge[b] ? g_bandEdge[b + 1] : g_bandEdge[b] + 1;
+        for (int k = g_bandEdge[b]; k < end && k < SPECTRUM_FFT_SIZE / 2; k++)
+        {
+            int32_t re = g_fft[2 * k];
+            int32_t im = g_fft[2 * k + 1];
+            uint32_t p = (uint32_t)(re * re) + (uint32_t)(im * im);
+            if (p > best)
+                best = p;
+        }
+
+        // 高频能量天然偏低，按频段加一点倾斜（约 +9dB 到最高段）
+        int32_t l = log2q4(best) + b * 48 / SPECTRUM_BANDS - SPECTRUM_LOG_FLOOR;
+        int32_t level = l <= 0 ? 0 : l * SPECTRUM_LEVEL_MAX / SPECTRUM_LOG_RANGE;
+        if (level > SPECTRUM_LEVEL_MAX)
+            level = SPECTRUM_LEVEL_MAX;
+
+        int32_t fallen = (int32_t)g_levels[b] - SPECTRUM_RELEASE;
+        g_levels[b] = (uint8_t)(level > fallen ? level : (fallen > 0 ? fallen : 0));
+    }
+}
+
+// 没有新样本（暂停/停止）时让柱子自然落下
+static void decay()
+{
+    for (int b = 0; b < SPECTRUM_BANDS; b++)
+        g_levels[b] = g_levels[b] > SPECTRUM_RELEASE ? g_levels[b] - SPECTRUM_RELEASE : 0;
+}
+
+static void updatePeaks()
+{
+    for (int b = 0; b < SPECTRUM_BANDS; b++)
+    {
+        if (g_levels[b] >= g_peaks[b])
+        {
+            g_peaks[b] = g_levels[b];
+            g_peakHold[b] = SPECTRUM_PEAK_HOLD;
+        }
+        else if (g_peakHold[b] > 0)
+        {
+            g_peakHold[b]--;
+        }
+        else
+        {
+            g_peaks[b] = g_peaks[b] > SPECTRUM_PEAK_DECAY ? g_peaks[b] - SPECTRUM_PEAK_DECAY : 0;
+        }
+    }
+}
+
+void spectrumUpdate()
+{
+    if (!g_inited)
+        spectrumInit();
+
+    if (g_skip > 0)
+    {
+        g_skip--;
+        g_stats.skipped++;
+        return;
+    }
+
+    uint32_t t0 = micros();
+
+    uint32_t rate = g_rate.load(std::memory_order_relaxed);
+    if (rate != g_bandRate && rate > 0)
+        computeBands(rate);
+
+    uint32_t w = g_writePos.load(std::memory_order_acquire);
+    if (w != g_lastWrite && w >= SPECTRUM_FFT_SIZE)
+    {
+        g_lastWrite = w;
+        if (captureWindow(w))
+            analyze();
+    }
+    else
+    {
+        decay();
+    }
+    updatePeaks();
+
+    uint32_t us = micros() - t0;
+    g_stats.lastUs = us;
+    g_stats.avgUs = g_stats.frames ? (g_stats.avgUs * 7 + us) / 8 : us;
+    if (us > g_stats.maxUs)
+        g_stats.maxUs = us;
+    g_stats.frames++;
+
+    // 这一帧超出平均预算：跳过后面若干帧，使平均开销回到预算以内
+    if (us > SPECTRUM_AVG_BUDGET_US)
+        g_skip = us / SPECTRUM_AVG_BUDGET_US;
+
+    if (millis() - g_lastLog > SPECTRUM_LOG_INTERVAL)
+    {
+        g_lastLog = millis();
+        LOG_UI("spectrum: avg %lu us/frame, max %lu us, skipped %lu, %s, core %d",
+               (unsigned long)g_stats.avgUs, (unsigned long)g_stats.maxUs,
+               (unsigned long)g_stats.skipped, g_stats.simd ? "esp-dsp" : "c", (int)xPortGetCoreID());
+    }
+}
+
+const uint8_t *spectrumGetLevels()
+{
+    return g_levels;
+}
+
+const uint8_t *spectrumGetPeaks()
+{
+    return g_peaks;
+}
+
+SpectrumStats spectrumGetStats()
+{
+    return g_stats;
+}
@@ -0,0 +1,52 @@
+#pragma once
+#include <stdint.h>
+#include <AudioOutput.h>
+
+// 频谱分析：
+//   - SpectrumTap 插在 AudioOutputBuffer 和 I2S 之间，样本真正送出时写入无锁采样窗口
+//     （音频任务只做一次写数组 + 一次原子写，不会阻塞解码）
+//   - spectrumUpdate() 在 UI 所在的核心 1（解码在核心 0）每帧调用：取最近 SPECTRUM_FFT_SIZE 个样本，
+//     加窗后做 Q15 定点 FFT（有 esp-dsp 时用它的 S3 SIMD 实现），按对数频段汇总并做峰值保持
+#define SPECTRUM_FFT_SIZE 512
+#define SPECTRUM_BANDS 24    // 140px 频谱区，每条 6px
+#define SPECTRUM_LEVEL_MAX 255
+// 平均 CPU 预算：一帧一旦开始就做完（不限制单帧耗时），超出时按超出的倍数跳过后面几帧，
+// 把平均开销拉回预算以内
+#define SPECTRUM_AVG_BUDGET_US 2000
+
+class SpectrumTap : public AudioOutput
+{
+public:
+    explicit SpectrumTap(AudioOutput *sink);
+
+    virtual bool SetRate(int hz) override;
+    virtual bool SetBitsPerSample(int bits) override;
+    virtual bool SetChannels(int chan) override;
+    virtual bool SetGain(float f) override;
+    virtual bool begin() override;
+    virtual bool ConsumeSample(int16_t sample[2]) override;
+    virtual bool stop() override;
+    virtual void flush() override;
+    virtual bool loop() override;
+
+private:
+    AudioOutput *sink;
+};
+
+struct SpectrumStats
+{
+    uint32_t lastUs; // 最近一次分析耗时
+    uint32_t avgUs;  // 滑动平均
+    uint32_t maxUs;
+    uint32_t frames;  // 实际分析的帧数
+    uint32_t skipped; // 因预算跳过的帧数
+    bool simd;        // 是否使用 esp-dsp
+};
+
+void spectrumInit();
+// 每个 UI 帧调用一次；超预算时内部跳帧，直接沿用上次结果
+void spectrumUpdate();
+// 长度均为 SPECTRUM_BANDS，取值 0 ~ SPECTRUM_LEVEL_MAX
+const uint8_t *spectrumGetLevels();
+const uint8_t *spectrumGetPeaks();
+SpectrumStats spectrumGetStats();
@@ -0,0 +1,132 @@
+#include "core/audio/track_open.h"
+#include "core/audio/mp3_seek.h"
+#include "core/audio/wav_source.h"
+#include "core/audio/wav_generator.h"
+#include "core/audio/flac_source.h"
+#include "core/audio/readahead_source.h"
+#include "log.h"
+#include <AudioGeneratorMP3.h>
+#include <AudioGeneratorFLAC.h>
+#include <AudioFileSourceSD.h>
+#include <string.h>
+
+static ReadAheadSource *openReadAhead(const char *path, uint32_t startPos)
+{
+    ReadAheadSource *f = new ReadAheadSource(path, 0, startPos);
+    if (f->isOpen())
+        return f;
+    delete f;
+    return nullptr;
+}
+
+TrackSource *trackOpen(const char *path, AudioFormat hint, const TrackLayout *layout)
+{
+    // 先在不带预读的文件上解析头部：每次只读几字节到 2KB，封面等大块标签按声明的大小直接跳过。
+    // 预读缓冲最后才打开、从第一个音频帧开始填，不会先把标签读进来再丢掉
+    AudioFileSourceSD head(path);
+    if (!head.isOpen())
+        return nullptr;
+
+    AudioFormat fmt = hint;
+    if (!layout || hint == AudioFormat::UNKNOWN)
+    {
+        layout = nullptr;
+        uint8_t magic[12];
+        fmt = audioFormatSniff(magic, mp3ReadAt(&head, 0, magic, sizeof(magic)));
+        if (fmt == AudioFormat::UNKNOWN)
+            fmt = hint != AudioFormat::UNKNOWN ? hint : audioFormatFromName(path);
+        else if (hint != AudioFormat::UNKNOWN && fmt != hint)
+            LOG_AUDIO("%s: content is %s, not %s", path, audioFormatName(fmt), audioFormatName(hint));
+    }
+
+    switch (fmt)
+    {
+    case AudioFormat::WAV:
+    {
+        WavStreamInfo info;
+        if (!wavReadStreamInfo(&head, info))
+            break;
+        head.close();
+        ReadAheadSource *f = openReadAhead(path, info.dataStart);
+        return f ? new WavSource(f, info) : nullptr;
+    }
+    case AudioFormat::FLAC:
+    {
+        FlacStreamInfo info;
+        if (!flacReadStreamInfo(&head, info, layout))
+            break;
+        head.close();
+        ReadAheadSource *f = openReadAhead(path, info.audioStart);
+        return f ? new FlacSource(f, info) : nullptr;
+    }
+    default:
+    {
+        // MP3 解析失败也照常交给解码器，由它自己找帧同步
+        Mp3StreamInfo info;
+        if (!mp3ReadStreamInfo(&head, info, layout))
+            memset(&info, 0, sizeof(info));
+        head.close();
+        ReadAheadSource *f = openReadAhead(path, info.audioStart);
+        return f ? new Mp3SeekSource(f, info, path) : nullptr;
+    }
+    }
+
+    LOG_AUDIO("%s: unsupported %s stream", path, audioFormatName(fmt));
+    return nullptr;
+}
+
+AudioGenerator *trackNewDecoder(TrackSource *src)
+{
+    switch (src->format())
+    {
+    case AudioFormat::WAV:
+        // 只有 WavSource 会标成 WAV
+        return new WavGenerator(static_cast<WavSource *>(src)->getInfo());
+    case AudioFormat::FLAC:
+        return new AudioGeneratorFLAC();
+    default:
+        return new AudioGeneratorMP3();
+    }
+}
+
+uint32_t trackProbeDurationMs(AudioFileSource *src, AudioFormat fmt, TrackLayout *layout)
+{
+    if (layout)
+    {
+        layout->start = 0;
+        layout->end = src->getSize();
+    }
+
+    switch (fmt)
+    {
+    case AudioFormat::WAV:
+    {
+        WavStreamInfo info;
+        if (!wavReadStreamInfo(src, info))
+            return 0;
+        uint32_t frames = (info.dataEnd - info.dataStart) / info.blockAlign;
+        return (uint32_t)((uint64_t)frames * 1000 / info.sampleRate);
+    }
+    case AudioFormat::FLAC:
+    {
+        FlacStreamInfo info;
+        if (!flacReadStreamInfo(src, info))
+            return 0;
+        if (layout)
+            layout->start = info.tagEnd;
+        return (uint32_t)((uint64_t)info.totalSamples * 1000 / info.sampleRate);
+    }
+    default:
+    {
+        Mp3StreamInfo info;
+        if (!mp3ReadStreamInfo(src, info))
+            return 0;
+        if (layout)
+        {
+            layout->start = info.tagEnd;
+            layout->end = info.audioEnd;
+        }
+        return mp3DurationMs(info, 0);
+    }
+    }
+}
@@ -0,0 +1,17 @@
+#pragma once
+#include <AudioGenerator.h>
+#include "core/audio/track_source.h"
+
+// 打开曲目：先按文件头确认格式（hint 是扫描时按扩展名记下的，文件头认不出时才用它），
+// 再解析该格式的流信息，返回读位置已在第一个音频帧的 TrackSource（底层为 ReadAheadSource，预读从第一个音频帧开始）。
+// layout 为曲库记下的流范围：给出时信任 hint、不再读文件头识别格式，解析也从标签之后开始。
+// 文件打不开或格式不受支持时返回 nullptr
+TrackSource *trackOpen(const char *path, AudioFormat hint, const TrackLayout *layout = nullptr);
+
+// 按曲目格式新建解码器：MP3 -> AudioGeneratorMP3，WAV -> WavGenerator（不解码），FLAC -> AudioGeneratorFLAC。
+// 调用方负责 delete
+AudioGenerator *trackNewDecoder(TrackSource *src);
+
+// 不建曲目对象、不动 seek 索引缓存，只按流信息算时长（扫描曲库时用，可在任意任务里调用）；未知返回 0。
+// layout 不为空时同时输出流范围，留给之后的 trackOpen() 用
+uint32_t trackProbeDurationMs(AudioFileSource *src, AudioFormat fmt, TrackLayout *layout = nullptr);
@@ -0,0 +1,18 @@
+#include "core/audio/track_source.h"
+
+TrackSource::TrackSource(AudioFileSource *inner, AudioFormat format)
+    : inner(inner), fmt(format), hold_(false)
+{
+}
+
+TrackSource::~TrackSource()
+{
+    delete inner;
+}
+
+bool TrackSource::close()
+{
+    if (hold_)
+        return true;
+    return inner->close();
+}
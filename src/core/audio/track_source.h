@@ -0,0 +1,62 @@
+#pragma once
+#include <stdint.h>
+#include <AudioFileSource.h>
+#include "core/audio/audio_format.h"
+
+// 一次按时间 seek 的落点
+struct TrackSeekPoint
+{
+    uint32_t offset; // 解码器从这里接着读（帧/块边界）
+    uint32_t sample; // 落点之前的解码样本数（exact 为 false 时是估算值）
+    bool exact;
+};
+
+// 播放引擎看到的曲目输入，各格式（MP3/WAV/FLAC）各实现一个：
+//   - 打开时解析好的流参数：采样率、开头要裁掉的样本、有效样本总数
+//   - 时长和按时间定位；seekTo() 之后重启解码器即从落点开始
+//   - 重启解码器时可暂时挡住 close()，文件和预读缓冲保持打开
+// 默认把读写直接转给 inner，析构时释放 inner
+class TrackSource : public AudioFileSource
+{
+public:
+    TrackSource(AudioFileSource *inner, AudioFormat format);
+    virtual ~TrackSource() override;
+
+    virtual uint32_t read(void *data, uint32_t len) override { return inner->read(data, len); }
+    virtual uint32_t readNonBlock(void *data, uint32_t len) override { return inner->readNonBlock(data, len); }
+    virtual bool seek(int32_t pos, int dir) override { return inner->seek(pos, dir); }
+    virtual bool close() override;
+    virtual bool isOpen() override { return inner->isOpen(); }
+    virtual uint32_t getSize() override { return inner->getSize(); }
+    virtual uint32_t getPos() override { return inner->getPos(); }
+
+    AudioFileSource *getInner() { return inner; }
+    AudioFormat format() const { return fmt; }
+
+    // 未知时为 0
+    virtual uint32_t sampleRate() const = 0;
+    // 解码后需要丢弃的开头样本数 / 有效样本总数（0 表示不裁结尾）
+    virtual uint32_t leadingTrim() const { return 0; }
+    virtual uint32_t validSamples() const { return 0; }
+
+    virtual uint32_t durationMs() = 0;
+    // 计算目标时间对应的落点，不移动读位置；不支持 seek 时返回 false
+    virtual bool locate(uint32_t ms, TrackSeekPoint &pt) = 0;
+    // 只用内存里已有的信息计算落点（不读文件，播放中可以随时调用），给不出时返回 false。
+    // 落点可能早于 ms（MP3 取不晚于 ms 的索引条目），要精确时再用 refineTo()
+    virtual bool locateQuick(uint32_t ms, TrackSeekPoint &pt) { return false; }
+    // 从 pt（exact 的落点，不晚于 ms）往后走到 ms 所在的帧/块，会读文件；默认 pt 已经准确
+    virtual bool refineTo(uint32_t ms, TrackSeekPoint &pt) { return true; }
+    // 移动到 locate() 给出的位置
+    virtual bool seekTo(const TrackSeekPoint &pt) = 0;
+
+    // 为 true 时 close() 不下传（解码器 stop() 会关闭输入）
+    void holdOpen(bool hold) { hold_ = hold; }
+
+protected:
+    AudioFileSource *inner;
+
+private:
+    AudioFormat fmt;
+    bool hold_;
+};
@@ -0,0 +1,235 @@
+#include "core/audio/volume_stage.h"
+#include <string.h>
+
+#if __has_include(<dsps_mulc.h>)
+#include <dsps_mulc.h>
+#define VOLUME_USE_DSP 1
+#else
+#define VOLUME_USE_DSP 0
+#endif
+
+// 回绕安全的帧序号比较：a 已到达 b
+static inline bool reached(uint32_t a, uint32_t b)
+{
+    return (int32_t)(a - b) >= 0;
+}
+
+// 帧序号 at 落在从 from 开始的 n 帧之内（或已经过去）
+static inline bool within(uint32_t at, uint32_t from, uint32_t n)
+{
+    return (int32_t)(at - from) < (int32_t)n;
+}
+
+VolumeStage::VolumeStage(AudioOutput *sink)
+    : sink(sink), inCount(0), outPos(0), outLen(0), frame(0), gain(0), step(0), rampLeft(0), rampTo(0),
+      volume(0), muted(false), declick(Declick::NONE), fadeAt(0), resumeAt(0)
+{
+    hertz = 44100;
+    bps = 16;
+    channels = 2;
+}
+
+// 三次曲线：v^3 / 100^3，100 时正好是 1.0
+uint32_t VolumeStage::targetGain() const
+{
+    if (muted)
+        return 0;
+    uint32_t v = volume;
+    return (uint32_t)((uint64_t)v * v * v * VOLUME_UNITY / 1000000);
+}
+
+uint32_t VolumeStage::rampFrames() const
+{
+    uint32_t n = (uint32_t)hertz * VOLUME_RAMP_MS / 1000;
+    return n ? n : 1;
+}
+
+void VolumeStage::startRamp(uint32_t toQ15, uint32_t frames)
+{
+    rampTo = toQ15;
+    int32_t to = (int32_t)toQ15 << VOLUME_GAIN_SHIFT;
+    if (frames == 0 || to == gain)
+    {
+        gain = to;
+        rampLeft = 0;
+        return;
+    }
+    step = (to - gain) / (int32_t)frames;
+    rampLeft = frames;
+}
+
+void VolumeStage::setVolume(uint8_t vol)
+{
+    volume = vol > 100 ? 100 : vol;
+    // 淡出/断点等待期间只记下目标，断点之后淡入时生效
+    if (declick != Declick::FADE)
+        startRamp(targetGain(), rampFrames());
+}
+
+void VolumeStage::setMuted(bool m)
+{
+    muted = m;
+    if (declick != Declick::FADE)
+        startRamp(targetGain(), rampFrames());
+}
+
+void VolumeStage::markDiscontinuity(uint32_t framesAhead)
+{
+    // 已接收未处理的帧在断点之前，还来得及淡出
+    uint32_t at = frame + inCount + framesAhead;
+    if (declick == Declick::FADE)
+    {
+        // 已经在淡出/静音：直接把断点推后
+        resumeAt = at;
+        return;
+    }
+    uint32_t ramp = rampFrames();
+    fadeAt = framesAhead + inCount > ramp ? at - ramp : frame;
+    resumeAt = at;
+    declick = Declick::WAIT;
+}
+
+// 对 blk 中 inCount 帧施加增益，结果留在原处等待送出
+void VolumeStage::process()
+{
+    uint32_t n = inCount;
+    bool event = declick != Declick::NONE && within(declick == Declick::WAIT ? fadeAt : resumeAt, frame, n);
+
+    if (rampLeft == 0 && !event)
+    {
+        // 增益在整块内不变
+        int32_t g = gain >> VOLUME_GAIN_SHIFT;
+        if (g == 0)
+            memset(blk, 0, n * 2 * sizeof(int16_t));
+        else if (g < VOLUME_UNITY)
+        {
+#if VOLUME_USE_DSP
+            dsps_mulc_s16(blk, blk, (int)n * 2, (int16_t)g, 1, 1);
+#else
+            for (uint32_t i = 0; i < n * 2; i++)
+                blk[i] = (int16_t)((blk[i] * g) >> 15);
+#endif
+        }
+        frame += n;
+    }
+    else
+    {
+        for (uint32_t i = 0; i < n; i++, frame++)
+        {
+            if (declick == Declick::WAIT && reached(frame, fadeAt))
+            {
+                declick = Declick::FADE;
+                startRamp(0, resumeAt - frame);
+            }
+            if (declick == Declick::FADE && reached(frame, resumeAt))
+            {
+                declick = Declick::NONE;
+                startRamp(targetGain(), rampFrames());
+            }
+            if (rampLeft)
+            {
+                gain += step;
+                if (--rampLeft == 0)
+                    gain = (int32_t)rampTo << VOLUME_GAIN_SHIFT;
+            }
+            int32_t g = gain >> VOLUME_GAIN_SHIFT;
+            blk[2 * i] = (int16_t)((blk[2 * i] * g) >> 15);
+            blk[2 * i + 1] = (int16_t)((blk[2 * i + 1] * g) >> 15);
+        }
+    }
+
+    outPos = 0;
+    outLen = (uint16_t)n;
+    inCount = 0;
+}
+
+// 把已处理的块送给下游；全部送出返回 true
+bool VolumeStage::drain()
+{
+    while (outPos < outLen)
+    {
+        uint16_t n = sink->ConsumeSamples(blk + outPos * 2, outLen - outPos);
+        if (n == 0)
+            return false;
+        outPos += n;
+    }
+    outPos = outLen = 0;
+    return true;
+}
+
+bool VolumeStage::ConsumeSample(int16_t sample[2])
+{
+    if (outLen && !drain())
+        return false;
+
+    int16_t s[2] = {sample[0], sample[1]};
+    MakeSampleStereo16(s);
+    blk[2 * inCount] = s[0];
+    blk[2 * inCount + 1] = s[1];
+    if (++inCount == VOLUME_BLOCK)
+    {
+        process();
+        drain();
+    }
+    return true;
+}
+
+bool VolumeStage::SetRate(int hz)
+{
+    hertz = hz;
+    return sink->SetRate(hz);
+}
+
+// 8 位样本在这里转成 16 位，下游始终是 16 位
+bool VolumeStage::SetBitsPerSample(int bits)
+{
+    bps = bits;
+    return sink->SetBitsPerSample(16);
+}
+
+bool VolumeStage::SetChannels(int chan)
+{
+    channels = chan;
+    return sink->SetChannels(chan);
+}
+
+// 增益由 setVolume() 管理，下游固定 1.0
+bool VolumeStage::SetGain(float f)
+{
+    (void)f;
+    return sink->SetGain(1.0f);
+}
+
+bool VolumeStage::begin()
+{
+    return sink->begin();
+}
+
+bool VolumeStage::stop()
+{
+    // 剩下不满一块的帧尽量送出，送不出就丢掉；下游停了，重新开始时从静音淡入
+    if (inCount)
+        process();
+    drain();
+    outPos = outLen = 0;
+    gain = 0;
+    rampLeft = 0;
+    if (declick != Declick::FADE)
+        startRamp(targetGain(), rampFrames());
+    return sink->stop();
+}
+
+void VolumeStage::flush()
+{
+    if (inCount && !outLen)
+        process();
+    drain();
+    sink->flush();
+}
+
+bool VolumeStage::loop()
+{
+    if (outLen)
+        drain();
+    return sink->loop();
+}
@@ -0,0 +1,73 @@
+#pragma once
+#include <stdint.h>
+#include <AudioOutput.h>
+
+// 输出链最后一级（频谱抽头之后、I2S 之前）的音量级：
+//   - 增益为 Q15 定点，按 VOLUME_BLOCK 帧成块处理；增益稳定时整块做一次乘法（有 esp-dsp 时用它的 SIMD 实现）
+//   - 音量变化、静音/取消静音都在 VOLUME_RAMP_MS 内逐帧线性过渡，不会爆音
+//   - 静音只是一个标志，音量值保留
+//   - 切歌/seek 时输出缓冲里还有旧数据：markDiscontinuity() 让旧数据在断点前淡出、新数据淡入
+// 所有接口只能在音频任务里调用（和解码、输出缓冲同一个任务）
+#define VOLUME_BLOCK 32   // 每块帧数（立体声样本对）
+#define VOLUME_RAMP_MS 8  // 增益过渡时长
+#define VOLUME_UNITY 32768 // Q15 的 1.0
+
+class VolumeStage : public AudioOutput
+{
+public:
+    explicit VolumeStage(AudioOutput *sink);
+
+    // 0~100，按三次曲线映射到增益
+    void setVolume(uint8_t vol);
+    void setMuted(bool muted);
+    // 输出流在 framesAhead 帧（尚在上游缓冲中的帧数）之后出现不连续：
+    // 在断点前把增益降到 0，断点后重新淡入
+    void markDiscontinuity(uint32_t framesAhead);
+    uint16_t currentGain() const { return (uint16_t)(gain >> VOLUME_GAIN_SHIFT); }
+
+    virtual bool SetRate(int hz) override;
+    virtual bool SetBitsPerSample(int bits) override;
+    virtual bool SetChannels(int chan) override;
+    virtual bool SetGain(float f) override;
+    virtual bool begin() override;
+    virtual bool ConsumeSample(int16_t sample[2]) override;
+    virtual bool stop() override;
+    virtual void flush() override;
+    virtual bool loop() override;
+
+private:
+    static const int VOLUME_GAIN_SHIFT = 8; // gain 比 Q15 多 8 位小数，过渡步长才不会被舍入成 0
+
+    enum class Declick : uint8_t
+    {
+        NONE,
+        WAIT, // 还没到淡出起点
+        FADE, // 淡出中或已静音，等到断点
+    };
+
+    uint32_t targetGain() const;
+    uint32_t rampFrames() const;
+    void startRamp(uint32_t toQ15, uint32_t frames);
+    void process();
+    bool drain();
+
+    AudioOutput *sink;
+
+    int16_t blk[VOLUME_BLOCK * 2];
+    uint16_t inCount; // 已接收、尚未处理的帧
+    uint16_t outPos;  // 已处理的块中已送出的帧
+    uint16_t outLen;  // 已处理、等待送出的帧（为 0 时表示没有待送的块）
+
+    uint32_t frame; // 已处理的帧数（回绕安全比较）
+    int32_t gain;   // 当前增益，Q15 << VOLUME_GAIN_SHIFT
+    int32_t step;
+    uint32_t rampLeft;
+    uint32_t rampTo; // 过渡终点，Q15
+
+    uint8_t volume;
+    bool muted;
+
+    Declick declick;
+    uint32_t fadeAt;   // 淡出起点（帧序号）
+    uint32_t resumeAt; // 断点（帧序号），从这里开始淡入
+};
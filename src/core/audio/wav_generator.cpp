@@ -0,0 +1,148 @@
+#include "core/audio/wav_generator.h"
+#include <stdlib.h>
+
+// 一个样本的高 16 位（小端，8 位为无符号）
+static inline int16_t sample16(const uint8_t *p, uint8_t bytes)
+{
+    switch (bytes)
+    {
+    case 1:
+        return (int16_t)((p[0] - 128) << 8);
+    case 2:
+        return (int16_t)(p[0] | (p[1] << 8));
+    case 3:
+        return (int16_t)(p[1] | (p[2] << 8));
+    default:
+        return (int16_t)(p[2] | (p[3] << 8));
+    }
+}
+
+// 把 frames 帧原始 PCM 原地转成 16 位立体声。
+// 输出帧（4 字节）比输入帧大时从后往前转，否则从前往后，保证读在写之前
+static void toStereo16(int16_t *buf, uint16_t frames, uint8_t channels, uint8_t bytes)
+{
+    const uint8_t *raw = (const uint8_t *)buf;
+    uint16_t align = channels * bytes;
+    if (align >= 4)
+    {
+        for (uint16_t i = 0; i < frames; i++)
+        {
+            const uint8_t *p = raw + i * align;
+            int16_t l = sample16(p, bytes);
+            int16_t r = channels == 2 ? sample16(p + bytes, bytes) : l;
+            buf[2 * i] = l;
+            buf[2 * i + 1] = r;
+        }
+    }
+    else
+    {
+        for (int i = frames - 1; i >= 0; i--)
+        {
+            const uint8_t *p = raw + i * align;
+            int16_t l = sample16(p, bytes);
+            int16_t r = channels == 2 ? sample16(p + bytes, bytes) : l;
+            buf[2 * i] = l;
+            buf[2 * i + 1] = r;
+        }
+    }
+}
+
+WavGenerator::WavGenerator(const WavStreamInfo &info)
+    : info(info), remaining(0), bufLen(0), bufPos(0)
+{
+    running = false;
+    file = nullptr;
+    output = nullptr;
+    buf = (int16_t *)malloc(WAV_GEN_FRAMES * 8);
+}
+
+WavGenerator::~WavGenerator()
+{
+    free(buf);
+}
+
+bool WavGenerator::begin(AudioFileSource *source, AudioOutput *out)
+{
+    if (!source || !out || !buf || !info.blockAlign)
+        return false;
+    file = source;
+    output = out;
+
+    // 从当前读位置开始（打开时在 data 块开头，seek 后在落点）
+    uint32_t pos = file->getPos();
+    if (pos < info.dataStart || pos >= info.dataEnd)
+    {
+        pos = info.dataStart;
+        file->seek(pos, SEEK_SET);
+    }
+    remaining = info.dataEnd - pos;
+    bufLen = bufPos = 0;
+
+    output->SetRate(info.sampleRate);
+    output->SetBitsPerSample(16);
+    output->SetChannels(2);
+    running = output->begin();
+    return running;
+}
+
+// 读下一块并转换；data 块读完返回 false
+bool WavGenerator::fill()
+{
+    uint32_t want = WAV_GEN_FRAMES * info.blockAlign;
+    if (want > remaining)
+        want = remaining;
+    if (want == 0)
+        return false;
+
+    uint8_t *raw = (uint8_t *)buf;
+    uint32_t got = 0;
+    while (got < want)
+    {
+        uint32_t r = file->read(raw + got, want - got);
+        if (r == 0)
+            break;
+        got += r;
+    }
+    // 读不满说明文件比头部声明的短，之后不再读
+    remaining = got < want ? 0 : remaining - got;
+
+    uint16_t frames = got / info.blockAlign;
+    if (frames == 0)
+        return false;
+    if (info.channels != 2 || info.blockAlign != 4)
+        toStereo16(buf, frames, info.channels, info.blockAlign / info.channels);
+    bufLen = frames;
+    bufPos = 0;
+    return true;
+}
+
+bool WavGenerator::loop()
+{
+    if (!running)
+        return false;
+
+    // 和 MP3 解码器一样一直喂到输出端不再接收为止
+    while (running)
+    {
+        if (bufPos < bufLen)
+        {
+            bufPos += output->ConsumeSamples(buf + bufPos * 2, bufLen - bufPos);
+            if (bufPos < bufLen)
+                break;
+        }
+        if (!fill())
+            running = false;
+    }
+    file->loop();
+    output->loop();
+    return running;
+}
+
+bool WavGenerator::stop()
+{
+    running = false;
+    bufLen = bufPos = 0;
+    if (output)
+        output->stop();
+    return file ? file->close() : true;
+}
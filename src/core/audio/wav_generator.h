@@ -0,0 +1,32 @@
+#pragma once
+#include <stdint.h>
+#include <AudioGenerator.h>
+#include "core/audio/wav_source.h"
+
+// 每次从文件读取的帧数（缓冲 WAV_GEN_FRAMES * 8 字节，够放双声道 32 位）
+#define WAV_GEN_FRAMES 256
+
+// WAV 播放：没有解码，只把 PCM 整块读进来、原地转成 16 位立体声后成块交给输出。
+// 16 位立体声直接读进输出缓冲，不做任何转换。
+// 和 ESP8266Audio 的 AudioGeneratorWAV 相比：流参数由 wavReadStreamInfo() 在打开时解析好，
+// begin() 可以从 data 块的任意帧开始（seek 后重启即可），输出走 ConsumeSamples() 整块写入
+class WavGenerator : public AudioGenerator
+{
+public:
+    explicit WavGenerator(const WavStreamInfo &info);
+    virtual ~WavGenerator() override;
+
+    virtual bool begin(AudioFileSource *source, AudioOutput *output) override;
+    virtual bool loop() override;
+    virtual bool stop() override;
+    virtual bool isRunning() override { return running; }
+
+private:
+    bool fill();
+
+    WavStreamInfo info;
+    int16_t *buf;
+    uint32_t remaining; // data 块里还没读的字节
+    uint16_t bufLen;    // 缓冲里的帧数
+    uint16_t bufPos;    // 已送出的帧数
+};
@@ -0,0 +1,117 @@
+#include "core/audio/wav_source.h"
+#include "core/audio/mp3_info.h"
+#include <string.h>
+
+// 找 fmt/data 块时最多看多少个块头（LIST/INFO、bext 之类的块会排在前面）
+#define WAV_MAX_CHUNKS 32
+
+#define WAV_FORMAT_PCM 0x0001
+#define WAV_FORMAT_EXTENSIBLE 0xFFFE
+
+static inline uint32_t le32(const uint8_t *p)
+{
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+static inline uint16_t le16(const uint8_t *p)
+{
+    return (uint16_t)(p[0] | (p[1] << 8));
+}
+
+static bool parseFmt(const uint8_t *f, uint32_t len, WavStreamInfo &info)
+{
+    if (len < 16)
+        return false;
+    uint16_t tag = le16(f);
+    // EXTENSIBLE：子格式 GUID 的前两个字节就是格式号
+    if (tag == WAV_FORMAT_EXTENSIBLE && len >= 26)
+        tag = le16(f + 24);
+    if (tag != WAV_FORMAT_PCM)
+        return false;
+
+    info.channels = (uint8_t)le16(f + 2);
+    info.sampleRate = le32(f + 4);
+    info.blockAlign = le16(f + 12);
+    info.bitsPerSample = (uint8_t)le16(f + 14);
+
+    uint8_t bytes = (info.bitsPerSample + 7) / 8;
+    return (info.channels == 1 || info.channels == 2) && info.sampleRate > 0 &&
+           (bytes == 1 || bytes == 2 || bytes == 3 || bytes == 4) && info.blockAlign == bytes * info.channels;
+}
+
+bool wavReadStreamInfo(AudioFileSource *src, WavStreamInfo &info)
+{
+    memset(&info, 0, sizeof(info));
+    uint32_t size = src->getSize();
+
+    uint8_t hdr[12];
+    if (mp3ReadAt(src, 0, hdr, 12) != 12 || memcmp(hdr, "RIFF", 4) != 0 || memcmp(hdr + 8, "WAVE", 4) != 0)
+        return false;
+
+    bool haveFmt = false;
+    uint32_t pos = 12;
+    for (int i = 0; i < WAV_MAX_CHUNKS && pos + 8 <= size; i++)
+    {
+        uint8_t ch[8];
+        if (mp3ReadAt(src, pos, ch, 8) != 8)
+            return false;
+        uint32_t len = le32(ch + 4);
+
+        if (memcmp(ch, "fmt ", 4) == 0)
+        {
+            uint8_t f[40];
+            uint32_t n = len < sizeof(f) ? len : sizeof(f);
+            if (mp3ReadAt(src, pos + 8, f, n) != n || !parseFmt(f, n, info))
+                return false;
+            haveFmt = true;
+        }
+        else if (memcmp(ch, "data", 4) == 0)
+        {
+            if (!haveFmt)
+                return false;
+            info.dataStart = pos + 8;
+            // 录音机写到一半断电、或流式写出的文件，块大小常是 0 或 0xFFFFFFFF
+            uint32_t avail = size - info.dataStart;
+            uint32_t bytes = (len == 0 || len > avail) ? avail : len;
+            bytes -= bytes % info.blockAlign;
+            info.dataEnd = info.dataStart + bytes;
+            return bytes > 0;
+        }
+
+        // 块按偶数字节对齐
+        pos += 8 + len + (len & 1);
+    }
+    return false;
+}
+
+WavSource::WavSource(AudioFileSource *inner, const WavStreamInfo &info)
+    : TrackSource(inner, AudioFormat::WAV), info(info)
+{
+}
+
+uint32_t WavSource::validSamples() const
+{
+    return (info.dataEnd - info.dataStart) / info.blockAlign;
+}
+
+uint32_t WavSource::durationMs()
+{
+    return (uint32_t)((uint64_t)validSamples() * 1000 / info.sampleRate);
+}
+
+bool WavSource::locate(uint32_t ms, TrackSeekPoint &pt)
+{
+    uint32_t frames = validSamples();
+    uint32_t frame = (uint32_t)((uint64_t)ms * info.sampleRate / 1000);
+    if (frame >= frames)
+        frame = frames ? frames - 1 : 0;
+    pt.offset = info.dataStart + frame * info.blockAlign;
+    pt.sample = frame;
+    pt.exact = true;
+    return true;
+}
+
+bool WavSource::seekTo(const TrackSeekPoint &pt)
+{
+    return inner->seek(pt.offset, SEEK_SET);
+}
@@ -0,0 +1,37 @@
+#pragma once
+#include <stdint.h>
+#include "core/audio/track_source.h"
+
+// 曲目打开时解析的 RIFF/WAVE 头：只接受整数 PCM（含 WAVE_FORMAT_EXTENSIBLE），8/16/24/32 位，单/双声道
+struct WavStreamInfo
+{
+    uint32_t dataStart; // data 块内第一个样本的位置
+    uint32_t dataEnd;   // data 块结束位置（块大小缺失或超出文件时取文件末尾）
+    uint32_t sampleRate;
+    uint8_t channels;
+    uint8_t bitsPerSample;
+    uint16_t blockAlign; // 每帧字节数
+};
+
+// 从 src 当前文件读取 WAVE 头；只读文件开头的若干块头。
+// 返回后 src 的读写位置未定义，调用方需要自行 seek
+bool wavReadStreamInfo(AudioFileSource *src, WavStreamInfo &info);
+
+// WAV 曲目输入：时长和 seek 落点都按 blockAlign 直接算出，落点总是精确的
+class WavSource : public TrackSource
+{
+public:
+    WavSource(AudioFileSource *inner, const WavStreamInfo &info);
+
+    const WavStreamInfo &getInfo() const { return info; }
+
+    virtual uint32_t sampleRate() const override { return info.sampleRate; }
+    virtual uint32_t validSamples() const override;
+    virtual uint32_t durationMs() override;
+    virtual bool locate(uint32_t ms, TrackSeekPoint &pt) override;
+    virtual bool locateQuick(uint32_t ms, TrackSeekPoint &pt) override { return locate(ms, pt); }
+    virtual bool seekTo(const TrackSeekPoint &pt) override;
+
+private:
+    WavStreamInfo info;
+};
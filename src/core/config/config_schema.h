@@ -0,0 +1,25 @@
+#pragma once
+#include <stdint.h>
+
+// 配置字段表：X(键, 旧版 NVS 键名, 默认值, 最小值, 最大值)
+//   - NVS 里整块存成一个 blob，值按表中顺序排列（每项 int32）
+//   - 只能在末尾追加字段：旧固件写的短 blob 缺的字段取默认值，新固件写的长 blob 多出的字段被忽略
+//   - 调整已有字段的顺序或含义时提升 CONFIG_SCHEMA_VERSION，版本不符的 blob 作废，全部回到默认值
+//   - 旧版键名只用于一次性迁移早期逐键保存的配置，新增字段填 nullptr
+#define CONFIG_SCHEMA_VERSION 1
+
+#define CONFIG_FIELDS(X)                          \
+    X(VOLUME, "vol", 60, 0, 100)                  \
+    X(PLAY_MODE, "mode", 0, 0, 2) /* PlayMode */  \
+    X(GAPLESS, "gapless", 1, 0, 1)                \
+    X(TRACK_INDEX, "idx", 0, 0, INT32_MAX)
+
+// 配置项，数值即 blob 里的下标
+enum class ConfigKey : uint8_t
+{
+#define CONFIG_KEY_ENUM(key, legacy, def, lo, hi) key,
+    CONFIG_FIELDS(CONFIG_KEY_ENUM)
+#undef CONFIG_KEY_ENUM
+    COUNT // 必须放在最后
+};
+#define CONFIG_KEY_COUNT ((int)ConfigKey::COUNT)
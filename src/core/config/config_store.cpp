@@ -1,48 +1,263 @@
 #include "core/config/config_store.h"
+#include "platform/platform.h"
 #include <Preferences.h>
 #include <Arduino.h>
+#include <string.h>
+#include "log.h"
+
+#define CONFIG_NAMESPACE "mp3_cfg"
+#define CONFIG_BLOB_KEY "cfg"
+#define CONFIG_HOUR_MS 3600000UL
+// 读 blob 时接受的最多字段数（新固件写的 blob 可能比本固件的字段表长）
+#define CONFIG_BLOB_MAX_FIELDS 64
+
+struct ConfigField
+{
+    const char *legacyKey;
+    int32_t def;
+    int32_t lo;
+    int32_t hi;
+};
+
+static const ConfigField kFields[CONFIG_KEY_COUNT] = {
+#define CONFIG_FIELD_ENTRY(key, legacy, def, lo, hi) {legacy, def, lo, hi},
+    CONFIG_FIELDS(CONFIG_FIELD_ENTRY)
+#undef CONFIG_FIELD_ENTRY
+};
+
+// NVS 里的 blob：头部之后是 count 个 int32，按字段表顺序
+struct ConfigBlobHeader
+{
+    uint16_t version;
+    uint16_t count;
+};
+
+struct ConfigBlob
+{
+    ConfigBlobHeader hdr;
+    int32_t values[CONFIG_KEY_COUNT];
+};
 
 static Preferences prefs;
+static int32_t g_values[CONFIG_KEY_COUNT];
+static bool g_dirty = false;
+static uint32_t g_firstChangeAt = 0; // 本轮脏数据里第一次修改的时间
+static uint32_t g_lastChangeAt = 0;
+static uint32_t g_settleMs = CONFIG_SETTLE_MS;
+static bool g_lowBattery = false;
+static uint32_t g_lastBatteryCheck = 0;
+
+static uint32_t g_writes = 0;
+static uint32_t g_changes = 0;
+static uint32_t g_hourStart = 0;
+static uint32_t g_writesThisHour = 0;
+static uint32_t g_writesLastHour = 0;
+static bool g_hourRolled = false;
+
+static int32_t clampField(int i, int32_t v)
+{
+    if (v < kFields[i].lo)
+        return kFields[i].lo;
+    if (v > kFields[i].hi)
+        return kFields[i].hi;
+    return v;
+}
+
+static void loadDefaults()
+{
+    for (int i = 0; i < CONFIG_KEY_COUNT; i++)
+        g_values[i] = kFields[i].def;
+}
+
+// 读 blob；长度不对或版本不符时返回 false
+static bool loadBlob()
+{
+    size_t len = prefs.getBytesLength(CONFIG_BLOB_KEY);
+    if (len < sizeof(ConfigBlobHeader))
+        return false;
+
+    uint8_t raw[sizeof(ConfigBlobHeader) + CONFIG_BLOB_MAX_FIELDS * sizeof(int32_t)];
+    if (len > sizeof(raw) || prefs.getBytes(CONFIG_BLOB_KEY, raw, len) != len)
+        return false;
+    ConfigBlobHeader hdr;
+    memcpy(&hdr, raw, sizeof(hdr));
+    if (hdr.version != CONFIG_SCHEMA_VERSION || len != sizeof(hdr) + hdr.count * sizeof(int32_t))
+        return false;
+
+    for (int i = 0; i < CONFIG_KEY_COUNT && i < hdr.count; i++)
+    {
+        int32_t v;
+        memcpy(&v, raw + sizeof(hdr) + i * sizeof(int32_t), sizeof(v));
+        g_values[i] = clampField(i, v);
+    }
+    return true;
+}
+
+// 早期固件每项一个键、每次修改都写；这里只读，blob 写成功之后才删（removeLegacy）
+static bool migrateLegacy()
+{
+    bool found = false;
+    for (int i = 0; i < CONFIG_KEY_COUNT; i++)
+    {
+        const char *key = kFields[i].legacyKey;
+        if (!key || !prefs.isKey(key))
+            continue;
+        g_values[i] = clampField(i, prefs.getInt(key, kFields[i].def));
+        found = true;
+    }
+    return found;
+}
+
+static void removeLegacy()
+{
+    for (int i = 0; i < CONFIG_KEY_COUNT; i++)
+    {
+        const char *key = kFields[i].legacyKey;
+        if (key && prefs.isKey(key))
+            prefs.remove(key);
+    }
+}
+
+static bool writeBlob()
+{
+    ConfigBlob blob;
+    blob.hdr.version = CONFIG_SCHEMA_VERSION;
+    blob.hdr.count = CONFIG_KEY_COUNT;
+    memcpy(blob.values, g_values, sizeof(blob.values));
+
+    bool ok = prefs.begin(CONFIG_NAMESPACE, false) &&
+              prefs.putBytes(CONFIG_BLOB_KEY, &blob, sizeof(blob)) == sizeof(blob);
+    prefs.end();
+    if (!ok)
+    {
+        // 保持脏标记，隔一个静置时间再试
+        LOG_CFG("save failed");
+        g_lastChangeAt = g_firstChangeAt = millis();
+        return false;
+    }
+    g_dirty = false;
+    g_writes++;
+    g_writesThisHour++;
+    return true;
+}
 
 void configInit()
 {
-    // NVS 初始化
+    loadDefaults();
+    g_hourStart = millis();
+
+    if (!prefs.begin(CONFIG_NAMESPACE, false))
+    {
+        LOG_CFG("nvs unavailable, using defaults");
+        return;
+    }
+    bool loaded = loadBlob();
+    // 上次迁移写好了 blob、删旧键前断电的话，旧键留到这里再删
+    if (loaded)
+        removeLegacy();
+    bool migrated = !loaded && migrateLegacy();
+    prefs.end();
+
+    if (migrated)
+    {
+        LOG_CFG("migrated per-key settings to schema v%d", CONFIG_SCHEMA_VERSION);
+        // 先置脏：写失败时由 configPoll() 重试，旧键也还在，下次开机照样能迁移
+        g_dirty = true;
+        if (writeBlob() && prefs.begin(CONFIG_NAMESPACE, false))
+        {
+            removeLegacy();
+            prefs.end();
+        }
+    }
 }
 
 void configLoad(AppState *app)
 {
     if (!app)
         return;
+    app->volume = g_values[(int)ConfigKey::VOLUME];
+    app->currentTrackIdx = g_values[(int)ConfigKey::TRACK_INDEX];
+    app->playMode = (PlayMode)g_values[(int)ConfigKey::PLAY_MODE];
+    app->gapless = g_values[(int)ConfigKey::GAPLESS] != 0;
+}
+
+int32_t configGet(ConfigKey key)
+{
+    return g_values[(int)key];
+}
 
-    if (!prefs.begin("mp3_cfg", true))
-    { // read-only = true
-        // 默认值
-        app->volume = 60;
-        app->currentTrackIdx = 0;
-        app->playMode = PlayMode::SEQUENCE;
+void configSet(ConfigKey key, int32_t value)
+{
+    int i = (int)key;
+    if (i < 0 || i >= CONFIG_KEY_COUNT)
         return;
+    value = clampField(i, value);
+    if (g_values[i] == value)
+        return;
+
+    g_values[i] = value;
+    g_changes++;
+    g_lastChangeAt = millis();
+    if (!g_dirty)
+    {
+        g_dirty = true;
+        g_firstChangeAt = g_lastChangeAt;
     }
+}
 
-    app->volume = prefs.getInt("vol", 60);
-    app->currentTrackIdx = prefs.getInt("idx", 0);
-    // [修复] 读取模式
-    app->playMode = (PlayMode)prefs.getInt("mode", (int)PlayMode::SEQUENCE);
+void configSetSettleMs(uint32_t ms)
+{
+    g_settleMs = ms;
+}
 
-    prefs.end();
+void configFlush()
+{
+    if (g_dirty)
+        writeBlob();
 }
 
-void configSave(const AppState *app)
+static void pollBattery()
 {
-    if (!app)
+    if (millis() - g_lastBatteryCheck < CONFIG_BATTERY_CHECK_MS && g_lastBatteryCheck)
         return;
+    g_lastBatteryCheck = millis();
+
+    BatteryStatus bat = platformGetBattery();
+    bool low = !bat.charging && bat.level <= CONFIG_LOW_BATTERY_LEVEL;
+    if (low != g_lowBattery)
+    {
+        g_lowBattery = low;
+        LOG_CFG("battery %d%%, %s", (int)bat.level, low ? "writing settings immediately" : "write coalescing resumed");
+        if (low)
+            configFlush();
+    }
+}
 
-    if (!prefs.begin("mp3_cfg", false))
-        return; // read-write
+void configPoll()
+{
+    pollBattery();
 
-    prefs.putInt("vol", app->volume);
-    prefs.putInt("idx", app->currentTrackIdx);
-    // [修复] 保存模式
-    prefs.putInt("mode", (int)app->playMode);
+    uint32_t now = millis();
+    if (g_dirty && (g_lowBattery || now - g_lastChangeAt >= g_settleMs ||
+                    now - g_firstChangeAt >= CONFIG_MAX_DEFER_MS))
+        writeBlob();
 
-    prefs.end();
-}
\ No newline at end of file
+    if (now - g_hourStart >= CONFIG_HOUR_MS)
+    {
+        g_hourStart += CONFIG_HOUR_MS;
+        g_writesLastHour = g_writesThisHour;
+        g_writesThisHour = 0;
+        g_hourRolled = true;
+        LOG_CFG("nvs writes: %lu in the last hour, %lu since boot for %lu changes",
+                (unsigned long)g_writesLastHour, (unsigned long)g_writes, (unsigned long)g_changes);
+    }
+}
+
+ConfigStats configGetStats()
+{
+    ConfigStats s;
+    s.writes = g_writes;
+    s.writesLastHour = g_hourRolled ? g_writesLastHour : g_writesThisHour;
+    s.changes = g_changes;
+    return s;
+}
@@ -1,6 +1,37 @@
 #pragma once
+#include <stdint.h>
+#include "core/config/config_schema.h"
 #include "core/state/app_state.h"
 
+// 配置存储：按 config_schema.h 的字段表在内存里保存一份，修改只改内存并标脏。
+// 最后一次修改之后静置 settle 毫秒才把整张表作为一个 blob 写进 NVS（按住音量键、连续切歌只写一次）；
+// 一直有修改时最多推迟 CONFIG_MAX_DEFER_MS。电量低于 CONFIG_LOW_BATTERY_LEVEL 且未充电时不再等待，
+// 关机/重启前也会立即写出。除 configFlush() 外只在 loop 任务里调用
+#define CONFIG_SETTLE_MS 3000
+#define CONFIG_MAX_DEFER_MS 60000
+#define CONFIG_LOW_BATTERY_LEVEL 5  // 电量 %
+#define CONFIG_BATTERY_CHECK_MS 10000
+
+struct ConfigStats
+{
+    uint32_t writes;         // 开机以来写 NVS 的次数
+    uint32_t writesLastHour; // 上一个整小时窗口内的写入次数（开机不满一小时时为当前窗口）
+    uint32_t changes;        // 开机以来值真正改变的次数（写入次数远小于它说明合并生效）
+};
+
+// 读 NVS 里的 blob；没有时迁移旧版逐键保存的配置，都没有时用默认值
 void configInit();
+// 把内存里的配置填进 AppState
 void configLoad(AppState *app);
-void configSave(const AppState *app);
\ No newline at end of file
+
+int32_t configGet(ConfigKey key);
+// 超出范围的值被夹到 [最小值, 最大值]；和当前值相同时什么也不做
+void configSet(ConfigKey key, int32_t value);
+void configSetSettleMs(uint32_t ms);
+
+// loop() 里调用：到时间就写出、检查电量、滚动每小时写入计数
+void configPoll();
+// 有未写出的修改时立即写（低电量、关机时用）
+void configFlush();
+
+ConfigStats configGetStats();
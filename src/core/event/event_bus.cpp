@@ -1,61 +1,178 @@
 #include "core/event/event_bus.h"
 #include "log.h"
-#include <vector>
+#include <atomic>
+#include <string.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/queue.h>
 
 #define MAX_QUEUE_SIZE 32
-#define MAX_HANDLERS 16
+#define EVENT_BUS_MAX_HANDLERS 4
 
-struct Subscription
+#define EVENT_TYPE_COUNT ((size_t)EventType::COUNT)
+
+// 分发表：按事件类型直接下标，分发时不用遍历全部订阅
+struct HandlerSlot
 {
-    EventType type;
-    EventHandler handler;
+    uint8_t count;
+    EventHandler handlers[EVENT_BUS_MAX_HANDLERS];
 };
 
-static std::vector<Subscription> g_subs;
-static Event g_queue[MAX_QUEUE_SIZE];
-static int g_head = 0;
-static int g_tail = 0;
+static HandlerSlot g_table[EVENT_TYPE_COUNT];
+static QueueHandle_t g_queue = nullptr;
+
+// published/dropped 可能来自任意任务或中断；dispatched/maxDepth 只在 poll 任务里写
+static std::atomic<uint32_t> g_published(0);
+static std::atomic<uint32_t> g_dropped(0);
+static uint32_t g_dispatched = 0;
+static uint32_t g_maxDepth = 0;
 
 void eventBusInit()
 {
-    g_subs.reserve(MAX_HANDLERS);
-    g_head = g_tail = 0;
+    memset(g_table, 0, sizeof(g_table));
+    if (!g_queue)
+        g_queue = xQueueCreate(MAX_QUEUE_SIZE, sizeof(Event));
     LOG_CORE("EventBus initialized");
 }
 
 bool eventBusSubscribe(EventType type, EventHandler handler)
 {
-    if (g_subs.size() >= MAX_HANDLERS)
+    size_t t = (size_t)type;
+    if (t >= EVENT_TYPE_COUNT || !handler)
+        return false;
+    HandlerSlot &slot = g_table[t];
+    if (slot.count >= EVENT_BUS_MAX_HANDLERS)
         return false;
-    g_subs.push_back({type, handler});
+    slot.handlers[slot.count++] = handler;
     return true;
 }
 
 bool eventBusPublish(const Event &ev)
 {
-    int next = (g_head + 1) % MAX_QUEUE_SIZE;
-    if (next == g_tail)
+    if (!g_queue)
+        return false;
+
+    Event e = ev;
+    e.ts_ms = millis();
+
+    BaseType_t ok;
+    if (xPortInIsrContext())
+    {
+        BaseType_t woken = pdFALSE;
+        ok = xQueueSendFromISR(g_queue, &e, &woken);
+        portYIELD_FROM_ISR(woken);
+    }
+    else
     {
-        LOG_CORE("EventBus queue full!");
+        ok = xQueueSend(g_queue, &e, 0);
+    }
+
+    if (ok != pdTRUE)
+    {
+        // 中断里不打日志，只计数
+        g_dropped.fetch_add(1, std::memory_order_relaxed);
         return false;
     }
-    g_queue[g_head] = ev;
-    g_head = next;
+    g_published.fetch_add(1, std::memory_order_relaxed);
     return true;
 }
 
+bool eventBusPublish(EventType type)
+{
+    Event ev;
+    memset(&ev, 0, sizeof(ev));
+    ev.type = type;
+    return eventBusPublish(ev);
+}
+
+static inline void dispatch(const Event &ev)
+{
+    size_t t = (size_t)ev.type;
+    if (t >= EVENT_TYPE_COUNT)
+        return;
+    const HandlerSlot &slot = g_table[t];
+    for (uint8_t i = 0; i < slot.count; i++)
+        slot.handlers[i](ev);
+    g_dispatched++;
+}
+
 void eventBusPoll()
 {
-    while (g_head != g_tail)
+    if (!g_queue)
+        return;
+
+    uint32_t depth = uxQueueMessagesWaiting(g_queue);
+    if (depth > g_maxDepth)
+        g_maxDepth = depth;
+
+    // 只处理进入时已在队列里的事件，处理函数里再发布的留到下一轮
+    Event ev;
+    while (depth-- > 0 && xQueueReceive(g_queue, &ev, 0) == pdTRUE)
+        dispatch(ev);
+}
+
+EventBusStats eventBusGetStats()
+{
+    EventBusStats s;
+    s.published = g_published.load(std::memory_order_relaxed);
+    s.dispatched = g_dispatched;
+    s.dropped = g_dropped.load(std::memory_order_relaxed);
+    s.maxDepth = g_maxDepth;
+    return s;
+}
+
+// ==========================
+// 吞吐测试
+// ==========================
+static volatile uint32_t g_benchSink = 0;
+
+static void benchHandler(const Event &ev)
+{
+    g_benchSink += ev.data.track.index;
+}
+
+void eventBusRunBenchmark(uint32_t count)
+{
+    if (!g_queue || count == 0)
+        return;
+
+    // 临时占用 BENCHMARK 类型的一个处理槽
+    HandlerSlot saved = g_table[(size_t)EventType::BENCHMARK];
+    g_table[(size_t)EventType::BENCHMARK].count = 0;
+    eventBusSubscribe(EventType::BENCHMARK, benchHandler);
+
+    Event ev;
+    memset(&ev, 0, sizeof(ev));
+    ev.type = EventType::BENCHMARK;
+
+    uint32_t publishUs = 0;
+    uint32_t dispatchUs = 0;
+    uint32_t done = 0;
+    while (done < count)
     {
-        Event &ev = g_queue[g_tail];
-        for (const auto &sub : g_subs)
+        // 每批填满队列再一次性分发，分别计时
+        uint32_t batch = count - done;
+        if (batch > MAX_QUEUE_SIZE)
+            batch = MAX_QUEUE_SIZE;
+
+        uint32_t t0 = micros();
+        for (uint32_t i = 0; i < batch; i++)
         {
-            if (sub.type == ev.type)
-            {
-                sub.handler(ev);
-            }
+            ev.data.track.index = (int32_t)(done + i);
+            eventBusPublish(ev);
         }
-        g_tail = (g_tail + 1) % MAX_QUEUE_SIZE;
+        uint32_t t1 = micros();
+        eventBusPoll();
+        uint32_t t2 = micros();
+
+        publishUs += t1 - t0;
+        dispatchUs += t2 - t1;
+        done += batch;
     }
-}
\ No newline at end of file
+
+    g_table[(size_t)EventType::BENCHMARK] = saved;
+
+    uint32_t pubRate = publishUs ? (uint32_t)((uint64_t)count * 1000000 / publishUs) : 0;
+    uint32_t dispRate = dispatchUs ? (uint32_t)((uint64_t)count * 1000000 / dispatchUs) : 0;
+    LOG_CORE("EventBus bench: %lu events, publish %lu ev/s, dispatch %lu ev/s",
+             (unsigned long)count, (unsigned long)pubRate, (unsigned long)dispRate);
+}
@@ -3,7 +3,23 @@
 
 typedef void (*EventHandler)(const Event &);
 
+struct EventBusStats
+{
+    uint32_t published;
+    uint32_t dispatched;
+    uint32_t dropped;  // 队列满时丢弃
+    uint32_t maxDepth; // 单次 poll 时的最大积压
+};
+
 void eventBusInit();
+// 在启动阶段或 eventBusPoll() 所在任务里调用；每种事件最多 EVENT_BUS_MAX_HANDLERS 个处理函数
 bool eventBusSubscribe(EventType type, EventHandler handler);
+// 任意任务或中断里都可以调用；不阻塞，队列满返回 false
 bool eventBusPublish(const Event &ev);
-void eventBusPoll();
\ No newline at end of file
+bool eventBusPublish(EventType type);
+// 在一个固定任务（loop）里调用，按发布顺序把积压的事件分发给对应类型的处理函数
+void eventBusPoll();
+EventBusStats eventBusGetStats();
+
+// 吞吐测试：发布并分发 count 个事件，分别统计每秒发布/分发次数并打印
+void eventBusRunBenchmark(uint32_t count);
@@ -1,35 +1,58 @@
 #pragma once
 #include <stdint.h>
 #include "platform/platform.h" // 需要引用 platform.h 中的 KeyEvent 定义
+#include "core/config/config_schema.h" // ConfigKey
 
 enum class EventType : uint16_t
 {
     KEY_EVENT,
 
-    // 播放控制
-    PLAY_REQUEST,
+    // 播放控制（UI -> 音频）
+    PLAY_REQUEST,   // track
     PAUSE_REQUEST,
-    // 预留给未来扩展
-    RESUME_REQUEST,
+    RESUME_REQUEST, // track：解码器未运行时从这首开始
+    NEXT_REQUEST,   // 下一首/上一首：由音频任务按播放模式决定是哪首
+    PREV_REQUEST,
     STOP_REQUEST,
-    NEXT_TRACK,
-    PREV_TRACK,
+    SEEK_REQUEST,   // seek
+    VOLUME_CHANGED, // volume
+
+    // 播放状态（音频 -> UI）
+    TRACK_CHANGED, // track：开始播放一首，或重扫后当前曲目换了序号
 
     // 系统
-    CONFIG_CHANGED,
+    CONFIG_CHANGED, // config
+    BENCHMARK,      // 仅供 eventBusRunBenchmark() 使用
+
+    COUNT // 必须放在最后：分发表按它分配
 };
 
 struct Event
 {
     EventType type;
-    uint32_t ts_ms;
+    uint32_t ts_ms; // 发布时填写
 
     union
     {
         KeyEvent key;
         struct
         {
-            int dummy;
-        } _placeholder; // 占位符，防止 union 为空
+            int32_t index;
+            uint32_t handle; // 请求类事件：发布时这个序号上的曲目，音频任务按它找当前序号
+        } track;
+        struct
+        {
+            int32_t deltaMs;
+        } seek;
+        struct
+        {
+            int32_t level; // 0~100
+            bool muted;
+        } volume;
+        struct
+        {
+            ConfigKey key;
+            int32_t value;
+        } config;
     } data;
-};
\ No newline at end of file
+};
@@ -0,0 +1,434 @@
+#include "core/library/id3_tags.h"
+#include "core/audio/mp3_info.h"
+#include <stdlib.h>
+#include <string.h>
+
+// 单个文本帧最多读入的字节数，更长的文本截断（标题等字段本来也放不下）
+#define ID3_FRAME_READ_MAX 256
+// 最多看多少个帧，防止损坏的标签让扫描卡住
+#define ID3_MAX_FRAMES 256
+
+enum Id3Field
+{
+    FIELD_TITLE,
+    FIELD_ARTIST,
+    FIELD_BAND, // TPE2（专辑艺术家），没有 TPE1 时代替
+    FIELD_ALBUM,
+    FIELD_TRACK,
+    FIELD_LENGTH,
+    FIELD_COUNT
+};
+#define FIELD_ALL ((1u << FIELD_COUNT) - 1)
+
+struct FrameId
+{
+    char v3[5]; // 2.3 / 2.4
+    char v2[4]; // 2.2
+    uint8_t field;
+};
+
+static const FrameId kFrames[] = {
+    {"TIT2", "TT2", FIELD_TITLE},
+    {"TPE1", "TP1", FIELD_ARTIST},
+    {"TPE2", "TP2", FIELD_BAND},
+    {"TALB", "TAL", FIELD_ALBUM},
+    {"TRCK", "TRK", FIELD_TRACK},
+    {"TLEN", "TLE", FIELD_LENGTH},
+};
+
+static inline uint32_t syncsafe(const uint8_t *p)
+{
+    return ((uint32_t)(p[0] & 0x7F) << 21) | ((uint32_t)(p[1] & 0x7F) << 14) |
+           ((uint32_t)(p[2] & 0x7F) << 7) | (uint32_t)(p[3] & 0x7F);
+}
+
+static inline uint32_t be32(const uint8_t *p)
+{
+    return ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) | ((uint32_t)p[2] << 8) | p[3];
+}
+
+// ======================
+// 文本转换：一律输出 UTF-8，放不下时在字符边界截断
+// ======================
+struct Utf8Writer
+{
+    char *out;
+    size_t cap;
+    size_t len;
+    bool full;
+
+    void put(uint32_t cp)
+    {
+        if (full)
+            return;
+        char t[4];
+        size_t k;
+        if (cp < 0x80)
+        {
+            t[0] = (char)cp;
+            k = 1;
+        }
+        else if (cp < 0x800)
+        {
+            t[0] = (char)(0xC0 | (cp >> 6));
+            t[1] = (char)(0x80 | (cp & 0x3F));
+            k = 2;
+        }
+        else if (cp < 0x10000)
+        {
+            t[0] = (char)(0xE0 | (cp >> 12));
+            t[1] = (char)(0x80 | ((cp >> 6) & 0x3F));
+            t[2] = (char)(0x80 | (cp & 0x3F));
+            k = 3;
+        }
+        else
+        {
+            t[0] = (char)(0xF0 | (cp >> 18));
+            t[1] = (char)(0x80 | ((cp >> 12) & 0x3F));
+            t[2] = (char)(0x80 | ((cp >> 6) & 0x3F));
+            t[3] = (char)(0x80 | (cp & 0x3F));
+            k = 4;
+        }
+        if (len + k >= cap)
+        {
+            full = true;
+            return;
+        }
+        memcpy(out + len, t, k);
+        len += k;
+    }
+
+    // 去掉末尾空白（ID3v1 用空格补齐）后写入 '\0'
+    void finish()
+    {
+        while (len > 0 && (out[len - 1] == ' ' || out[len - 1] == '\t'))
+            len--;
+        out[len] = '\0';
+    }
+};
+
+// 合法 UTF-8 时返回解码出的码点数，否则返回 -1
+static int utf8Length(const uint8_t *p, uint32_t n)
+{
+    int count = 0;
+    for (uint32_t i = 0; i < n; count++)
+    {
+        uint8_t b = p[i];
+        uint32_t more = b < 0x80 ? 0 : (b & 0xE0) == 0xC0 ? 1 : (b & 0xF0) == 0xE0 ? 2 : (b & 0xF8) == 0xF0 ? 3 : 4;
+        if (more == 4 || (b & 0xFE) == 0xC0 || i + more >= n)
+            return -1;
+        for (uint32_t k = 1; k <= more; k++)
+        {
+            if ((p[i + k] & 0xC0) != 0x80)
+                return -1;
+        }
+        i += more + 1;
+    }
+    return count;
+}
+
+// 去掉末尾不完整的多字节序列（帧内容被截断时会出现）
+static uint32_t utf8TrimTail(const uint8_t *p, uint32_t n)
+{
+    uint32_t i = n;
+    while (i > 0 && n - i < 4 && (p[i - 1] & 0xC0) == 0x80)
+        i--;
+    if (i == 0 || p[i - 1] < 0x80)
+        return n;
+    uint8_t b = p[i - 1];
+    uint32_t need = (b & 0xE0) == 0xC0 ? 2 : (b & 0xF0) == 0xE0 ? 3 : 4;
+    return n - (i - 1) < need ? i - 1 : n;
+}
+
+static void putUtf8(Utf8Writer &w, const uint8_t *p, uint32_t n)
+{
+    for (uint32_t i = 0; i < n;)
+    {
+        uint8_t b = p[i];
+        uint32_t more = b < 0x80 ? 0 : (b & 0xE0) == 0xC0 ? 1 : (b & 0xF0) == 0xE0 ? 2 : 3;
+        uint32_t cp = more == 0 ? b : more == 1 ? (b & 0x1F) : more == 2 ? (b & 0x0F) : (b & 0x07);
+        for (uint32_t k = 1; k <= more; k++)
+            cp = (cp << 6) | (p[i + k] & 0x3F);
+        w.put(cp);
+        i += more + 1;
+    }
+}
+
+// 声明为 Latin-1 的文本：不少工具其实写的是 UTF-8，合法就照原样用；
+// 出现连续的高位字节多半是 GBK/Shift-JIS 等双字节编码，没有码表可转，整段放弃
+static void putLegacy(Utf8Writer &w, const uint8_t *p, uint32_t n)
+{
+    if (utf8Length(p, n) >= 0)
+    {
+        putUtf8(w, p, n);
+        return;
+    }
+    for (uint32_t i = 0; i + 1 < n; i++)
+    {
+        if (p[i] >= 0x80 && p[i + 1] >= 0x80)
+            return;
+    }
+    for (uint32_t i = 0; i < n; i++)
+        w.put(p[i]);
+}
+
+static void putUtf16(Utf8Writer &w, const uint8_t *p, uint32_t n, bool bigEndian)
+{
+    uint32_t hi = 0; // 待配对的高代理
+    for (uint32_t i = 0; i + 1 < n; i += 2)
+    {
+        uint32_t u = bigEndian ? (uint32_t)((p[i] << 8) | p[i + 1]) : (uint32_t)((p[i + 1] << 8) | p[i]);
+        if (u >= 0xD800 && u < 0xDC00)
+        {
+            hi = u;
+            continue;
+        }
+        if (u >= 0xDC00 && u < 0xE000)
+        {
+            if (hi)
+                w.put(0x10000 + ((hi - 0xD800) << 10) + (u - 0xDC00));
+            hi = 0;
+            continue;
+        }
+        hi = 0;
+        w.put(u);
+    }
+}
+
+// 文本帧内容：编码字节 + 文本。2.4 允许多个值以 '\0' 分隔，只取第一个
+static void decodeText(const uint8_t *p, uint32_t n, char *out, size_t cap)
+{
+    Utf8Writer w = {out, cap, 0, false};
+    if (n > 1)
+    {
+        uint8_t enc = p[0];
+        p++;
+        n--;
+        if (enc == 1 || enc == 2)
+        {
+            uint32_t end = 0;
+            while (end + 1 < n && (p[end] || p[end + 1]))
+                end += 2;
+            bool bigEndian = enc == 2;
+            if (end >= 2 && ((p[0] == 0xFF && p[1] == 0xFE) || (p[0] == 0xFE && p[1] == 0xFF)))
+            {
+                bigEndian = p[0] == 0xFE;
+                p += 2;
+                end -= 2;
+            }
+            putUtf16(w, p, end, bigEndian);
+        }
+        else
+        {
+            const uint8_t *z = (const uint8_t *)memchr(p, 0, n);
+            uint32_t end = z ? (uint32_t)(z - p) : n;
+            if (enc == 3)
+            {
+                end = utf8TrimTail(p, end);
+                if (utf8Length(p, end) >= 0)
+                    putUtf8(w, p, end);
+            }
+            else
+            {
+                putLegacy(w, p, end);
+            }
+        }
+    }
+    w.finish();
+}
+
+// 去掉反同步插入的 0x00（0xFF 0x00 -> 0xFF），返回新长度
+static uint32_t undoUnsync(uint8_t *p, uint32_t n)
+{
+    uint32_t w = 0;
+    for (uint32_t r = 0; r < n; r++)
+    {
+        p[w++] = p[r];
+        if (p[r] == 0xFF && r + 1 < n && p[r + 1] == 0x00)
+            r++;
+    }
+    return w;
+}
+
+static int lookupFrame(const uint8_t *id, uint8_t major)
+{
+    for (size_t i = 0; i < sizeof(kFrames) / sizeof(kFrames[0]); i++)
+    {
+        if (major == 2 ? memcmp(id, kFrames[i].v2, 3) == 0 : memcmp(id, kFrames[i].v3, 4) == 0)
+            return kFrames[i].field;
+    }
+    return -1;
+}
+
+static bool validFrameId(const uint8_t *id, int len)
+{
+    for (int i = 0; i < len; i++)
+    {
+        if (!((id[i] >= 'A' && id[i] <= 'Z') || (id[i] >= '0' && id[i] <= '9')))
+            return false;
+    }
+    return true;
+}
+
+static void storeField(int field, const uint8_t *p, uint32_t n, Id3Tags &out, char *band)
+{
+    char num[16];
+    switch (field)
+    {
+    case FIELD_TITLE:
+        decodeText(p, n, out.title, sizeof(out.title));
+        break;
+    case FIELD_ARTIST:
+        decodeText(p, n, out.artist, sizeof(out.artist));
+        break;
+    case FIELD_BAND:
+        decodeText(p, n, band, ID3_ARTIST_MAX);
+        break;
+    case FIELD_ALBUM:
+        decodeText(p, n, out.album, sizeof(out.album));
+        break;
+    case FIELD_TRACK:
+        // "3" 或 "3/12"
+        decodeText(p, n, num, sizeof(num));
+        out.trackNo = (uint16_t)strtoul(num, nullptr, 10);
+        break;
+    case FIELD_LENGTH:
+        decodeText(p, n, num, sizeof(num));
+        out.lengthMs = (uint32_t)strtoul(num, nullptr, 10);
+        break;
+    }
+}
+
+// ======================
+// ID3v2
+// ======================
+static void readV2(AudioFileSource *src, Id3Tags &out, char *band, uint8_t *buf)
+{
+    uint8_t h[10];
+    if (mp3ReadAt(src, 0, h, 10) != 10 || memcmp(h, "ID3", 3) != 0)
+        return;
+    uint8_t major = h[3];
+    uint8_t flags = h[5];
+    // 2.2 的压缩标志没有定义算法，整个标签无法解析
+    if (major < 2 || major > 4 || (major == 2 && (flags & 0x40)))
+        return;
+
+    uint32_t end = 10 + syncsafe(h + 6);
+    uint32_t size = src->getSize();
+    if (end > size)
+        end = size;
+    uint32_t pos = 10;
+
+    // 扩展头：2.3 的长度不含自身 4 字节，2.4 的含
+    if (major >= 3 && (flags & 0x40))
+    {
+        uint8_t e[4];
+        if (mp3ReadAt(src, pos, e, 4) != 4)
+            return;
+        pos += major == 3 ? 4 + be32(e) : syncsafe(e);
+    }
+
+    bool tagUnsync = major < 4 && (flags & 0x80);
+    int idLen = major == 2 ? 3 : 4;
+    uint32_t hdrLen = major == 2 ? 6 : 10;
+    uint32_t found = 0;
+
+    for (int i = 0; i < ID3_MAX_FRAMES && pos + hdrLen <= end && found != FIELD_ALL; i++)
+    {
+        uint8_t fh[10];
+        if (mp3ReadAt(src, pos, fh, hdrLen) != hdrLen || fh[0] == 0 || !validFrameId(fh, idLen))
+            break; // 到了填充区或标签损坏
+
+        uint32_t len;
+        uint8_t fmt = 0;
+        if (major == 2)
+        {
+            len = ((uint32_t)fh[3] << 16) | ((uint32_t)fh[4] << 8) | fh[5];
+        }
+        else
+        {
+            // 有的 2.4 写入工具把帧长写成普通整数；出现高位就按普通整数读
+            bool plain = major == 3 || ((fh[4] | fh[5] | fh[6] | fh[7]) & 0x80);
+            len = plain ? be32(fh + 4) : syncsafe(fh + 4);
+            fmt = fh[9];
+        }
+        pos += hdrLen;
+        if (len > end - pos)
+            break;
+
+        int field = lookupFrame(fh, major);
+        uint32_t skip = 0;
+        bool unsync = tagUnsync;
+        if (major == 3)
+        {
+            if (fmt & 0xC0) // 压缩 / 加密
+                field = -1;
+            skip += (fmt & 0x20) ? 1 : 0; // 分组标识
+        }
+        else if (major == 4)
+        {
+            if (fmt & 0x0C)
+                field = -1;
+            skip += (fmt & 0x40) ? 1 : 0;
+            skip += (fmt & 0x01) ? 4 : 0; // 数据长度指示
+            unsync = fmt & 0x02;
+        }
+
+        if (field >= 0 && len > skip)
+        {
+            uint32_t n = len - skip;
+            if (n > ID3_FRAME_READ_MAX)
+                n = ID3_FRAME_READ_MAX;
+            n = mp3ReadAt(src, pos + skip, buf, n);
+            if (unsync)
+                n = undoUnsync(buf, n);
+            storeField(field, buf, n, out, band);
+            found |= 1u << field;
+        }
+        pos += len;
+    }
+}
+
+// ======================
+// ID3v1 / v1.1
+// ======================
+static void putV1(const uint8_t *p, char *out, size_t cap)
+{
+    if (out[0])
+        return;
+    const uint8_t *z = (const uint8_t *)memchr(p, 0, 30);
+    Utf8Writer w = {out, cap, 0, false};
+    putLegacy(w, p, z ? (uint32_t)(z - p) : 30);
+    w.finish();
+}
+
+static void readV1(AudioFileSource *src, Id3Tags &out, uint8_t *buf)
+{
+    uint32_t size = src->getSize();
+    if (size < 128 || mp3ReadAt(src, size - 128, buf, 128) != 128 || memcmp(buf, "TAG", 3) != 0)
+        return;
+
+    putV1(buf + 3, out.title, sizeof(out.title));
+    putV1(buf + 33, out.artist, sizeof(out.artist));
+    putV1(buf + 63, out.album, sizeof(out.album));
+    // v1.1：注释第 29 字节为 0 时第 30 字节是音轨号
+    if (!out.trackNo && buf[125] == 0 && buf[126] != 0)
+        out.trackNo = buf[126];
+}
+
+bool id3ReadTags(AudioFileSource *src, Id3Tags &out)
+{
+    memset(&out, 0, sizeof(out));
+    uint8_t *buf = (uint8_t *)malloc(ID3_FRAME_READ_MAX);
+    if (!buf)
+        return false;
+
+    char band[ID3_ARTIST_MAX] = "";
+    readV2(src, out, band, buf);
+    if (!out.artist[0] && band[0])
+        memcpy(out.artist, band, sizeof(out.artist));
+    readV1(src, out, buf);
+    free(buf);
+
+    return out.title[0] || out.artist[0] || out.album[0] || out.trackNo;
+}
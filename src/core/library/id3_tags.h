@@ -0,0 +1,23 @@
+#pragma once
+#include <stdint.h>
+#include <AudioFileSource.h>
+
+// 各文本字段的容量（UTF-8，含 '\0'）；超长时在字符边界截断
+#define ID3_TITLE_MAX 96
+#define ID3_ARTIST_MAX 64
+#define ID3_ALBUM_MAX 64
+
+struct Id3Tags
+{
+    char title[ID3_TITLE_MAX];
+    char artist[ID3_ARTIST_MAX];
+    char album[ID3_ALBUM_MAX];
+    uint16_t trackNo; // 0 表示没有
+    uint32_t lengthMs; // TLEN，0 表示没有
+};
+
+// 流式解析文件开头的 ID3v2（2.2/2.3/2.4）：只读标签头和需要的文本帧，
+// 其余帧（封面等）按帧头跳过，不整块读入。没有的字段用 ID3v1（文件末尾 128 字节）补齐。
+// 文本统一转成 UTF-8；声明为 Latin-1 但实际是 GBK 等本地编码的文本无法可靠转换，按没有处理。
+// 找到任一字段返回 true；返回后 src 的读写位置未定义
+bool id3ReadTags(AudioFileSource *src, Id3Tags &out);
@@ -0,0 +1,760 @@
+#include "core/library/library.h"
+#include "core/library/library_index.h"
+#include "core/library/id3_tags.h"
+#include "core/audio/track_open.h"
+#include "log.h"
+#include <SD.h>
+#include <AudioFileSourceSD.h>
+#include <esp_heap_caps.h>
+
+#define LIBRARY_TASK_STACK 8192
+#define LIBRARY_BOOT_RESCAN_DELAY_MS 3000
+// 每处理这么多目录项让出一次 CPU，保证 core 0 的 idle 任务能喂狗
+#define LIBRARY_YIELD_EVERY 16
+// 读元数据时每补齐这么多首存一次索引，中途断电不至于全部重来
+#define LIBRARY_META_SAVE_EVERY 500
+// 没有 PSRAM 时，内部 RAM 低于这个值就不再保存文本字段（只记时长），列表回退到文件名
+#define LIBRARY_META_MIN_FREE_HEAP (64 * 1024)
+// arena 重打包后旧块再留这么久：UI 可能还在用上一帧取到的标题指针
+#define LIBRARY_REPACK_GRACE_MS 500
+
+// TrackRecord::mark 的取值
+#define MARK_SEEN 0x01
+#define MARK_DEAD 0x02
+
+// 播放列表 = 句柄数组，索引即列表序号
+static TrackHandle *g_order = nullptr;
+static int g_count = 0;
+static int g_orderCap = 0;
+
+static uint32_t g_rootFingerprint = 0;
+static volatile uint32_t g_generation = 0;
+
+// 写者只有一个（开机流程或后台任务），锁只用来挡住其它任务的读取
+static SemaphoreHandle_t g_lock = nullptr;
+static TaskHandle_t g_task = nullptr;
+static volatile RescanMode g_requestMode = RescanMode::SHALLOW;
+static volatile bool g_rescanPending = false;
+
+// 开机时决定后台任务第一轮做什么
+static bool g_needColdScan = false;
+static bool g_rootChanged = false;
+
+// 扫描进度，UI 每帧读取
+static volatile bool g_scanning = false;
+static volatile bool g_coldScanning = false;
+static volatile int g_progressDirs = 0;
+static volatile int g_progressDirsKnown = 0;
+
+// 扫描时拼子目录路径用；只有写者会用到
+static char g_scratchPath[LIBRARY_MAX_PATH_LEN];
+
+static inline void lock() { xSemaphoreTake(g_lock, portMAX_DELAY); }
+static inline void unlock() { xSemaphoreGive(g_lock); }
+
+// 扫描只在后台低优先级任务里跑，定期让出 CPU 即可
+static void scanYield()
+{
+    static uint32_t n = 0;
+    if (++n % LIBRARY_YIELD_EVERY == 0)
+        vTaskDelay(1);
+}
+
+static inline void noteDirListed(RescanStats &st)
+{
+    st.dirsListed++;
+    g_progressDirs = st.dirsListed;
+}
+
+// --- 播放列表 ---
+static bool orderReserve(int n)
+{
+    if (n <= g_orderCap)
+        return true;
+    int cap = g_orderCap ? g_orderCap * 2 : 256;
+    while (cap < n)
+        cap *= 2;
+    size_t bytes = cap * sizeof(TrackHandle);
+
+    // realloc 可能释放旧数组，必须挡住读者
+    lock();
+    TrackHandle *t = (TrackHandle *)(psramFound() ? heap_caps_realloc(g_order, bytes, MALLOC_CAP_SPIRAM)
+                                                  : realloc(g_order, bytes));
+    if (t)
+    {
+        g_order = t;
+        g_orderCap = cap;
+    }
+    unlock();
+    return t != nullptr;
+}
+
+static bool appendTrack(TrackHandle h)
+{
+    if (g_count >= LIBRARY_MAX_TRACKS || !orderReserve(g_count + 1))
+        return false;
+
+    lock();
+    g_order[g_count++] = h;
+    unlock();
+    return true;
+}
+
+// 整棵子树标记为已见（沿子目录链表走，只碰这棵树自己的目录）
+static void markSubtreeSeen(DirId dirId)
+{
+    DirRecord *d = pathStoreDir(dirId);
+    d->seen = 1;
+    for (DirId c = d->firstChild; c != PATH_STORE_INVALID_DIR; c = pathStoreDir(c)->nextSibling)
+    {
+        if (!pathStoreDir(c)->dead)
+            markSubtreeSeen(c);
+    }
+}
+
+// --- 扫描 ---
+static void rescanDir(DirId dir, RescanMode mode, RescanStats &st);
+
+// 完整列出一个目录：更新/追加曲目，递归子目录，标记已消失的曲目
+static void processDir(DirId dirId, RescanMode mode, RescanStats &st)
+{
+    // arena 中的目录路径不会搬移，递归期间一直有效
+    const char *path = pathStoreDirPath(dirId);
+    File dir = SD.open(path);
+    if (!dir || !dir.isDirectory())
+        return;
+
+    noteDirListed(st);
+    st.dirsChanged++;
+
+    // 只走本目录自己的曲目链表，开销跟本目录条目数成正比
+    for (TrackHandle h = pathStoreDir(dirId)->firstTrack; h != PATH_STORE_INVALID_HANDLE;)
+    {
+        TrackRecord *r = pathStoreTrack(h);
+        r->mark &= ~MARK_SEEN;
+        h = r->nextInDir;
+    }
+
+    DirFingerprint fp;
+    fp.reset();
+
+    while (true)
+    {
+        File entry = dir.openNextFile();
+        if (!entry)
+            break;
+
+        scanYield();
+
+        const char *name = entry.name();
+        if (name[0] == '.')
+        {
+            // 隐藏文件/目录（含索引目录）一律跳过
+            entry.close();
+            continue;
+        }
+
+        fp.add(entry);
+
+        if (entry.isDirectory())
+        {
+            // name 指向 entry 内部，关闭前先拼好路径
+            int n = snprintf(g_scratchPath, sizeof(g_scratchPath), "%s/%s", strlen(path) > 1 ? path : "", name);
+            entry.close();
+            if (n <= 0 || n >= (int)sizeof(g_scratchPath))
+                continue;
+
+            DirId child = pathStoreFindDir(g_scratchPath);
+            if (child == PATH_STORE_INVALID_DIR)
+            {
+                lock();
+                child = pathStoreInternDir(g_scratchPath);
+                unlock();
+            }
+            if (child != PATH_STORE_INVALID_DIR)
+                rescanDir(child, mode, st);
+            continue;
+        }
+
+        AudioFormat fmt = audioFormatFromName(name);
+        if (fmt != AudioFormat::UNKNOWN)
+        {
+            uint32_t size = entry.size();
+            uint32_t mtime = (uint32_t)entry.getLastWrite();
+
+            TrackHandle h = pathStoreFindTrack(dirId, name);
+            TrackRecord *r = pathStoreTrack(h);
+            if (r)
+            {
+                r->mark |= MARK_SEEN;
+                if (r->size != size || r->mtime != mtime)
+                {
+                    // 文件被改过：标签可能也变了，清掉元数据等下一轮重读
+                    lock();
+                    r->size = size;
+                    r->mtime = mtime;
+                    r->flags &= ~TRACK_FLAGS_META_MASK;
+                    pathStoreSetMeta(h, "", "", "", 0, 0);
+                    unlock();
+                }
+            }
+            else if (g_count < LIBRARY_MAX_TRACKS)
+            {
+                lock();
+                h = pathStoreAddTrack(dirId, name, size, mtime, (uint8_t)fmt);
+                unlock();
+                r = pathStoreTrack(h);
+                if (r && appendTrack(h))
+                {
+                    r->mark = MARK_SEEN;
+                    st.added++;
+                }
+            }
+        }
+        entry.close();
+    }
+    dir.close();
+
+    for (TrackHandle h = pathStoreDir(dirId)->firstTrack; h != PATH_STORE_INVALID_HANDLE;)
+    {
+        TrackRecord *r = pathStoreTrack(h);
+        if (!(r->mark & MARK_SEEN))
+            r->mark |= MARK_DEAD;
+        h = r->nextInDir;
+    }
+
+    DirRecord *d = pathStoreDir(dirId);
+    d->fingerprint = fp.value();
+    d->seen = 1;
+    d->dead = 0;
+}
+
+static void rescanDir(DirId dirId, RescanMode mode, RescanStats &st)
+{
+    DirRecord *d = pathStoreDir(dirId);
+    if (d->dead || d->fingerprint == 0)
+    {
+        // 新目录或之前被删除的目录：直接完整处理
+        processDir(dirId, mode, st);
+        return;
+    }
+
+    uint32_t fp = libraryIndexDirFingerprint(pathStoreDirPath(dirId));
+    noteDirListed(st);
+    if (fp == 0 || fp != d->fingerprint)
+    {
+        processDir(dirId, mode, st);
+        return;
+    }
+
+    if (mode == RescanMode::SHALLOW)
+    {
+        // 指纹未变：整棵子树视为未变化（更深层的增删只有 DEEP 能发现）
+        markSubtreeSeen(dirId);
+        return;
+    }
+
+    // DEEP：本层不用再处理，但子目录逐个校验（子目录取自本目录的子目录链表，
+    // 本层指纹未变说明没有增删子目录）。递归可能登记新目录、目录表会搬家，
+    // 所以每次按 id 重新取记录，不跨调用持有指针
+    d->seen = 1;
+    for (DirId c = d->firstChild; c != PATH_STORE_INVALID_DIR; c = pathStoreDir(c)->nextSibling)
+    {
+        if (!pathStoreDir(c)->dead)
+            rescanDir(c, mode, st);
+    }
+}
+
+// 删除标记为 dead 或所在目录已消失的曲目，保持剩余曲目的相对顺序
+static int compact()
+{
+    uint32_t dirCount = pathStoreDirCount();
+    for (uint32_t i = 0; i < dirCount; i++)
+    {
+        DirRecord *d = pathStoreDir((DirId)i);
+        if (!d->seen)
+            d->dead = 1;
+    }
+
+    lock();
+    int w = 0;
+    for (int r = 0; r < g_count; r++)
+    {
+        TrackHandle h = g_order[r];
+        TrackRecord *rec = pathStoreTrack(h);
+        if (!rec || (rec->mark & MARK_DEAD) || pathStoreDir(rec->dir)->dead)
+        {
+            pathStoreRemoveTrack(h);
+            continue;
+        }
+        g_order[w++] = h;
+    }
+    int removed = g_count - w;
+    g_count = w;
+    unlock();
+    return removed;
+}
+
+static void logStoreUsage(const char *what)
+{
+    LOG_LIB("%s: %d tracks, %lu dirs, store %lu bytes (%s)", what, g_count,
+            (unsigned long)pathStoreDirCount(),
+            (unsigned long)(pathStoreBytesUsed() + g_orderCap * sizeof(TrackHandle)),
+            pathStoreInPsram() ? "psram" : "dram");
+}
+
+RescanStats libraryRescan(RescanMode mode)
+{
+    RescanStats st = {};
+    if (SD.cardType() == CARD_NONE)
+        return st;
+
+    uint32_t t0 = millis();
+    uint32_t dirCount = pathStoreDirCount();
+    g_progressDirs = 0;
+    g_progressDirsKnown = dirCount;
+    for (uint32_t i = 0; i < dirCount; i++)
+        pathStoreDir((DirId)i)->seen = 0;
+    for (int i = 0; i < g_count; i++)
+    {
+        TrackRecord *r = pathStoreTrack(g_order[i]);
+        if (r)
+            r->mark = 0;
+    }
+
+    lock();
+    DirId root = pathStoreInternDir("/");
+    unlock();
+    rescanDir(root, mode, st);
+    st.removed = compact();
+    st.elapsedMs = millis() - t0;
+    g_rootFingerprint = pathStoreDir(root)->fingerprint;
+
+    // 删除和改动留下的 arena 字节攒多了就搬一次
+    size_t wasted = pathStoreWastedBytes();
+    lock();
+    bool repacked = pathStoreRepack();
+    unlock();
+    if (repacked)
+    {
+        LOG_LIB("rescan: repacked path store, %lu bytes reclaimed", (unsigned long)wasted);
+        vTaskDelay(pdMS_TO_TICKS(LIBRARY_REPACK_GRACE_MS));
+        lock();
+        pathStoreReleaseRetired();
+        unlock();
+    }
+
+    if (st.added || st.removed || st.dirsChanged)
+    {
+        g_generation++;
+        libraryIndexSave(g_rootFingerprint);
+        logStoreUsage("rescan");
+    }
+
+    LOG_LIB("rescan(%s): +%d -%d, %d dirs listed, %d changed, %lu ms",
+            mode == RescanMode::DEEP ? "deep" : "shallow",
+            st.added, st.removed, st.dirsListed, st.dirsChanged, (unsigned long)st.elapsedMs);
+    return st;
+}
+
+// --- 元数据 ---
+// 没有 PSRAM 时文本字段和路径挤在内部 RAM 里，余量不够就只记时长
+static bool metaTextFits()
+{
+    return pathStoreInPsram() || heap_caps_get_free_size(MALLOC_CAP_INTERNAL) >= LIBRARY_META_MIN_FREE_HEAP;
+}
+
+// 读一首的标签和时长；文件打不开时返回 false，下一轮再试
+static bool readTrackMeta(TrackHandle h, bool keepText)
+{
+    TrackRecord *r = pathStoreTrack(h);
+    if (!r || !pathStoreJoin(h, g_scratchPath, sizeof(g_scratchPath)))
+        return false;
+
+    AudioFileSourceSD src(g_scratchPath);
+    if (!src.isOpen())
+        return false;
+    Id3Tags tags;
+    bool tagged = id3ReadTags(&src, tags) && keepText;
+    TrackLayout layout;
+    uint32_t durationMs = trackProbeDurationMs(&src, (AudioFormat)(r->flags & TRACK_FLAGS_FORMAT_MASK), &layout);
+    bool hasLayout = durationMs != 0;
+    src.close();
+    if (!durationMs)
+        durationMs = tags.lengthMs;
+
+    lock();
+    bool ok = tagged ? pathStoreSetMeta(h, tags.title, tags.artist, tags.album, durationMs, tags.trackNo)
+                     : pathStoreSetMeta(h, "", "", "", durationMs, tags.trackNo);
+    if (ok)
+    {
+        r->flags |= TRACK_FLAG_META;
+        if (hasLayout)
+        {
+            r->streamStart = layout.start;
+            r->flags |= TRACK_FLAG_LAYOUT | (layout.end < r->size ? TRACK_FLAG_ID3V1 : 0);
+        }
+    }
+    unlock();
+    return ok;
+}
+
+// 给还没有元数据的曲目逐个补齐（列表先按文件名出现，这里不挡 UI 和播放）；
+// 有重扫请求时中途让出，重扫完再继续
+static void fillMetadata()
+{
+    uint32_t t0 = millis();
+    int done = 0;
+    int failed = 0;
+    bool lowMem = false;
+
+    for (int i = 0; i < g_count && !g_rescanPending; i++)
+    {
+        TrackHandle h = g_order[i];
+        const TrackRecord *r = pathStoreTrack(h);
+        if (!r || (r->flags & TRACK_FLAG_META))
+            continue;
+
+        bool keepText = metaTextFits();
+        if (!keepText && !lowMem)
+        {
+            lowMem = true;
+            LOG_LIB("meta: low memory, keeping file names from track %d", i);
+        }
+        if (readTrackMeta(h, keepText))
+            done++;
+        else
+            failed++;
+
+        if (done && done % LIBRARY_META_SAVE_EVERY == 0)
+            libraryIndexSave(g_rootFingerprint);
+        vTaskDelay(1);
+    }
+
+    if (done || failed)
+    {
+        if (done)
+            libraryIndexSave(g_rootFingerprint);
+        LOG_LIB("meta: %d tracks read, %d failed, %lu ms%s", done, failed,
+                (unsigned long)(millis() - t0), g_rescanPending ? " (interrupted)" : "");
+    }
+}
+
+// --- 启动 ---
+static bool loadTrack(TrackHandle h)
+{
+    return appendTrack(h);
+}
+
+static void resetStore()
+{
+    lock();
+    pathStoreReset();
+    g_count = 0;
+    unlock();
+}
+
+void libraryInit()
+{
+    if (!g_lock)
+        g_lock = xSemaphoreCreateMutex();
+    resetStore();
+}
+
+bool libraryLoad()
+{
+    resetStore();
+    g_needColdScan = false;
+    g_rootChanged = false;
+    if (SD.cardType() == CARD_NONE)
+        return false;
+
+    uint32_t t0 = millis();
+    uint32_t fp = libraryIndexDirFingerprint("/");
+    uint32_t tFp = millis() - t0;
+
+    uint32_t storedFp = 0;
+    if (libraryIndexLoad(&storedFp, loadTrack, metaTextFits()))
+    {
+        g_rootFingerprint = storedFp;
+        g_rootChanged = fp != storedFp;
+        LOG_LIB("boot: index load %d tracks in %lu ms (fingerprint %lu ms)%s",
+                g_count, (unsigned long)(millis() - t0), (unsigned long)tFp,
+                g_rootChanged ? ", root changed" : "");
+        logStoreUsage("boot");
+        return true;
+    }
+
+    // 索引不可用：清空后交给后台任务全量扫描，曲目边扫边出现在列表里
+    resetStore();
+    g_needColdScan = true;
+    g_scanning = true;
+    g_coldScanning = true;
+    return true;
+}
+
+// 全量扫描：列表从空开始逐条追加，UI 和播放不必等待
+static void coldScan()
+{
+    g_coldScanning = true;
+    g_progressDirs = 0;
+    g_progressDirsKnown = 0;
+
+    uint32_t t0 = millis();
+    RescanStats st = {};
+    lock();
+    DirId root = pathStoreInternDir("/");
+    unlock();
+    processDir(root, RescanMode::DEEP, st);
+    uint32_t tScan = millis() - t0;
+    g_rootFingerprint = pathStoreDir(root)->fingerprint;
+    g_coldScanning = false;
+    g_generation++;
+
+    uint32_t t1 = millis();
+    libraryIndexSave(g_rootFingerprint);
+    LOG_LIB("boot: cold scan %d tracks in %lu ms, index write %lu ms",
+            g_count, (unsigned long)tScan, (unsigned long)(millis() - t1));
+    logStoreUsage("boot");
+}
+
+// --- 后台任务 ---
+static void libraryTask(void *)
+{
+    g_scanning = true;
+    if (g_needColdScan)
+    {
+        coldScan();
+    }
+    else
+    {
+        // 根目录变了先立刻做一次浅层重扫；完整校验延后，先让出 SD 和 CPU 给首曲播放
+        if (g_rootChanged)
+            libraryRescan(RescanMode::SHALLOW);
+        g_scanning = false;
+        vTaskDelay(pdMS_TO_TICKS(LIBRARY_BOOT_RESCAN_DELAY_MS));
+        g_scanning = true;
+        libraryRescan(RescanMode::DEEP);
+    }
+    g_scanning = false;
+    fillMetadata();
+
+    while (true)
+    {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+        g_rescanPending = false;
+        g_scanning = true;
+        libraryRescan(g_requestMode);
+        g_scanning = false;
+        fillMetadata();
+    }
+}
+
+void libraryStartBackgroundTask()
+{
+    if (g_task || SD.cardType() == CARD_NONE)
+        return;
+    xTaskCreatePinnedToCore(libraryTask, "Library", LIBRARY_TASK_STACK, NULL, 1, &g_task, 0);
+}
+
+void libraryRequestRescan(RescanMode mode)
+{
+    g_requestMode = mode;
+    g_rescanPending = true;
+    if (g_task)
+        xTaskNotifyGive(g_task);
+}
+
+bool libraryIsScanning() { return g_scanning; }
+
+LibraryScanProgress libraryGetScanProgress()
+{
+    LibraryScanProgress p;
+    p.active = g_scanning;
+    p.cold = g_coldScanning;
+    p.dirsDone = g_progressDirs;
+    p.dirsKnown = g_progressDirsKnown;
+    p.tracks = g_count;
+    return p;
+}
+uint32_t libraryGetGeneration() { return g_generation; }
+
+// --- 查询 ---
+int libraryGetCount() { return g_count; }
+
+TrackHandle libraryGetHandle(int index)
+{
+    if (index < 0 || index >= g_count)
+        return PATH_STORE_INVALID_HANDLE;
+    return g_order[index];
+}
+
+bool libraryCopyPath(int index, char *buf, size_t len)
+{
+    if (!buf || len == 0)
+        return false;
+
+    lock();
+    bool ok = index >= 0 && index < g_count && pathStoreJoin(g_order[index], buf, len);
+    unlock();
+    if (!ok)
+        buf[0] = '\0';
+    return ok;
+}
+
+const char *libraryGetLeafName(int index)
+{
+    lock();
+    const char *leaf = (index >= 0 && index < g_count) ? pathStoreLeaf(g_order[index]) : "";
+    unlock();
+    return leaf;
+}
+
+AudioFormat libraryGetFormat(int index)
+{
+    lock();
+    TrackRecord *r = (index >= 0 && index < g_count) ? pathStoreTrack(g_order[index]) : nullptr;
+    AudioFormat fmt = r ? (AudioFormat)(r->flags & TRACK_FLAGS_FORMAT_MASK) : AudioFormat::UNKNOWN;
+    unlock();
+    return fmt;
+}
+
+bool libraryGetLayout(int index, TrackLayout &out)
+{
+    lock();
+    TrackRecord *r = (index >= 0 && index < g_count) ? pathStoreTrack(g_order[index]) : nullptr;
+    bool ok = r && (r->flags & TRACK_FLAG_LAYOUT);
+    if (ok)
+    {
+        out.start = r->streamStart;
+        out.end = (r->flags & TRACK_FLAG_ID3V1) ? r->size - 128 : r->size;
+    }
+    unlock();
+    return ok;
+}
+
+// 调用方持锁
+static bool metaView(int index, TrackMetaView &out)
+{
+    TrackRecord *r = (index >= 0 && index < g_count) ? pathStoreTrack(g_order[index]) : nullptr;
+    if (!r || !(r->flags & TRACK_FLAG_META))
+        return false;
+    const char *text = pathStoreMeta(g_order[index]);
+    out.title = text ? text : "";
+    out.artist = text ? out.title + strlen(out.title) + 1 : "";
+    out.album = text ? out.artist + strlen(out.artist) + 1 : "";
+    out.trackNo = r->trackNo;
+    out.durationMs = r->durationMs;
+    return true;
+}
+
+bool libraryGetMeta(int index, TrackMetaView &out)
+{
+    lock();
+    bool ok = metaView(index, out);
+    unlock();
+    return ok;
+}
+
+const char *libraryGetDisplayName(int index)
+{
+    TrackMetaView m;
+    lock();
+    const char *name = metaView(index, m) && m.title[0] ? m.title
+                       : (index >= 0 && index < g_count) ? pathStoreLeaf(g_order[index])
+                                                         : "";
+    unlock();
+    return name;
+}
+
+// 按 UTF-8 字符边界截断追加
+static size_t appendUtf8(char *buf, size_t len, size_t pos, const char *s)
+{
+    size_t n = strlen(s);
+    if (pos + n >= len)
+    {
+        n = len - 1 - pos;
+        while (n > 0 && ((uint8_t)s[n] & 0xC0) == 0x80)
+            n--;
+    }
+    memcpy(buf + pos, s, n);
+    buf[pos + n] = '\0';
+    return pos + n;
+}
+
+bool libraryCopyTitle(int index, char *buf, size_t len)
+{
+    if (!buf || len == 0)
+        return false;
+    buf[0] = '\0';
+
+    TrackMetaView m;
+    lock();
+    bool ok = index >= 0 && index < g_count;
+    if (ok)
+    {
+        size_t pos = 0;
+        const char *title = pathStoreLeaf(g_order[index]);
+        if (metaView(index, m))
+        {
+            if (m.title[0])
+                title = m.title;
+            if (m.artist[0])
+            {
+                pos = appendUtf8(buf, len, pos, m.artist);
+                pos = appendUtf8(buf, len, pos, " - ");
+            }
+        }
+        appendUtf8(buf, len, pos, title);
+    }
+    unlock();
+    return ok;
+}
+
+// 调用方持锁；hint 命中时不用扫整个列表
+static int indexOf(TrackHandle h, int hint)
+{
+    if (h == PATH_STORE_INVALID_HANDLE)
+        return -1;
+    if (hint >= 0 && hint < g_count && g_order[hint] == h)
+        return hint;
+    for (int i = 0; i < g_count; i++)
+    {
+        if (g_order[i] == h)
+            return i;
+    }
+    return -1;
+}
+
+int libraryFindPath(const char *path)
+{
+    lock();
+    int idx = indexOf(pathStoreFindPath(path), -1);
+    unlock();
+    return idx;
+}
+
+int libraryFindHandle(TrackHandle h, int hint)
+{
+    lock();
+    int idx = indexOf(h, hint);
+    unlock();
+    return idx;
+}
+
+bool libraryGetTrackToOpen(TrackHandle h, TrackToOpen &out, char *path, size_t len)
+{
+    lock();
+    out.index = indexOf(h, out.index);
+    const TrackRecord *r = out.index >= 0 ? pathStoreTrack(h) : nullptr;
+    bool ok = r && pathStoreJoin(h, path, len);
+    if (ok)
+    {
+        out.format = (AudioFormat)(r->flags & TRACK_FLAGS_FORMAT_MASK);
+        out.hasLayout = (r->flags & TRACK_FLAG_LAYOUT) != 0;
+        out.layout.start = r->streamStart;
+        out.layout.end = (r->flags & TRACK_FLAG_ID3V1) ? r->size - 128 : r->size;
+    }
+    unlock();
+    return ok;
+}
@@ -0,0 +1,118 @@
+#pragma once
+#include <Arduino.h>
+#include "core/library/path_store.h"
+#include "core/audio/audio_format.h"
+
+// 曲目数只受内存限制；这里是防止异常卡片把堆吃光的软上限
+#define LIBRARY_MAX_TRACKS 20000
+// 拼接完整路径时调用方缓冲区的大小（FAT 长文件名 UTF-8 后可能很长）
+#define LIBRARY_MAX_PATH_LEN 512
+
+// 索引文件放在隐藏目录里，扫描时会跳过以 "." 开头的条目
+#define LIBRARY_INDEX_DIR "/.synthcard"
+#define LIBRARY_INDEX_PATH "/.synthcard/library.idx"
+
+// 曲目标记（写入索引）：低 3 位为 AudioFormat
+#define TRACK_FLAGS_FORMAT_MASK 0x07
+// 已读过标签和时长（文本字段可能为空）；文件大小或修改时间变了就清掉重读
+#define TRACK_FLAG_META 0x08
+// 读标签时一并记下了流范围（TrackRecord::streamStart；末尾有 ID3v1 时另带 TRACK_FLAG_ID3V1），与 META 同时清掉
+#define TRACK_FLAG_LAYOUT 0x10
+#define TRACK_FLAG_ID3V1 0x20
+#define TRACK_FLAGS_META_MASK (TRACK_FLAG_META | TRACK_FLAG_LAYOUT | TRACK_FLAG_ID3V1)
+
+struct TrackInfo
+{
+    uint32_t size;
+    uint32_t mtime;
+    uint8_t flags;
+};
+
+// 增量重扫模式
+enum class RescanMode
+{
+    SHALLOW, // 目录指纹不变时整棵子树跳过：只能发现上一层目录看得到的变化（开机根目录变化时的快速预扫）
+    DEEP     // 每个目录都列一遍，只重新处理指纹变化的目录（开机后台校验、按键触发）
+};
+
+// 曲目元数据：字符串指向 arena（重扫后 arena 可能重打包，指针至少在一帧绘制内有效）；没有的字段为 ""
+struct TrackMetaView
+{
+    const char *title;
+    const char *artist;
+    const char *album;
+    uint16_t trackNo;    // 0 表示没有
+    uint32_t durationMs; // 0 表示未知
+};
+
+// 打开一首曲目要用到的信息，libraryGetTrackToOpen() 一次取齐
+struct TrackToOpen
+{
+    int index; // 调用时为序号提示，返回当前序号
+    AudioFormat format;
+    bool hasLayout;
+    TrackLayout layout;
+};
+
+struct RescanStats
+{
+    int added;
+    int removed;
+    int dirsListed;
+    int dirsChanged;
+    uint32_t elapsedMs;
+};
+
+struct LibraryScanProgress
+{
+    bool active;
+    bool cold;     // 全量扫描中（总目录数未知）
+    int dirsDone;
+    int dirsKnown; // 增量重扫时为已知目录数，全量扫描时为 0
+    int tracks;
+};
+
+void libraryInit();
+
+// 启动加载：只读取 SD 卡上的索引，不做目录遍历。
+// 索引缺失或损坏时列表为空，由后台任务全量扫描并逐条填充；
+// 根目录指纹变化时后台任务先做一次浅层增量重扫
+bool libraryLoad();
+
+// 增量重扫：只进入指纹变化的目录，结果合并到现有列表（新曲目追加在末尾）
+RescanStats libraryRescan(RescanMode mode);
+
+// 后台任务（低优先级）：开机时按 libraryLoad() 的结果做全量扫描或增量校验，
+// 之后等待 libraryRequestRescan()。每轮扫描后给还没有元数据的曲目读标签和时长，
+// 结果写进索引，之后开机不再重复解析
+void libraryStartBackgroundTask();
+void libraryRequestRescan(RescanMode mode);
+bool libraryIsScanning();
+LibraryScanProgress libraryGetScanProgress();
+
+// 列表内容每次被重扫改动后递增，调用方据此重新定位当前曲目
+uint32_t libraryGetGeneration();
+
+int libraryGetCount();
+TrackHandle libraryGetHandle(int index);
+
+// 跨任务读取用：内部加锁，不分配内存
+bool libraryCopyPath(int index, char *buf, size_t len);
+// 返回文件名指针，指向 arena；同上，只在当次使用，不要长期保存
+const char *libraryGetLeafName(int index);
+// 扫描时按扩展名记下的格式
+AudioFormat libraryGetFormat(int index);
+// 读标签时记下的流范围，交给 trackOpen() 跳过标签；还没读过时返回 false
+bool libraryGetLayout(int index, TrackLayout &out);
+// 元数据还没读到时返回 false
+bool libraryGetMeta(int index, TrackMetaView &out);
+// 列表显示名：有标题用标题，否则用文件名；指针只在当次使用（绘制一帧）
+const char *libraryGetDisplayName(int index);
+// 播放界面标题："艺术家 - 标题"，没有艺术家时省掉前缀，没有标题时用文件名；按 UTF-8 字符边界截断
+bool libraryCopyTitle(int index, char *buf, size_t len);
+int libraryFindPath(const char *path);
+// 重扫压缩列表后序号会变、句柄不变：跨任务排队的请求带句柄，用时再换成当前序号。
+// hint 是调用方记得的序号，没变时不扫列表；曲目已被删除时返回 -1
+int libraryFindHandle(TrackHandle h, int hint = -1);
+// 序号、路径、格式和流范围在同一次加锁里取出，中途不会被重扫改动；曲目已被删除时返回 false
+bool libraryGetTrackToOpen(TrackHandle h, TrackToOpen &out, char *path, size_t len);
@@ -0,0 +1,403 @@
+#include "core/library/library_index.h"
+#include "log.h"
+#include <SD.h>
+
+#define INDEX_IO_CHUNK 2048
+#define INDEX_TMP_PATH "/.synthcard/library.tmp"
+
+// ======================
+// CRC32（半字节查表，表只有 64 字节）
+// ======================
+static const uint32_t kCrcNibble[16] = {
+    0x00000000, 0x1DB71064, 0x3B6E20C8, 0x26D930AC,
+    0x76DC4190, 0x6B6B51F4, 0x4DB26158, 0x5005713C,
+    0xEDB88320, 0xF00F9344, 0xD6D6A3E8, 0xCB61B38C,
+    0x9B64C2B0, 0x86D3D2D4, 0xA00AE278, 0xBDBDF21C};
+
+static uint32_t crc32Update(uint32_t crc, const uint8_t *p, size_t n)
+{
+    while (n--)
+    {
+        crc ^= *p++;
+        crc = (crc >> 4) ^ kCrcNibble[crc & 0x0F];
+        crc = (crc >> 4) ^ kCrcNibble[crc & 0x0F];
+    }
+    return crc;
+}
+
+// FNV-1a，用于目录指纹里的文件名
+static uint32_t hashName(const char *s)
+{
+    uint32_t h = 2166136261u;
+    while (*s)
+    {
+        h ^= (uint8_t)*s++;
+        h *= 16777619u;
+    }
+    return h;
+}
+
+void DirFingerprint::add(File &entry)
+{
+    // 顺序无关的混合：求和，避免 FAT 目录顺序变化误判
+    uint32_t h = hashName(entry.name());
+    if (!entry.isDirectory())
+        h ^= (uint32_t)entry.size() * 2654435761u;
+    h ^= (uint32_t)entry.getLastWrite();
+    mix += h;
+    count++;
+}
+
+uint32_t libraryIndexDirFingerprint(const char *path)
+{
+    File dir = SD.open(path);
+    if (!dir || !dir.isDirectory())
+        return 0;
+
+    DirFingerprint fp;
+    fp.reset();
+    while (true)
+    {
+        File entry = dir.openNextFile();
+        if (!entry)
+            break;
+        if (entry.name()[0] != '.')
+            fp.add(entry);
+        entry.close();
+    }
+    dir.close();
+    return fp.value();
+}
+
+// ======================
+// 加载
+// ======================
+struct ChunkReader
+{
+    File *file;
+    uint8_t *buf;
+    size_t len;
+    size_t pos;
+    uint32_t remaining; // payload 中还未读进 buf 的字节数
+    uint32_t crc;
+
+    bool read(void *dst, size_t n)
+    {
+        uint8_t *out = (uint8_t *)dst;
+        while (n > 0)
+        {
+            if (pos == len)
+            {
+                if (remaining == 0)
+                    return false;
+                size_t want = remaining < INDEX_IO_CHUNK ? remaining : INDEX_IO_CHUNK;
+                len = file->read(buf, want);
+                if (len == 0)
+                    return false;
+                crc = crc32Update(crc, buf, len);
+                remaining -= len;
+                pos = 0;
+            }
+            size_t take = len - pos;
+            if (take > n)
+                take = n;
+            memcpy(out, buf + pos, take);
+            pos += take;
+            out += take;
+            n -= take;
+        }
+        return true;
+    }
+};
+
+// meta 应恰好是三段以 '\0' 结尾的字符串
+static bool metaWellFormed(const char *meta, uint16_t len)
+{
+    int fields = 0;
+    for (uint16_t i = 0; i < len; i++)
+    {
+        if (meta[i] == '\0')
+            fields++;
+    }
+    return len == 0 || (fields == 3 && meta[len - 1] == '\0');
+}
+
+bool libraryIndexLoad(uint32_t *rootFingerprint, LibraryIndexTrackSink trackSink, bool keepMetaText)
+{
+    File f = SD.open(LIBRARY_INDEX_PATH, FILE_READ);
+    if (!f)
+    {
+        LOG_LIB("index missing");
+        return false;
+    }
+
+    LibraryIndexHeader hdr;
+    if (f.read((uint8_t *)&hdr, sizeof(hdr)) != sizeof(hdr) ||
+        hdr.magic != LIBRARY_INDEX_MAGIC ||
+        hdr.version != LIBRARY_INDEX_VERSION ||
+        hdr.headerSize != sizeof(hdr) ||
+        hdr.dirCount > PATH_STORE_MAX_DIRS ||
+        f.size() != sizeof(hdr) + hdr.payloadBytes)
+    {
+        LOG_LIB("index header invalid");
+        f.close();
+        return false;
+    }
+
+    uint8_t *buf = (uint8_t *)malloc(INDEX_IO_CHUNK);
+    char *path = (char *)malloc(LIBRARY_MAX_PATH_LEN);
+    // 文件里的目录序号 -> 仓库里的 DirId
+    DirId *dirMap = (DirId *)malloc((hdr.dirCount ? hdr.dirCount : 1) * sizeof(DirId));
+    if (!buf || !path || !dirMap)
+    {
+        free(buf);
+        free(path);
+        free(dirMap);
+        f.close();
+        return false;
+    }
+
+    ChunkReader rd = {&f, buf, 0, 0, hdr.payloadBytes, 0xFFFFFFFFu};
+    bool ok = true;
+
+    for (uint32_t i = 0; i < hdr.dirCount && ok; i++)
+    {
+        uint32_t fp = 0;
+        uint16_t pathLen = 0;
+        ok = rd.read(&fp, 4) && rd.read(&pathLen, 2) &&
+             pathLen < LIBRARY_MAX_PATH_LEN && rd.read(path, pathLen);
+        if (!ok)
+            break;
+        path[pathLen] = '\0';
+
+        DirId id = pathStoreInternDir(path);
+        DirRecord *d = pathStoreDir(id);
+        ok = d != nullptr;
+        if (ok)
+        {
+            d->fingerprint = fp;
+            dirMap[i] = id;
+        }
+    }
+
+    for (uint32_t i = 0; i < hdr.trackCount && ok; i++)
+    {
+        uint16_t dir = 0;
+        TrackInfo info;
+        uint16_t leafLen = 0;
+        ok = rd.read(&dir, 2) && dir < hdr.dirCount &&
+             rd.read(&info.size, 4) && rd.read(&info.mtime, 4) &&
+             rd.read(&info.flags, 1) && rd.read(&leafLen, 2) &&
+             leafLen < LIBRARY_MAX_PATH_LEN && rd.read(path, leafLen);
+        if (!ok)
+            break;
+        path[leafLen] = '\0';
+
+        TrackHandle h = pathStoreAddTrack(dirMap[dir], path, info.size, info.mtime, info.flags);
+        ok = h != PATH_STORE_INVALID_HANDLE && trackSink(h);
+        if (!ok || !(info.flags & TRACK_FLAG_META))
+            continue;
+
+        uint32_t durationMs = 0;
+        uint16_t trackNo = 0;
+        uint32_t streamStart = 0;
+        uint16_t metaLen = 0;
+        ok = rd.read(&durationMs, 4) && rd.read(&trackNo, 2) &&
+             rd.read(&streamStart, 4) && rd.read(&metaLen, 2) &&
+             metaLen < LIBRARY_MAX_PATH_LEN && rd.read(path, metaLen) && metaWellFormed(path, metaLen);
+        if (!ok)
+            break;
+        pathStoreTrack(h)->streamStart = streamStart;
+        if (metaLen && keepMetaText)
+        {
+            const char *artist = path + strlen(path) + 1;
+            pathStoreSetMeta(h, path, artist, artist + strlen(artist) + 1, durationMs, trackNo);
+        }
+        else
+        {
+            pathStoreSetMeta(h, "", "", "", durationMs, trackNo);
+        }
+    }
+
+    // 记录必须恰好填满 payload，CRC 才覆盖了全部字节
+    ok = ok && rd.remaining == 0 && rd.pos == rd.len;
+
+    free(dirMap);
+    free(path);
+    free(buf);
+    f.close();
+
+    if (!ok || (rd.crc ^ 0xFFFFFFFFu) != hdr.payloadCrc)
+    {
+        LOG_LIB("index corrupt");
+        return false;
+    }
+    if (rootFingerprint)
+        *rootFingerprint = hdr.rootFingerprint;
+    return true;
+}
+
+// ======================
+// 保存：先写临时文件，再替换，掉电不会留下半个索引
+// ======================
+struct ChunkWriter
+{
+    File *file;
+    uint8_t *buf;
+    size_t len;
+    uint32_t total;
+    uint32_t crc;
+    bool ok;
+
+    void flush()
+    {
+        if (len == 0)
+            return;
+        if (file->write(buf, len) != len)
+            ok = false;
+        len = 0;
+    }
+
+    void write(const void *src, size_t n)
+    {
+        const uint8_t *in = (const uint8_t *)src;
+        crc = crc32Update(crc, in, n);
+        total += n;
+        while (n > 0)
+        {
+            size_t take = INDEX_IO_CHUNK - len;
+            if (take > n)
+                take = n;
+            memcpy(buf + len, in, take);
+            len += take;
+            in += take;
+            n -= take;
+            if (len == INDEX_IO_CHUNK)
+                flush();
+        }
+    }
+};
+
+bool libraryIndexSave(uint32_t rootFingerprint)
+{
+    if (!SD.exists(LIBRARY_INDEX_DIR))
+        SD.mkdir(LIBRARY_INDEX_DIR);
+
+    File f = SD.open(INDEX_TMP_PATH, FILE_WRITE);
+    if (!f)
+    {
+        LOG_LIB("index create failed");
+        return false;
+    }
+
+    uint8_t *buf = (uint8_t *)malloc(INDEX_IO_CHUNK);
+    if (!buf)
+    {
+        f.close();
+        return false;
+    }
+
+    // 先占位写头部，payload 写完后回填
+    LibraryIndexHeader hdr = {};
+    f.write((const uint8_t *)&hdr, sizeof(hdr));
+
+    // 跳过已删除的目录，剩余目录按原顺序重新编号（父目录仍在子目录之前）
+    uint32_t storeDirs = pathStoreDirCount();
+    DirId *dirMap = (DirId *)malloc((storeDirs ? storeDirs : 1) * sizeof(DirId));
+    if (!dirMap)
+    {
+        free(buf);
+        f.close();
+        SD.remove(INDEX_TMP_PATH);
+        return false;
+    }
+
+    ChunkWriter wr = {&f, buf, 0, 0, 0xFFFFFFFFu, true};
+    uint32_t dirCount = 0;
+    for (uint32_t i = 0; i < storeDirs; i++)
+    {
+        const DirRecord *d = pathStoreDir((DirId)i);
+        if (d->dead)
+        {
+            dirMap[i] = PATH_STORE_INVALID_DIR;
+            continue;
+        }
+        dirMap[i] = (DirId)dirCount++;
+
+        const char *path = pathStoreDirPath((DirId)i);
+        uint16_t pathLen = (uint16_t)strlen(path);
+        wr.write(&d->fingerprint, 4);
+        wr.write(&pathLen, 2);
+        wr.write(path, pathLen);
+    }
+
+    uint32_t count = 0;
+    int total = libraryGetCount();
+    for (int i = 0; i < total; i++)
+    {
+        TrackHandle h = libraryGetHandle(i);
+        const TrackRecord *r = pathStoreTrack(h);
+        if (!r || dirMap[r->dir] == PATH_STORE_INVALID_DIR)
+            continue;
+
+        const char *leaf = pathStoreLeaf(h);
+        uint16_t dir = dirMap[r->dir];
+        uint16_t leafLen = (uint16_t)strlen(leaf);
+        wr.write(&dir, 2);
+        wr.write(&r->size, 4);
+        wr.write(&r->mtime, 4);
+        wr.write(&r->flags, 1);
+        wr.write(&leafLen, 2);
+        wr.write(leaf, leafLen);
+        if (r->flags & TRACK_FLAG_META)
+        {
+            const char *meta = pathStoreMeta(h);
+            uint16_t metaLen = 0;
+            if (meta)
+            {
+                const char *p = meta;
+                for (int k = 0; k < 3; k++)
+                    p += strlen(p) + 1;
+                metaLen = (uint16_t)(p - meta);
+            }
+            wr.write(&r->durationMs, 4);
+            wr.write(&r->trackNo, 2);
+            wr.write(&r->streamStart, 4);
+            wr.write(&metaLen, 2);
+            wr.write(meta, metaLen);
+        }
+        count++;
+    }
+    wr.flush();
+    free(dirMap);
+    free(buf);
+
+    hdr.magic = LIBRARY_INDEX_MAGIC;
+    hdr.version = LIBRARY_INDEX_VERSION;
+    hdr.headerSize = sizeof(hdr);
+    hdr.trackCount = count;
+    hdr.dirCount = dirCount;
+    hdr.rootFingerprint = rootFingerprint;
+    hdr.payloadBytes = wr.total;
+    hdr.payloadCrc = wr.crc ^ 0xFFFFFFFFu;
+
+    bool ok = wr.ok && f.seek(0) && f.write((const uint8_t *)&hdr, sizeof(hdr)) == sizeof(hdr);
+    f.close();
+
+    if (!ok)
+    {
+        SD.remove(INDEX_TMP_PATH);
+        LOG_LIB("index write failed");
+        return false;
+    }
+
+    SD.remove(LIBRARY_INDEX_PATH);
+    if (!SD.rename(INDEX_TMP_PATH, LIBRARY_INDEX_PATH))
+    {
+        LOG_LIB("index rename failed");
+        return false;
+    }
+    LOG_LIB("index saved: %lu tracks, %lu dirs, %lu bytes",
+            (unsigned long)count, (unsigned long)dirCount, (unsigned long)(sizeof(hdr) + wr.total));
+    return true;
+}
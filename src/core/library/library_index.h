@@ -0,0 +1,53 @@
+#pragma once
+#include <stdint.h>
+#include <FS.h>
+#include "core/library/library.h"
+
+// 索引文件格式（小端）：
+//   LibraryIndexHeader
+//   dirCount 条目录记录：fingerprint(u32) pathLen(u16) path（不含 '\0'），父目录总在子目录之前
+//   trackCount 条曲目记录：dir(u16，目录记录序号) size(u32) mtime(u32) flags(u8) leafLen(u16) leaf
+//     flags 含 TRACK_FLAG_META 时接着是 durationMs(u32) trackNo(u16) streamStart(u32) metaLen(u16) meta
+//     （标题、艺术家、专辑三段，各带 '\0'；metaLen 为 0 表示没有文本字段）
+// 整个 payload 的 CRC32 存在头部，加载时一次顺序读完即可校验
+#define LIBRARY_INDEX_MAGIC 0x494C4353u // "SCLI"
+// 4：开始收录 WAV/FLAC，旧索引作废，全量扫描一次把它们补进来
+// 5：曲目记录带上元数据
+// 6：元数据里加上流起点（ID3v2 之后），打开曲目时不再从文件开头找
+#define LIBRARY_INDEX_VERSION 6
+
+struct LibraryIndexHeader
+{
+    uint32_t magic;
+    uint16_t version;
+    uint16_t headerSize;
+    uint32_t trackCount;
+    uint32_t dirCount;
+    uint32_t rootFingerprint;
+    uint32_t payloadBytes;
+    uint32_t payloadCrc;
+};
+
+// 目录指纹：只看直接子项（文件名、大小、修改时间；子目录只看名字和修改时间），
+// 与目录项顺序无关。FAT 只在增删目录项时更新该目录自己的修改时间，不向上传播：
+// /Music/Artist/ 下新建专辑只改变 /Music/Artist 的指纹，/Music 的不变，所以要逐个目录比对。
+struct DirFingerprint
+{
+    uint32_t count;
+    uint32_t mix;
+
+    void reset() { count = mix = 0; }
+    void add(File &entry);
+    uint32_t value() const { return mix ^ (count * 0x9E3779B9u); }
+};
+
+// 列一层目录计算指纹（不递归）；目录不存在返回 0
+uint32_t libraryIndexDirFingerprint(const char *path);
+
+// 读取索引并直接登记进路径仓库，曲目按文件顺序交给 trackSink 追加到播放列表。
+// keepMetaText 为 false 时只恢复时长和音轨号（内存紧张时用）。
+// 文件缺失或损坏时返回 false。rootFingerprint 输出索引建立时的根目录指纹
+typedef bool (*LibraryIndexTrackSink)(TrackHandle h);
+bool libraryIndexLoad(uint32_t *rootFingerprint, LibraryIndexTrackSink trackSink, bool keepMetaText);
+
+bool libraryIndexSave(uint32_t rootFingerprint);
@@ -0,0 +1,640 @@
+#include "core/library/path_store.h"
+#include <Arduino.h>
+#include <esp_heap_caps.h>
+#include <string.h>
+
+#define ARENA_CHUNK_PSRAM (64 * 1024)
+#define ARENA_CHUNK_DRAM (4 * 1024)
+#define RECORD_BLOCK_BITS 8
+#define RECORD_BLOCK_SIZE (1u << RECORD_BLOCK_BITS)
+
+#define SLOT_EMPTY 0u
+#define SLOT_TOMB 0xFFFFFFFFu
+
+// ======================
+// 内存分配：优先 PSRAM
+// ======================
+static bool g_psram = false;
+static size_t g_bytesUsed = 0;
+
+static void *storeAlloc(size_t n)
+{
+    void *p = g_psram ? heap_caps_malloc(n, MALLOC_CAP_SPIRAM) : malloc(n);
+    if (p)
+        g_bytesUsed += n;
+    return p;
+}
+
+static void *storeRealloc(void *old, size_t oldN, size_t n)
+{
+    void *p = g_psram ? heap_caps_realloc(old, n, MALLOC_CAP_SPIRAM) : realloc(old, n);
+    if (p)
+        g_bytesUsed = g_bytesUsed - oldN + n;
+    return p;
+}
+
+static void storeFree(void *p)
+{
+    if (g_psram)
+        heap_caps_free(p);
+    else
+        free(p);
+}
+
+// ======================
+// 字符串 arena：引用 = (块号 << 16) | 块内偏移
+// ======================
+static char **g_chunks = nullptr;
+static uint32_t g_chunkCount = 0;
+static uint32_t g_chunkCap = 0;
+static uint32_t g_chunkUsed = 0; // 最后一块已用字节
+static uint32_t g_chunkSize = ARENA_CHUNK_DRAM;
+static size_t g_wasted = 0; // 不再被引用的字节
+
+// 重打包换下来的旧块，等读者放手后再释放
+static char **g_retired = nullptr;
+static uint32_t g_retiredCount = 0;
+static uint32_t g_retiredCap = 0;
+
+// 分配 need 字节，返回引用（失败为 SLOT_TOMB），*dst 指向可写位置
+static uint32_t arenaAlloc(size_t need, char **dst)
+{
+    if (need > g_chunkSize)
+        return SLOT_TOMB;
+
+    if (g_chunkCount == 0 || g_chunkUsed + need > g_chunkSize)
+    {
+        if (g_chunkCount >= 0xFFFF)
+            return SLOT_TOMB;
+        if (g_chunkCount == g_chunkCap)
+        {
+            uint32_t cap = g_chunkCap ? g_chunkCap * 2 : 8;
+            char **t = (char **)storeRealloc(g_chunks, g_chunkCap * sizeof(char *), cap * sizeof(char *));
+            if (!t)
+                return SLOT_TOMB;
+            g_chunks = t;
+            g_chunkCap = cap;
+        }
+        char *c = (char *)storeAlloc(g_chunkSize);
+        if (!c)
+            return SLOT_TOMB;
+        g_chunks[g_chunkCount++] = c;
+        g_chunkUsed = 0;
+    }
+
+    uint32_t ref = ((g_chunkCount - 1) << 16) | g_chunkUsed;
+    *dst = g_chunks[g_chunkCount - 1] + g_chunkUsed;
+    g_chunkUsed += need;
+    return ref;
+}
+
+static uint32_t arenaPut(const char *s, size_t len)
+{
+    char *dst;
+    uint32_t ref = arenaAlloc(len + 1, &dst);
+    if (ref == SLOT_TOMB)
+        return SLOT_TOMB;
+    memcpy(dst, s, len);
+    dst[len] = '\0';
+    return ref;
+}
+
+static inline const char *arenaGet(uint32_t ref)
+{
+    return g_chunks[ref >> 16] + (ref & 0xFFFF);
+}
+
+// 元数据块长度：三个连续的 '\0' 结尾字段
+static size_t metaBytes(const char *meta)
+{
+    const char *p = meta;
+    for (int k = 0; k < 3; k++)
+        p += strlen(p) + 1;
+    return (size_t)(p - meta);
+}
+
+// ======================
+// 开放寻址哈希表（值 = id + 1，0 空，全 1 为墓碑）
+// ======================
+struct HashTable
+{
+    uint32_t *slots;
+    uint32_t cap; // 2 的幂
+    uint32_t used;
+};
+
+static HashTable g_dirHash = {nullptr, 0, 0};
+static HashTable g_trackHash = {nullptr, 0, 0};
+
+static uint32_t hashBytes(const char *s, size_t n, uint32_t seed)
+{
+    uint32_t h = 2166136261u ^ seed;
+    for (size_t i = 0; i < n; i++)
+    {
+        h ^= (uint8_t)s[i];
+        h *= 16777619u;
+    }
+    return h ? h : 1;
+}
+
+static void hashFree(HashTable &t)
+{
+    if (t.slots)
+        storeFree(t.slots);
+    g_bytesUsed -= t.cap * sizeof(uint32_t);
+    t.slots = nullptr;
+    t.cap = t.used = 0;
+}
+
+static bool hashAlloc(HashTable &t, uint32_t cap)
+{
+    uint32_t *s = (uint32_t *)storeAlloc(cap * sizeof(uint32_t));
+    if (!s)
+        return false;
+    memset(s, 0, cap * sizeof(uint32_t));
+    t.slots = s;
+    t.cap = cap;
+    t.used = 0;
+    return true;
+}
+
+static void hashInsert(HashTable &t, uint32_t hash, uint32_t id)
+{
+    uint32_t mask = t.cap - 1;
+    uint32_t i = hash & mask;
+    while (t.slots[i] != SLOT_EMPTY && t.slots[i] != SLOT_TOMB)
+        i = (i + 1) & mask;
+    if (t.slots[i] == SLOT_EMPTY)
+        t.used++;
+    t.slots[i] = id + 1;
+}
+
+// ======================
+// 目录表
+// ======================
+static DirRecord *g_dirs = nullptr;
+static uint32_t g_dirCount = 0;
+static uint32_t g_dirCap = 0;
+
+static void dirHashRebuild(uint32_t cap)
+{
+    hashFree(g_dirHash);
+    if (!hashAlloc(g_dirHash, cap))
+        return;
+    for (uint32_t i = 0; i < g_dirCount; i++)
+        hashInsert(g_dirHash, g_dirs[i].hash, i);
+}
+
+static DirId findDirN(const char *path, size_t len, uint32_t hash)
+{
+    if (!g_dirHash.slots)
+        return PATH_STORE_INVALID_DIR;
+    uint32_t mask = g_dirHash.cap - 1;
+    for (uint32_t i = hash & mask;; i = (i + 1) & mask)
+    {
+        uint32_t v = g_dirHash.slots[i];
+        if (v == SLOT_EMPTY)
+            return PATH_STORE_INVALID_DIR;
+        if (v == SLOT_TOMB)
+            continue;
+        const DirRecord &d = g_dirs[v - 1];
+        if (d.hash == hash)
+        {
+            const char *p = arenaGet(d.path);
+            if (strncmp(p, path, len) == 0 && p[len] == '\0')
+                return (DirId)(v - 1);
+        }
+    }
+}
+
+// 目录路径规范化长度：去掉末尾 '/'，根目录保留 "/"
+static size_t dirLen(const char *path, size_t len)
+{
+    while (len > 1 && path[len - 1] == '/')
+        len--;
+    return len;
+}
+
+static DirId internDirN(const char *path, size_t len)
+{
+    len = dirLen(path, len);
+    uint32_t hash = hashBytes(path, len, 0);
+    DirId found = findDirN(path, len, hash);
+    if (found != PATH_STORE_INVALID_DIR)
+        return found;
+    if (g_dirCount >= PATH_STORE_MAX_DIRS)
+        return PATH_STORE_INVALID_DIR;
+
+    // 先登记父目录，保证 parent 链完整
+    DirId parent = PATH_STORE_INVALID_DIR;
+    if (len > 1)
+    {
+        const char *slash = path + len - 1;
+        while (slash > path && *slash != '/')
+            slash--;
+        parent = internDirN(path, slash == path ? 1 : (size_t)(slash - path));
+    }
+
+    if (g_dirCount == g_dirCap)
+    {
+        uint32_t cap = g_dirCap ? g_dirCap * 2 : 32;
+        DirRecord *t = (DirRecord *)storeRealloc(g_dirs, g_dirCap * sizeof(DirRecord), cap * sizeof(DirRecord));
+        if (!t)
+            return PATH_STORE_INVALID_DIR;
+        g_dirs = t;
+        g_dirCap = cap;
+    }
+
+    uint32_t ref = arenaPut(path, len);
+    if (ref == SLOT_TOMB)
+        return PATH_STORE_INVALID_DIR;
+
+    DirId id = (DirId)g_dirCount++;
+    DirRecord &d = g_dirs[id];
+    d.path = ref;
+    d.hash = hash;
+    d.fingerprint = 0;
+    d.parent = parent;
+    d.firstChild = PATH_STORE_INVALID_DIR;
+    d.nextSibling = PATH_STORE_INVALID_DIR;
+    d.seen = 0;
+    d.dead = 0;
+    d.firstTrack = PATH_STORE_INVALID_HANDLE;
+    if (parent != PATH_STORE_INVALID_DIR)
+    {
+        d.nextSibling = g_dirs[parent].firstChild;
+        g_dirs[parent].firstChild = id;
+    }
+
+    if ((g_dirHash.used + 1) * 4 > g_dirHash.cap * 3)
+        dirHashRebuild(g_dirHash.cap ? g_dirHash.cap * 2 : 64);
+    else
+        hashInsert(g_dirHash, hash, id);
+    return id;
+}
+
+DirId pathStoreInternDir(const char *path) { return internDirN(path, strlen(path)); }
+
+DirId pathStoreFindDir(const char *path)
+{
+    size_t len = dirLen(path, strlen(path));
+    return findDirN(path, len, hashBytes(path, len, 0));
+}
+
+DirRecord *pathStoreDir(DirId id) { return id < g_dirCount ? &g_dirs[id] : nullptr; }
+const char *pathStoreDirPath(DirId id) { return id < g_dirCount ? arenaGet(g_dirs[id].path) : ""; }
+uint32_t pathStoreDirCount() { return g_dirCount; }
+
+// ======================
+// 曲目记录：固定大小的块，块表按需翻倍
+// ======================
+static TrackRecord **g_blocks = nullptr;
+static uint32_t g_blockCount = 0;
+static uint32_t g_blockCap = 0;
+static uint32_t g_trackSlots = 0;
+
+static inline TrackRecord &recordAt(TrackHandle h)
+{
+    return g_blocks[h >> RECORD_BLOCK_BITS][h & (RECORD_BLOCK_SIZE - 1)];
+}
+
+static inline uint32_t trackHash(DirId dir, const char *leaf)
+{
+    return hashBytes(leaf, strlen(leaf), dir * 0x9E3779B9u);
+}
+
+static void trackHashRebuild(uint32_t cap)
+{
+    hashFree(g_trackHash);
+    if (!hashAlloc(g_trackHash, cap))
+        return;
+    for (uint32_t h = 0; h < g_trackSlots; h++)
+    {
+        const TrackRecord &r = recordAt(h);
+        if (r.dir != PATH_STORE_INVALID_DIR)
+            hashInsert(g_trackHash, trackHash(r.dir, arenaGet(r.leaf)), h);
+    }
+}
+
+TrackHandle pathStoreFindTrack(DirId dir, const char *leaf)
+{
+    if (!g_trackHash.slots || dir == PATH_STORE_INVALID_DIR)
+        return PATH_STORE_INVALID_HANDLE;
+    uint32_t hash = trackHash(dir, leaf);
+    uint32_t mask = g_trackHash.cap - 1;
+    for (uint32_t i = hash & mask;; i = (i + 1) & mask)
+    {
+        uint32_t v = g_trackHash.slots[i];
+        if (v == SLOT_EMPTY)
+            return PATH_STORE_INVALID_HANDLE;
+        if (v == SLOT_TOMB)
+            continue;
+        const TrackRecord &r = recordAt(v - 1);
+        if (r.dir == dir && strcmp(arenaGet(r.leaf), leaf) == 0)
+            return v - 1;
+    }
+}
+
+TrackHandle pathStoreAddTrack(DirId dir, const char *leaf, uint32_t size, uint32_t mtime, uint8_t flags)
+{
+    if (dir >= g_dirCount)
+        return PATH_STORE_INVALID_HANDLE;
+
+    uint32_t blk = g_trackSlots >> RECORD_BLOCK_BITS;
+    if (blk == g_blockCount)
+    {
+        if (g_blockCount == g_blockCap)
+        {
+            uint32_t cap = g_blockCap ? g_blockCap * 2 : 8;
+            TrackRecord **t = (TrackRecord **)storeRealloc(g_blocks, g_blockCap * sizeof(TrackRecord *), cap * sizeof(TrackRecord *));
+            if (!t)
+                return PATH_STORE_INVALID_HANDLE;
+            g_blocks = t;
+            g_blockCap = cap;
+        }
+        TrackRecord *b = (TrackRecord *)storeAlloc(RECORD_BLOCK_SIZE * sizeof(TrackRecord));
+        if (!b)
+            return PATH_STORE_INVALID_HANDLE;
+        g_blocks[g_blockCount++] = b;
+    }
+
+    uint32_t ref = arenaPut(leaf, strlen(leaf));
+    if (ref == SLOT_TOMB)
+        return PATH_STORE_INVALID_HANDLE;
+
+    TrackHandle h = g_trackSlots++;
+    TrackRecord &r = recordAt(h);
+    r.leaf = ref;
+    r.dir = dir;
+    r.flags = flags;
+    r.mark = 0;
+    r.size = size;
+    r.mtime = mtime;
+    r.meta = PATH_STORE_NO_META;
+    r.durationMs = 0;
+    r.trackNo = 0;
+    r.streamStart = 0;
+    r.nextInDir = g_dirs[dir].firstTrack;
+    g_dirs[dir].firstTrack = h;
+
+    if ((g_trackHash.used + 1) * 4 > g_trackHash.cap * 3)
+        trackHashRebuild(g_trackHash.cap ? g_trackHash.cap * 2 : 256);
+    else
+        hashInsert(g_trackHash, trackHash(dir, leaf), h);
+    return h;
+}
+
+TrackRecord *pathStoreTrack(TrackHandle h)
+{
+    if (h >= g_trackSlots)
+        return nullptr;
+    TrackRecord &r = recordAt(h);
+    return r.dir == PATH_STORE_INVALID_DIR ? nullptr : &r;
+}
+
+const char *pathStoreLeaf(TrackHandle h)
+{
+    const TrackRecord *r = pathStoreTrack(h);
+    return r ? arenaGet(r->leaf) : "";
+}
+
+// 删除只打墓碑，叶子名字节不回收（重扫删除很少见，重置时整体释放）
+void pathStoreRemoveTrack(TrackHandle h)
+{
+    TrackRecord *r = pathStoreTrack(h);
+    if (!r)
+        return;
+
+    // 从目录的曲目链表上摘下：只走同目录的曲目
+    TrackHandle *link = &g_dirs[r->dir].firstTrack;
+    while (*link != PATH_STORE_INVALID_HANDLE && *link != h)
+        link = &recordAt(*link).nextInDir;
+    if (*link == h)
+        *link = r->nextInDir;
+
+    g_wasted += strlen(arenaGet(r->leaf)) + 1;
+    if (r->meta != PATH_STORE_NO_META)
+        g_wasted += metaBytes(arenaGet(r->meta));
+
+    uint32_t hash = trackHash(r->dir, arenaGet(r->leaf));
+    uint32_t mask = g_trackHash.cap - 1;
+    for (uint32_t i = hash & mask; g_trackHash.slots[i] != SLOT_EMPTY; i = (i + 1) & mask)
+    {
+        if (g_trackHash.slots[i] == h + 1)
+        {
+            g_trackHash.slots[i] = SLOT_TOMB;
+            break;
+        }
+    }
+    r->dir = PATH_STORE_INVALID_DIR;
+}
+
+bool pathStoreSetMeta(TrackHandle h, const char *title, const char *artist, const char *album,
+                      uint32_t durationMs, uint16_t trackNo)
+{
+    TrackRecord *r = pathStoreTrack(h);
+    if (!r)
+        return false;
+    if (r->meta != PATH_STORE_NO_META)
+        g_wasted += metaBytes(arenaGet(r->meta));
+    r->meta = PATH_STORE_NO_META;
+    r->durationMs = durationMs;
+    r->trackNo = trackNo;
+    if (!title[0] && !artist[0] && !album[0])
+        return true;
+
+    size_t lt = strlen(title) + 1;
+    size_t la = strlen(artist) + 1;
+    size_t lb = strlen(album) + 1;
+    char *dst;
+    uint32_t ref = arenaAlloc(lt + la + lb, &dst);
+    if (ref == SLOT_TOMB)
+        return false;
+    memcpy(dst, title, lt);
+    memcpy(dst + lt, artist, la);
+    memcpy(dst + lt + la, album, lb);
+    r->meta = ref;
+    return true;
+}
+
+const char *pathStoreMeta(TrackHandle h)
+{
+    const TrackRecord *r = pathStoreTrack(h);
+    return r && r->meta != PATH_STORE_NO_META ? arenaGet(r->meta) : nullptr;
+}
+
+bool pathStoreJoin(TrackHandle h, char *buf, size_t len)
+{
+    const TrackRecord *r = pathStoreTrack(h);
+    if (!r || !buf || len == 0)
+        return false;
+
+    const char *dir = arenaGet(g_dirs[r->dir].path);
+    const char *leaf = arenaGet(r->leaf);
+    size_t dl = strlen(dir);
+    size_t ll = strlen(leaf);
+    if (dl == 1)
+        dl = 0; // 根目录不重复 '/'
+    if (dl + 1 + ll + 1 > len)
+    {
+        buf[0] = '\0';
+        return false;
+    }
+    memcpy(buf, dir, dl);
+    buf[dl] = '/';
+    memcpy(buf + dl + 1, leaf, ll + 1);
+    return true;
+}
+
+TrackHandle pathStoreFindPath(const char *path)
+{
+    const char *slash = strrchr(path, '/');
+    if (!slash)
+        return PATH_STORE_INVALID_HANDLE;
+    size_t dl = slash == path ? 1 : (size_t)(slash - path);
+    DirId dir = findDirN(path, dl, hashBytes(path, dl, 0));
+    return pathStoreFindTrack(dir, slash + 1);
+}
+
+// ======================
+// 重打包
+// ======================
+// 浪费超过总块容量的 1/4 且至少一整块时才值得搬
+static bool repackWorthIt()
+{
+    return g_wasted >= g_chunkSize && g_wasted * 4 >= (size_t)g_chunkCount * g_chunkSize;
+}
+
+// 新块里的排位：跟 arenaAlloc 一样顺序填满一块再开下一块
+struct Packer
+{
+    uint32_t chunk;
+    uint32_t used;
+    bool any;
+    char **dst; // 为空时只数块数（第一遍）
+};
+
+static void packOne(Packer &pk, uint32_t &ref, size_t len)
+{
+    if (pk.any && pk.used + len > g_chunkSize)
+    {
+        pk.chunk++;
+        pk.used = 0;
+    }
+    pk.any = true;
+    uint32_t to = (pk.chunk << 16) | pk.used;
+    pk.used += len;
+    if (pk.dst)
+    {
+        memcpy(pk.dst[pk.chunk] + (to & 0xFFFF), arenaGet(ref), len);
+        ref = to;
+    }
+}
+
+// 顺序固定（目录路径、曲目叶子名、元数据），两遍得到同样的布局
+static void packLive(Packer &pk)
+{
+    for (uint32_t i = 0; i < g_dirCount; i++)
+        packOne(pk, g_dirs[i].path, strlen(arenaGet(g_dirs[i].path)) + 1);
+    for (uint32_t h = 0; h < g_trackSlots; h++)
+    {
+        TrackRecord &r = recordAt(h);
+        if (r.dir == PATH_STORE_INVALID_DIR)
+            continue;
+        packOne(pk, r.leaf, strlen(arenaGet(r.leaf)) + 1);
+        if (r.meta != PATH_STORE_NO_META)
+            packOne(pk, r.meta, metaBytes(arenaGet(r.meta)));
+    }
+}
+
+void pathStoreReleaseRetired()
+{
+    for (uint32_t i = 0; i < g_retiredCount; i++)
+        storeFree(g_retired[i]);
+    if (g_retired)
+        storeFree(g_retired);
+    g_bytesUsed -= g_retiredCount * g_chunkSize + g_retiredCap * sizeof(char *);
+    g_retired = nullptr;
+    g_retiredCount = g_retiredCap = 0;
+}
+
+bool pathStoreRepack()
+{
+    if (!repackWorthIt())
+        return false;
+    pathStoreReleaseRetired();
+
+    // 第一遍只数需要几块，先把块都要到手；要不到就原样放弃，记录一个都不改
+    Packer pk = {0, 0, false, nullptr};
+    packLive(pk);
+    uint32_t need = pk.any ? pk.chunk + 1 : 0;
+    uint32_t cap = 8;
+    while (cap < need)
+        cap *= 2;
+    char **chunks = (char **)storeAlloc(cap * sizeof(char *));
+    if (!chunks)
+        return false;
+    for (uint32_t i = 0; i < need; i++)
+    {
+        chunks[i] = (char *)storeAlloc(g_chunkSize);
+        if (!chunks[i])
+        {
+            g_bytesUsed -= cap * sizeof(char *) + i * g_chunkSize;
+            while (i > 0)
+                storeFree(chunks[--i]);
+            storeFree(chunks);
+            return false;
+        }
+    }
+
+    // 第二遍拷贝并改写引用；arenaGet 仍指向旧块，直到最后换表
+    pk = {0, 0, false, chunks};
+    packLive(pk);
+
+    g_retired = g_chunks;
+    g_retiredCount = g_chunkCount;
+    g_retiredCap = g_chunkCap;
+    g_chunks = chunks;
+    g_chunkCount = need;
+    g_chunkCap = cap;
+    g_chunkUsed = pk.used;
+    g_wasted = 0;
+    return true;
+}
+
+// ======================
+// 重置 / 统计
+// ======================
+void pathStoreReset()
+{
+    pathStoreReleaseRetired();
+    for (uint32_t i = 0; i < g_chunkCount; i++)
+        storeFree(g_chunks[i]);
+    if (g_chunks)
+        storeFree(g_chunks);
+    for (uint32_t i = 0; i < g_blockCount; i++)
+        storeFree(g_blocks[i]);
+    if (g_blocks)
+        storeFree(g_blocks);
+    if (g_dirs)
+        storeFree(g_dirs);
+    hashFree(g_dirHash);
+    hashFree(g_trackHash);
+
+    g_chunks = nullptr;
+    g_chunkCount = g_chunkCap = g_chunkUsed = 0;
+    g_blocks = nullptr;
+    g_blockCount = g_blockCap = g_trackSlots = 0;
+    g_dirs = nullptr;
+    g_dirCount = g_dirCap = 0;
+    g_bytesUsed = 0;
+    g_wasted = 0;
+
+    g_psram = psramFound();
+    g_chunkSize = g_psram ? ARENA_CHUNK_PSRAM : ARENA_CHUNK_DRAM;
+}
+
+uint32_t pathStoreTrackSlots() { return g_trackSlots; }
+size_t pathStoreBytesUsed() { return g_bytesUsed; }
+size_t pathStoreWastedBytes() { return g_wasted; }
+bool pathStoreInPsram() { return g_psram; }
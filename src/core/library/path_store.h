@@ -0,0 +1,89 @@
+#pragma once
+#include <stdint.h>
+#include <stddef.h>
+
+// 紧凑路径仓库：
+//   - 每个目录的完整路径只存一份，曲目只存文件名（叶子名）
+//   - 字符串放在分块 arena 里（有 PSRAM 时放 PSRAM），块不搬移；
+//     只有 pathStoreRepack 会换块，旧块留到 pathStoreReleaseRetired 才释放
+//   - 曲目用 32 位句柄引用，记录同样分块存放
+//   - 每个目录串着自己的子目录和曲目（单链表），重扫一个目录只碰它自己的条目
+// 本模块不加锁，并发保护由 library 负责。
+
+typedef uint32_t TrackHandle;
+typedef uint16_t DirId;
+
+#define PATH_STORE_INVALID_HANDLE 0xFFFFFFFFu
+#define PATH_STORE_INVALID_DIR 0xFFFFu
+#define PATH_STORE_MAX_DIRS 0xFFFEu
+#define PATH_STORE_NO_META 0xFFFFFFFFu
+
+struct TrackRecord
+{
+    uint32_t leaf; // arena 引用
+    DirId dir;
+    uint8_t flags;
+    uint8_t mark; // 扫描过程中的临时标记
+    uint32_t size;
+    uint32_t mtime;
+    uint32_t meta;       // arena 引用："标题\0艺术家\0专辑"，没有时为 PATH_STORE_NO_META
+    uint32_t durationMs; // 0 表示未知
+    uint16_t trackNo;
+    uint32_t streamStart; // ID3v2 标签之后的第一个字节，flags 含 TRACK_FLAG_LAYOUT 时有效
+    TrackHandle nextInDir; // 同目录的下一首，PATH_STORE_INVALID_HANDLE 结束
+};
+
+struct DirRecord
+{
+    uint32_t path; // arena 引用
+    uint32_t hash;
+    uint32_t fingerprint;
+    DirId parent;
+    DirId firstChild;  // 子目录链表（含已消失的），PATH_STORE_INVALID_DIR 结束
+    DirId nextSibling;
+    uint8_t seen;
+    uint8_t dead;
+    TrackHandle firstTrack; // 本目录曲目链表（不含已删除的）
+};
+
+void pathStoreReset();
+
+// 目录：path 为完整路径（根目录为 "/"），同一路径只会登记一次
+DirId pathStoreInternDir(const char *path);
+DirId pathStoreFindDir(const char *path);
+DirRecord *pathStoreDir(DirId id);
+const char *pathStoreDirPath(DirId id);
+uint32_t pathStoreDirCount();
+
+// 曲目：新曲目挂到所在目录的曲目链表上，删除时摘下
+TrackHandle pathStoreAddTrack(DirId dir, const char *leaf, uint32_t size, uint32_t mtime, uint8_t flags);
+TrackHandle pathStoreFindTrack(DirId dir, const char *leaf);
+TrackRecord *pathStoreTrack(TrackHandle h);
+const char *pathStoreLeaf(TrackHandle h);
+void pathStoreRemoveTrack(TrackHandle h);
+
+// 曲目元数据：三个字段连续存放、各自以 '\0' 结尾，取出时依次 strlen 即可。
+// 三个字段都为空时不占 arena；重新设置时旧字节记为浪费，等 pathStoreRepack 回收
+bool pathStoreSetMeta(TrackHandle h, const char *title, const char *artist, const char *album,
+                      uint32_t durationMs, uint16_t trackNo);
+// 返回指向标题的指针（其后紧跟艺术家、专辑），没有文本字段时返回 nullptr
+const char *pathStoreMeta(TrackHandle h);
+
+// 拼出完整路径到调用方缓冲区，不分配内存；缓冲区不够时返回 false
+bool pathStoreJoin(TrackHandle h, char *buf, size_t len);
+
+// 拆分完整路径并查找曲目
+TrackHandle pathStoreFindPath(const char *path);
+
+// 回收 arena：删除曲目和重设元数据留下的字节只记账，浪费超过阈值时
+// 把仍在用的字符串紧凑拷进新块（句柄不变）。旧块不立即释放——别的任务
+// 可能还拿着上一刻取到的字符串指针——调用方过一段时间再 ReleaseRetired。
+// 需持写锁；没有重打包（未到阈值或内存不够）时返回 false
+bool pathStoreRepack();
+void pathStoreReleaseRetired();
+
+// 统计
+uint32_t pathStoreTrackSlots();
+size_t pathStoreBytesUsed();
+size_t pathStoreWastedBytes();
+bool pathStoreInPsram();
@@ -23,13 +23,16 @@ struct AppState
     // UI 状态
     UiMode uiMode;
     int32_t browserCursor;
-    int32_t browserScrollTop;
     bool inBrowser; // 辅助标志
 
     // 播放状态
     bool isPlaying;
     int32_t currentTrackIdx;
-    char currentTitle[64];
+    char currentTitle[128]; // "艺术家 - 标题"，没有标签时为文件名
+    uint32_t elapsedMs;  // 由音频任务更新
+    uint32_t durationMs; // 0 表示未知
     PlayMode playMode;
+    bool gapless; // 无缝播放：预开下一首、裁掉编码器延迟/填充
     int32_t totalTracks;
+    int32_t batteryLevel; // loop() 每隔几秒读一次电源芯片
 };
\ No newline at end of file
@@ -2,71 +2,106 @@
 #include "platform/platform.h"
 #include "core/state/app_state.h"
 #include "core/config/config_store.h"
+#include "core/event/event_bus.h"
+#include "core/library/library.h"
+#include "core/audio/track_open.h"
+#include "core/audio/gapless_output.h"
+#include "core/audio/resample_output.h"
+#include "core/audio/audio_command.h"
+#include "core/audio/audio_telemetry.h"
+#include "core/audio/decode_bench.h"
+#include "core/audio/resume_store.h"
+#include "core/audio/shuffle_order.h"
 #include "ui/ui_root.h"
 
-#include <AudioFileSourceSD.h>
-#include <AudioGeneratorMP3.h>
-#include <AudioOutputI2S.h>
 #include <AudioOutputBuffer.h>
 
-#define MAX_FILES 200
-#define MAX_PATH_LEN 100
-
 static AppState gAppState;
 
-static char g_playlist[MAX_FILES][MAX_PATH_LEN];
-static int g_totalTracks = 0;
-
 static bool g_isMuted = false;
+// 按键改了界面状态，提交快照后让渲染任务立刻出一帧
+static bool g_uiDirty = false;
 
-AudioGeneratorMP3 *mp3 = nullptr;
-AudioFileSourceSD *file = nullptr;
+// 当前曲目的解码器，按格式每首新建
+AudioGenerator *decoder = nullptr;
+TrackSource *file = nullptr;
 AudioOutputBuffer *buff = nullptr;
-AudioOutputI2S *out = nullptr;
+GaplessOutput *gapOut = nullptr;
+ResampleOutput *resampOut = nullptr;
+
+// 剩余字节少于这个值时预先打开下一首（320kbps 下约 0.8 秒）
+#define GAPLESS_PREOPEN_BYTES (32 * 1024)
+// 码率高的格式（WAV 约 1411kbps）按剩余时长判断，同样留出约 0.8 秒
+#define GAPLESS_PREOPEN_MS 800
+// 快进/快退一次的时长
+#define SEEK_STEP_MS 5000
+// 电量读一次要走电源芯片，几秒一次足够
+#define BATTERY_POLL_MS 5000
+
+// 已打开并定位到首个音频帧、等待播放的曲目
+struct PreparedTrack
+{
+  TrackSource *file;
+  TrackHandle handle;
+  int index; // 打开时的序号；之后列表可能被重扫压缩，开始播放时按句柄重新取
+
+  PlayMode mode; // 选出该曲目时的播放模式，模式变了就作废
+  uint32_t openMs;
+  bool knownLayout; // 用了曲库记下的流范围，没有从文件开头找标签
+  char path[LIBRARY_MAX_PATH_LEN];
+};
+static PreparedTrack g_next = {};
+// 最近一次点播的打开信息，等第一个样本送出后和首样本延迟一起打印
+static uint32_t g_playOpenMs = 0;
+static bool g_playKnownLayout = false;
+
+// 开机读到的续播检查点：setup() 里写好，之后只由音频任务读写；第一次继续播放时用掉
+static ResumePoint g_resume;
+static bool g_resumePending = false;
+// 上一次写检查点的时间和内容，位置没变（暂停中）时不重复写
+static uint32_t g_lastCheckpointAt = 0;
+static uint32_t g_lastCheckpointHash = 0;
+static uint32_t g_lastCheckpointMs = 0xFFFFFFFFu;
 
-volatile AppEvent g_pendingEvent = AppEvent::NONE;
-volatile int g_seekDir = 0;
 TaskHandle_t TaskHandle_Audio;
 
 extern void uiShowBootAnim();
 
 // --- 辅助 ---
-const char *getPathByIndex(int index)
-{
-  if (index < 0 || index >= g_totalTracks)
-    return "";
-  return g_playlist[index];
-}
+// 正在播放（或等待续播）的曲目，只由音频任务写（setup() 在音频任务启动前写好初值）。
+// gAppState.currentTrackIdx/currentTitle 是 loop 所在任务收到 TRACK_CHANGED 后自己维护的副本
+static char g_currentPath[LIBRARY_MAX_PATH_LEN] = "";
+static int g_playIdx = 0;
 
-const char *getFileNameFromPath(const char *path)
+void copySafeTitle(char *out, size_t len)
 {
-  const char *slash = strrchr(path, '/');
-  return slash ? slash + 1 : path;
-}
-
-const char *getSafeTitle()
-{
-  if (g_totalTracks == 0)
-    return "NO FILES";
-  if (gAppState.currentTrackIdx < 0 || gAppState.currentTrackIdx >= g_totalTracks)
-    return "IDX ERR";
-  return getFileNameFromPath(g_playlist[gAppState.currentTrackIdx]);
+  const char *title;
+  int idx = gAppState.currentTrackIdx;
+  bool scanning = libraryIsScanning();
+  if (libraryGetCount() == 0)
+    title = scanning ? "SCANNING..." : "NO FILES";
+  else if (idx < 0 || idx >= libraryGetCount())
+    title = scanning ? "SCANNING..." : "IDX ERR";
+  else if (libraryCopyTitle(idx, out, len))
+    return;
+  else
+    title = "IDX ERR";
+
+  strncpy(out, title, len - 1);
+  out[len - 1] = '\0';
 }
 
 // --- UI 接口 ---
 bool audioEngineIsPlaying() { return gAppState.isPlaying; }
-int audioEngineGetTotalTracks() { return g_totalTracks; }
+int audioEngineGetTotalTracks() { return libraryGetCount(); }
 int audioEngineGetCurrentIndex() { return gAppState.currentTrackIdx; }
 const char *audioEngineGetCurrentTitle() { return gAppState.currentTitle; }
 bool audioEngineIsMuted() { return g_isMuted; }
 
-String audioEngineGetListItem(int index)
+// 标题（没有标签时为文件名）直接指向曲库 arena，不做拷贝
+const char *audioEngineGetListItem(int index)
 {
-  if (index >= 0 && index < g_totalTracks)
-  {
-    return String(getFileNameFromPath(g_playlist[index]));
-  }
-  return "";
+  return libraryGetDisplayName(index);
 }
 
 const std::vector<String> &audioEngineGetPlaylist()
@@ -75,151 +110,394 @@ const std::vector<String> &audioEngineGetPlaylist()
   return d;
 }
 
-// --- 文件扫描 ---
-void scanDir(File dir)
+// --- Audio Task ---
+// 打开曲目并解析流信息，文件定位到第一个音频帧
+static bool prepareTrack(TrackHandle h, PreparedTrack &t)
 {
-  while (true)
+  t.file = nullptr;
+  t.handle = h;
+  t.mode = gAppState.playMode;
+  TrackToOpen info;
+  info.index = -1;
+  if (!libraryGetTrackToOpen(h, info, t.path, sizeof(t.path)))
+    return false;
+
+  t.index = info.index;
+  t.knownLayout = info.hasLayout;
+  uint32_t openStart = millis();
+  t.file = trackOpen(t.path, info.format, t.knownLayout ? &info.layout : nullptr);
+  if (!t.file)
+    return false;
+  t.openMs = millis() - openStart;
+  audioTelemetryTrackOpen(t.openMs);
+  return true;
+}
+
+static void discardPrepared()
+{
+  if (g_next.file)
   {
-    if (g_totalTracks >= MAX_FILES)
-      break;
+    delete g_next.file;
+    g_next.file = nullptr;
+  }
+}
 
-    File entry = dir.openNextFile();
-    if (!entry)
-      break;
+static bool decoderRunning()
+{
+  return decoder && decoder->isRunning();
+}
 
-    platformUpdate();
+// 当前曲目剩余的字节或（按平均码率估算的）时长不多了
+static bool nearTrackEnd()
+{
+  uint32_t size = file->getSize();
+  uint32_t left = size - file->getPos();
+  if (left < GAPLESS_PREOPEN_BYTES)
+    return true;
+  uint32_t dur = file->durationMs();
+  return dur && size && (uint64_t)left * dur / size < GAPLESS_PREOPEN_MS;
+}
 
-    if (entry.isDirectory())
-    {
-      scanDir(entry);
-    }
-    else
-    {
-      String name = entry.name();
-      if (name.startsWith("."))
-        continue;
+// 把准备好的曲目交给对应格式的解码器；文件所有权转给全局 file。
+// at 不为空时从该落点开始（续播）。调用前旧解码器必须已经 stop()。
+// 解码器起不来时停止播放并返回 false
+static bool startPrepared(PreparedTrack &t, const TrackSeekPoint *at = nullptr)
+{
+  file = t.file;
+  t.file = nullptr;
+  gapOut->beginTrack(file->leadingTrim(), file->validSamples());
+  if (at)
+  {
+    gapOut->beginSeek(at->sample, at->exact);
+    file->seekTo(*at);
+  }
+  // 按流的采样率配置输出（直通并切换 I2S，或重采样），不等解码出第一帧
+  if (file->sampleRate())
+    gapOut->SetRate(file->sampleRate());
+  delete decoder;
+  decoder = trackNewDecoder(file);
+  if (!decoder->begin(file, gapOut))
+  {
+    // 无缝切歌时过渡标记还挂着：先撤销，让这次 stop() 真正停下 I2S
+    gapOut->cancelTransition();
+    gapOut->stop();
+    gAppState.isPlaying = false;
+    Serial.printf("[AUDIO] Decoder start failed: %s\n", t.path);
+    return false;
+  }
+  audioTelemetryTrackFormat(file->format());
+
+  // 预开之后列表可能已被重扫压缩：按句柄取当前序号；曲目已被删掉时序号不动
+  int idx = libraryFindHandle(t.handle, t.index);
+  if (idx >= 0)
+    g_playIdx = idx;
+  gAppState.elapsedMs = 0;
+  gAppState.durationMs = file->durationMs();
+  gAppState.isPlaying = true;
+  snprintf(g_currentPath, sizeof(g_currentPath), "%s", t.path);
+  // 新曲目的检查点在几秒后写，不拖慢无缝衔接
+  g_lastCheckpointAt = millis() - RESUME_CHECKPOINT_MS + RESUME_TRACK_SETTLE_MS;
+
+  // 序号和标题由 loop 所在任务收到事件后自己更新
+  Event ev = {};
+  ev.type = EventType::TRACK_CHANGED;
+  ev.data.track.index = g_playIdx;
+  eventBusPublish(ev);
+  return true;
+}
 
-      if (name.endsWith(".mp3") || name.endsWith(".MP3"))
-      {
-        String path = entry.path();
-        if (path == "")
-          path = "/" + name;
+// 按播放模式决定当前曲目之后播哪一首
+static int pickNextIndex()
+{
+  int total = libraryGetCount();
+  if (total <= 0)
+    return 0;
+  if (gAppState.playMode == PlayMode::SHUFFLE)
+    return shuffleNext(g_playIdx);
+  if (gAppState.playMode == PlayMode::REPEAT)
+    return g_playIdx < total ? g_playIdx : 0;
+  int next = g_playIdx + 1;
+  return next >= total ? 0 : next;
+}
 
-        if (path.length() < MAX_PATH_LEN)
-        {
-          strncpy(g_playlist[g_totalTracks], path.c_str(), MAX_PATH_LEN - 1);
-          g_playlist[g_totalTracks][MAX_PATH_LEN - 1] = '\0';
-          g_totalTracks++;
-        }
-      }
-    }
-    entry.close();
+// 上一首/下一首按键：随机模式沿洗牌顺序走（上一首是真正播过的那首），其它模式按列表序号循环
+static int pickStepIndex(int dir)
+{
+  int total = libraryGetCount();
+  if (total <= 0)
+    return 0;
+  int cur = g_playIdx;
+  if (gAppState.playMode == PlayMode::SHUFFLE)
+    return dir > 0 ? shuffleNext(cur) : shufflePrev(cur);
+  int idx = cur + (dir > 0 ? 1 : -1);
+  if (idx < 0)
+    return total - 1;
+  return idx >= total ? 0 : idx;
+}
+
+// 停掉当前曲目（丢弃预开的下一首），再打开 h 开始播放
+static void playTrack(TrackHandle h)
+{
+  g_resumePending = false;
+  gapOut->beginOpen();
+  // 不再硬静音：缓冲里旧曲目的末尾淡出，新曲目淡入
+  platformAudioMarkDiscontinuity();
+  discardPrepared();
+
+  if (decoderRunning())
+    decoder->stop();
+  if (file)
+  {
+    delete file;
+    file = nullptr;
+  }
+
+  PreparedTrack t;
+  if (prepareTrack(h, t))
+  {
+    Serial.printf("[AUDIO] Play: %s\n", t.path);
+    g_playOpenMs = t.openMs;
+    g_playKnownLayout = t.knownLayout;
+    startPrepared(t);
+  }
+  else
+  {
+    gAppState.isPlaying = false;
+    if (libraryGetCount() > 0)
+      Serial.println("[AUDIO] Open Failed");
   }
 }
 
-// --- Audio Task ---
+// 按时间定位到帧边界，再重启解码器（丢掉旧位置残留的解码状态），文件和预读缓冲不关闭
+static void seekBy(int32_t deltaMs)
+{
+  if (!file || !decoderRunning())
+    return;
+
+  int32_t target = (int32_t)gapOut->positionMs() + deltaMs;
+  int32_t duration = (int32_t)file->durationMs();
+  if (target < 0)
+    target = 0;
+  if (duration > SEEK_STEP_MS && target > duration - 1000)
+    target = duration - 1000;
+
+  TrackSeekPoint pt;
+  if (!file->locate(target, pt))
+    return;
+
+  platformAudioMarkDiscontinuity();
+  gapOut->beginSeek(pt.sample, pt.exact);
+  file->holdOpen(true);
+  decoder->stop();
+  file->holdOpen(false);
+  file->seekTo(pt);
+  decoder->begin(file, gapOut);
+}
+
+// 记下当前曲目和位置，未到间隔且 force 为 false 时不写；这里只填好检查点，SD 写入交给后台写入任务。
+// 落点只用不读文件的 locateQuick()（可能早于记下的时间，续播时再用 refineTo() 走到准确的帧），
+// 给不出时只记毫秒数，续播时再定位
+static void checkpoint(bool force)
+{
+  if (!file || !g_currentPath[0] || strlen(g_currentPath) >= RESUME_PATH_MAX)
+    return;
+  if (!force && millis() - g_lastCheckpointAt < RESUME_CHECKPOINT_MS)
+    return;
+  g_lastCheckpointAt = millis();
+  shuffleCapture();
+
+  ResumePoint rp;
+  uint32_t pos = gapOut->positionMs();
+  rp.positionMs = pos > RESUME_REWIND_MS ? pos - RESUME_REWIND_MS : 0;
+  rp.pathHash = resumePathHash(g_currentPath);
+  if (rp.pathHash == g_lastCheckpointHash && rp.positionMs == g_lastCheckpointMs)
+    return;
+
+  memset(&rp.at, 0, sizeof(rp.at));
+  if (rp.positionMs && !file->locateQuick(rp.positionMs, rp.at))
+    memset(&rp.at, 0, sizeof(rp.at));
+  rp.size = file->getSize();
+  rp.index = g_playIdx;
+  strcpy(rp.path, g_currentPath);
+  resumeWriterPost(rp);
+  g_lastCheckpointHash = rp.pathHash;
+  g_lastCheckpointMs = rp.positionMs;
+}
+
+// 按检查点里的路径直接打开（不在曲库里查找），文件大小对得上就从记下的落点开始
+static bool resumeFromCheckpoint()
+{
+  g_resumePending = false;
+  gapOut->beginOpen();
+
+  PreparedTrack t = {};
+  t.index = g_playIdx;
+  t.handle = libraryGetHandle(libraryFindPath(g_resume.path));
+  t.mode = gAppState.playMode;
+  snprintf(t.path, sizeof(t.path), "%s", g_resume.path);
+  uint32_t openStart = millis();
+  t.file = trackOpen(t.path, audioFormatFromName(t.path));
+  if (!t.file)
+    return false;
+  if (t.file->getSize() != g_resume.size)
+  {
+    Serial.printf("[AUDIO] Resume: %s changed, starting over\n", t.path);
+    delete t.file;
+    return false;
+  }
+  t.openMs = millis() - openStart;
+  audioTelemetryTrackOpen(t.openMs);
+
+  // 检查点里没有字节落点时（FLAC、非精确索引）才需要在这里定位
+  TrackSeekPoint at = g_resume.at;
+  bool seek = g_resume.positionMs > 0 &&
+              (at.offset ? t.file->refineTo(g_resume.positionMs, at) : t.file->locate(g_resume.positionMs, at));
+  Serial.printf("[AUDIO] Resume: %s at %lu ms\n", t.path, (unsigned long)(seek ? g_resume.positionMs : 0));
+  g_playOpenMs = t.openMs;
+  g_playKnownLayout = false;
+  return startPrepared(t, seek ? &at : nullptr);
+}
+
+static void handleCommand(const AudioCommand &cmd)
+{
+  switch (cmd.type)
+  {
+  case AudioCmdType::PLAY_TRACK:
+    playTrack((TrackHandle)cmd.arg);
+    break;
+
+  case AudioCmdType::NEXT:
+    playTrack(libraryGetHandle(pickStepIndex(1)));
+    break;
+
+  case AudioCmdType::PREV:
+    playTrack(libraryGetHandle(pickStepIndex(-1)));
+    break;
+
+  case AudioCmdType::RESUME:
+    if (decoderRunning())
+      gAppState.isPlaying = true;
+    else if (!(g_resumePending && resumeFromCheckpoint()))
+      playTrack((TrackHandle)cmd.arg);
+    break;
+
+  case AudioCmdType::PAUSE:
+    gAppState.isPlaying = false;
+    checkpoint(true);
+    break;
+
+  case AudioCmdType::STOP:
+    checkpoint(true);
+    discardPrepared();
+    if (decoderRunning())
+      decoder->stop();
+    gAppState.isPlaying = false;
+    break;
+
+  case AudioCmdType::SEEK:
+    seekBy(cmd.arg);
+    break;
+
+  case AudioCmdType::SET_VOLUME:
+    platformAudioSetVolume((uint8_t)cmd.arg);
+    break;
+
+  case AudioCmdType::SET_MUTE:
+    platformAudioSetMuted(cmd.arg != 0);
+    break;
+  }
+}
+
+// 后台重扫改动列表后，按路径重新定位正在播放的曲目，序号变了就发 TRACK_CHANGED
+static void relocateCurrent()
+{
+  static uint32_t lastGen = 0;
+  uint32_t gen = libraryGetGeneration();
+  if (gen == lastGen)
+    return;
+  lastGen = gen;
+
+  int total = libraryGetCount();
+  int idx = g_currentPath[0] ? libraryFindPath(g_currentPath) : -1;
+  if (idx < 0)
+    idx = g_playIdx < total ? g_playIdx : (total > 0 ? total - 1 : 0);
+  if (idx == g_playIdx)
+    return;
+  g_playIdx = idx;
+
+  Event ev = {};
+  ev.type = EventType::TRACK_CHANGED;
+  ev.data.track.index = idx;
+  eventBusPublish(ev);
+}
+
 void Task_Audio_Loop(void *pvParameters)
 {
   vTaskDelay(500);
 
   platformAudioInit(44100);
   buff = (AudioOutputBuffer *)platformGetAudioOutputPtr();
-  mp3 = new AudioGeneratorMP3();
+  resampOut = new ResampleOutput(buff);
+  const uint32_t *rates;
+  uint8_t rateCount = platformAudioGetOutputRates(&rates);
+  resampOut->setOutputRates(rates, rateCount);
+  gapOut = new GaplessOutput(resampOut);
 
-  if (!g_isMuted)
-    platformAudioSetVolume(gAppState.volume);
+  platformAudioSetVolume(gAppState.volume);
+  platformAudioSetMuted(g_isMuted);
 
   while (true)
   {
-    if (g_pendingEvent != AppEvent::NONE)
+    // 按到达顺序处理完所有命令，不加锁
+    relocateCurrent();
+    AudioCommand cmd;
+    while (audioCmdPop(cmd))
+      handleCommand(cmd);
+
+    // 无缝模式：快到结尾时预先打开下一首
+    if (gAppState.gapless && gAppState.isPlaying && file && decoderRunning())
     {
-      AppEvent evt = g_pendingEvent;
-      g_pendingEvent = AppEvent::NONE;
-
-      if (evt == AppEvent::SELECT_SONG || evt == AppEvent::NEXT || evt == AppEvent::PREV || evt == AppEvent::PLAY || evt == AppEvent::REFRESH)
-      {
-        platformAudioSetVolume(0);
-
-        if (mp3->isRunning())
-          mp3->stop();
-        if (file)
-        {
-          delete file;
-          file = nullptr;
-        }
-
-        if (g_totalTracks > 0 && gAppState.currentTrackIdx < g_totalTracks)
-        {
-          const char *path = g_playlist[gAppState.currentTrackIdx];
-          Serial.printf("[AUDIO] Play: %s\n", path);
-
-          file = new AudioFileSourceSD(path);
-          if (file && file->isOpen())
-          {
-            mp3->begin(file, buff);
-            gAppState.isPlaying = true;
-            strncpy(gAppState.currentTitle, getSafeTitle(), 63);
-          }
-          else
-          {
-            Serial.println("[AUDIO] Open Failed");
-          }
-        }
-        if (!g_isMuted)
-          platformAudioSetVolume(gAppState.volume);
-      }
-      else if (evt == AppEvent::STOP)
-      {
-        if (mp3->isRunning())
-          mp3->stop();
-        gAppState.isPlaying = false;
-      }
-      else if (evt == AppEvent::PAUSE)
-      {
-        gAppState.isPlaying = false;
-      }
-      else if (evt == AppEvent::VOL_UP || evt == AppEvent::VOL_DOWN)
-      {
-        if (!g_isMuted)
-          platformAudioSetVolume(gAppState.volume);
-      }
+      if (g_next.file && g_next.mode != gAppState.playMode)
+        discardPrepared();
+      if (!g_next.file && nearTrackEnd())
+        prepareTrack(libraryGetHandle(pickNextIndex()), g_next);
     }
 
-    if (g_seekDir != 0 && file && mp3->isRunning())
+    if (file)
     {
-      platformAudioSetVolume(0);
-      int current = file->getPos();
-      int target = current + (g_seekDir * 32000);
-      if (target < 0)
-        target = 0;
-      if (target > file->getSize())
-        target = file->getSize() - 1024;
-      file->seek(target, SEEK_SET);
-      g_seekDir = 0;
-      if (!g_isMuted)
-        platformAudioSetVolume(gAppState.volume);
+      gAppState.elapsedMs = gapOut->positionMs();
+      gAppState.durationMs = file->durationMs();
     }
 
-    if (gAppState.isPlaying && mp3->isRunning())
+    if (gAppState.isPlaying && decoderRunning())
     {
-      if (!mp3->loop())
+      uint32_t decodeStart = micros();
+      bool running = decoder->loop();
+      audioTelemetryDecode(micros() - decodeStart, running);
+      uint32_t firstUs;
+      if (gapOut->takeFirstSampleUs(firstUs))
       {
-        mp3->stop();
-        if (gAppState.playMode == PlayMode::SHUFFLE)
-        {
-          gAppState.currentTrackIdx = random(0, g_totalTracks);
-        }
-        else if (gAppState.playMode == PlayMode::REPEAT)
+        Serial.printf("[AUDIO] First sample %lu ms after play (open %lu ms, %s)\n",
+                      (unsigned long)(firstUs / 1000), (unsigned long)g_playOpenMs,
+                      g_playKnownLayout ? "cached layout" : "parsed tags");
+        audioTelemetryFirstSample(firstUs / 1000);
+      }
+      checkpoint(false);
+      if (!running)
+      {
+        if (gAppState.gapless && g_next.file && g_next.mode == gAppState.playMode)
         {
+          // 过渡期间 stop() 不下传，I2S 不停、不静音，下一首直接接上
+          gapOut->beginTransition();
+          decoder->stop();
+          delete file;
+          file = nullptr;
+          startPrepared(g_next);
         }
         else
         {
-          gAppState.currentTrackIdx++;
+          playTrack(libraryGetHandle(pickNextIndex()));
         }
-
-        if (gAppState.currentTrackIdx >= g_totalTracks)
-          gAppState.currentTrackIdx = 0;
-        g_pendingEvent = AppEvent::SELECT_SONG;
       }
     }
     else
@@ -230,167 +508,258 @@ void Task_Audio_Loop(void *pvParameters)
   }
 }
 
-// --- 按键逻辑（完全保留） ---
+// --- 事件发布 ---
+// 请求带上发布时这个序号上的曲目句柄，排队期间列表被压缩也不会播错
+static void publishTrack(EventType type, int32_t index)
+{
+  Event ev = {};
+  ev.type = type;
+  ev.data.track.index = index;
+  ev.data.track.handle = libraryGetHandle(index);
+  eventBusPublish(ev);
+}
+
+static void publishSeek(int32_t deltaMs)
+{
+  Event ev = {};
+  ev.type = EventType::SEEK_REQUEST;
+  ev.data.seek.deltaMs = deltaMs;
+  eventBusPublish(ev);
+}
+
+static void publishVolume()
+{
+  Event ev = {};
+  ev.type = EventType::VOLUME_CHANGED;
+  ev.data.volume.level = gAppState.volume;
+  ev.data.volume.muted = g_isMuted;
+  eventBusPublish(ev);
+}
+
+static void publishConfig(ConfigKey key, int32_t value)
+{
+  Event ev = {};
+  ev.type = EventType::CONFIG_CHANGED;
+  ev.data.config.key = key;
+  ev.data.config.value = value;
+  eventBusPublish(ev);
+}
+
+// --- 按键逻辑 ---
 void handleInput()
 {
   platformUpdate();
 
   KeyEvent kev;
-  static uint32_t lastKeyTime = 0;
-
   if (platformPollKeyEvent(kev))
   {
-    if (!kev.pressed)
-      return;
-    if (millis() - lastKeyTime < 150)
-      return;
-    lastKeyTime = millis();
+    Event ev = {};
+    ev.type = EventType::KEY_EVENT;
+    ev.data.key = kev;
+    eventBusPublish(ev);
+  }
+}
 
-    bool updateUI = true;
-    bool saveConfig = false;
+static void onKeyEvent(const Event &e)
+{
+  const KeyEvent &kev = e.data.key;
+  static uint32_t lastKeyTime = 0;
 
-    switch (kev.code)
-    {
-    case KeyCode::PLAY_PAUSE:
-      if (gAppState.isPlaying)
-      {
-        gAppState.isPlaying = false;
-        g_pendingEvent = AppEvent::PAUSE;
-      }
-      else
-      {
-        gAppState.isPlaying = true;
-        if (!mp3 || !mp3->isRunning())
-          g_pendingEvent = AppEvent::PLAY;
-      }
-      break;
+  if (!kev.pressed)
+    return;
+  if (millis() - lastKeyTime < 150)
+    return;
+  lastKeyTime = millis();
 
-    case KeyCode::REFRESH:
-      g_pendingEvent = AppEvent::REFRESH;
-      gAppState.isPlaying = true;
-      break;
+  bool updateUI = true;
 
-    case KeyCode::LIST:
+  switch (kev.code)
+  {
+  case KeyCode::PLAY_PAUSE:
+    if (gAppState.isPlaying)
+      eventBusPublish(EventType::PAUSE_REQUEST);
+    else
+      publishTrack(EventType::RESUME_REQUEST, gAppState.currentTrackIdx);
+    break;
+
+  case KeyCode::REFRESH:
+    publishTrack(EventType::PLAY_REQUEST, gAppState.currentTrackIdx);
+    break;
+
+  case KeyCode::LIST:
+    gAppState.uiMode = UiMode::BROWSER;
+    gAppState.browserCursor = gAppState.currentTrackIdx;
+    break;
+
+  case KeyCode::OK:
+    if (gAppState.uiMode == UiMode::BROWSER)
+    {
+      // 当前序号等音频任务真正开始播放、发回 TRACK_CHANGED 时再更新
+      gAppState.uiMode = UiMode::PLAYER;
+      publishTrack(EventType::PLAY_REQUEST, gAppState.browserCursor);
+    }
+    else
+    {
       gAppState.uiMode = UiMode::BROWSER;
       gAppState.browserCursor = gAppState.currentTrackIdx;
-      break;
-
-    case KeyCode::OK:
-      if (gAppState.uiMode == UiMode::BROWSER)
-      {
-        gAppState.currentTrackIdx = gAppState.browserCursor;
-        gAppState.uiMode = UiMode::PLAYER;
-        g_pendingEvent = AppEvent::SELECT_SONG;
-        saveConfig = true;
-      }
-      else
-      {
-        gAppState.uiMode = UiMode::BROWSER;
-        gAppState.browserCursor = gAppState.currentTrackIdx;
-      }
-      break;
+    }
+    break;
 
-    case KeyCode::BACK:
-      if (gAppState.uiMode == UiMode::BROWSER)
-      {
-        gAppState.uiMode = UiMode::PLAYER;
-      }
-      else
-      {
-        gAppState.isPlaying = false;
-        g_pendingEvent = AppEvent::STOP;
-      }
-      break;
+  case KeyCode::BACK:
+    if (gAppState.uiMode == UiMode::BROWSER)
+      gAppState.uiMode = UiMode::PLAYER;
+    else
+      eventBusPublish(EventType::STOP_REQUEST);
+    break;
 
-    case KeyCode::UP:
-      if (gAppState.uiMode == UiMode::BROWSER)
-      {
-        gAppState.browserCursor--;
-        if (gAppState.browserCursor < 0)
-          gAppState.browserCursor = g_totalTracks - 1;
-      }
-      else
-      {
-        gAppState.currentTrackIdx--;
-        if (gAppState.currentTrackIdx < 0)
-          gAppState.currentTrackIdx = g_totalTracks - 1;
-        g_pendingEvent = AppEvent::PREV;
-        saveConfig = true;
-      }
-      break;
+  case KeyCode::UP:
+    if (gAppState.uiMode == UiMode::BROWSER)
+    {
+      gAppState.browserCursor--;
+      if (gAppState.browserCursor < 0)
+        gAppState.browserCursor = libraryGetCount() - 1;
+    }
+    else
+    {
+      eventBusPublish(EventType::PREV_REQUEST);
+    }
+    break;
 
-    case KeyCode::DOWN:
-      if (gAppState.uiMode == UiMode::BROWSER)
-      {
-        gAppState.browserCursor++;
-        if (gAppState.browserCursor >= g_totalTracks)
-          gAppState.browserCursor = 0;
-      }
-      else
-      {
-        gAppState.currentTrackIdx++;
-        if (gAppState.currentTrackIdx >= g_totalTracks)
-          gAppState.currentTrackIdx = 0;
-        g_pendingEvent = AppEvent::NEXT;
-        saveConfig = true;
-      }
-      break;
-
-    case KeyCode::LEFT:
-      if (gAppState.uiMode == UiMode::PLAYER)
-        g_seekDir = -1;
-      break;
-    case KeyCode::RIGHT:
-      if (gAppState.uiMode == UiMode::PLAYER)
-        g_seekDir = 1;
-      break;
-
-    case KeyCode::VOL_INC:
-      g_isMuted = false;
-      gAppState.volume += 2;
-      if (gAppState.volume > 100)
-        gAppState.volume = 100;
-      platformAudioSetVolume(gAppState.volume);
-      saveConfig = true;
-      lastKeyTime = millis() - 100;
-      break;
-    case KeyCode::VOL_DEC:
-      g_isMuted = false;
-      gAppState.volume -= 2;
-      if (gAppState.volume < 0)
-        gAppState.volume = 0;
-      platformAudioSetVolume(gAppState.volume);
-      saveConfig = true;
-      lastKeyTime = millis() - 100;
-      break;
-
-    case KeyCode::MODE_SWITCH:
-      if (gAppState.playMode == PlayMode::SEQUENCE)
-        gAppState.playMode = PlayMode::REPEAT;
-      else if (gAppState.playMode == PlayMode::REPEAT)
-        gAppState.playMode = PlayMode::SHUFFLE;
-      else
-        gAppState.playMode = PlayMode::SEQUENCE;
-      saveConfig = true;
-      break;
-
-    case KeyCode::MUTE_TOGGLE:
-      g_isMuted = !g_isMuted;
-      if (g_isMuted)
-        platformAudioSetVolume(0);
-      else
-        platformAudioSetVolume(gAppState.volume);
-      break;
-
-    default:
-      updateUI = false;
-      break;
+  case KeyCode::DOWN:
+    if (gAppState.uiMode == UiMode::BROWSER)
+    {
+      gAppState.browserCursor++;
+      if (gAppState.browserCursor >= libraryGetCount())
+        gAppState.browserCursor = 0;
+    }
+    else
+    {
+      eventBusPublish(EventType::NEXT_REQUEST);
     }
+    break;
+
+  case KeyCode::LEFT:
+    if (gAppState.uiMode == UiMode::PLAYER)
+      publishSeek(-SEEK_STEP_MS);
+    break;
+  case KeyCode::RIGHT:
+    if (gAppState.uiMode == UiMode::PLAYER)
+      publishSeek(SEEK_STEP_MS);
+    break;
+
+  case KeyCode::VOL_INC:
+    g_isMuted = false;
+    gAppState.volume += 2;
+    if (gAppState.volume > 100)
+      gAppState.volume = 100;
+    publishVolume();
+    publishConfig(ConfigKey::VOLUME, gAppState.volume);
+    lastKeyTime = millis() - 100;
+    break;
+  case KeyCode::VOL_DEC:
+    g_isMuted = false;
+    gAppState.volume -= 2;
+    if (gAppState.volume < 0)
+      gAppState.volume = 0;
+    publishVolume();
+    publishConfig(ConfigKey::VOLUME, gAppState.volume);
+    lastKeyTime = millis() - 100;
+    break;
+
+  case KeyCode::MODE_SWITCH:
+    if (gAppState.playMode == PlayMode::SEQUENCE)
+      gAppState.playMode = PlayMode::REPEAT;
+    else if (gAppState.playMode == PlayMode::REPEAT)
+      gAppState.playMode = PlayMode::SHUFFLE;
+    else
+      gAppState.playMode = PlayMode::SEQUENCE;
+    publishConfig(ConfigKey::PLAY_MODE, (int32_t)gAppState.playMode);
+    break;
+
+  case KeyCode::RESCAN:
+    // 逐个目录比对指纹：FAT 只更新直接父目录的修改时间，更深处新增的专辑浅层重扫看不到
+    libraryRequestRescan(RescanMode::DEEP);
+    updateUI = false;
+    break;
+
+  case KeyCode::GAPLESS_TOGGLE:
+    gAppState.gapless = !gAppState.gapless;
+    publishConfig(ConfigKey::GAPLESS, gAppState.gapless);
+    break;
+
+  case KeyCode::DEBUG_TOGGLE:
+    audioTelemetrySetEnabled(!audioTelemetryEnabled());
+    break;
+
+  case KeyCode::MUTE_TOGGLE:
+    g_isMuted = !g_isMuted;
+    publishVolume();
+    break;
+
+  default:
+    updateUI = false;
+    break;
+  }
 
-    if (updateUI)
-      uiRender();
-    if (saveConfig)
-      configSave(&gAppState);
+  if (updateUI)
+    g_uiDirty = true;
+}
+
+// 播放请求转成音频命令；事件总线在 loop 任务里分发，保证命令队列只有一个生产者
+static void onPlaybackRequest(const Event &ev)
+{
+  switch (ev.type)
+  {
+  case EventType::PLAY_REQUEST:
+    audioCmdPush(AudioCmdType::PLAY_TRACK, (int32_t)ev.data.track.handle);
+    break;
+  case EventType::RESUME_REQUEST:
+    audioCmdPush(AudioCmdType::RESUME, (int32_t)ev.data.track.handle);
+    break;
+  case EventType::NEXT_REQUEST:
+    audioCmdPush(AudioCmdType::NEXT);
+    break;
+  case EventType::PREV_REQUEST:
+    audioCmdPush(AudioCmdType::PREV);
+    break;
+  case EventType::PAUSE_REQUEST:
+    audioCmdPush(AudioCmdType::PAUSE);
+    break;
+  case EventType::STOP_REQUEST:
+    audioCmdPush(AudioCmdType::STOP);
+    break;
+  case EventType::SEEK_REQUEST:
+    audioCmdPush(AudioCmdType::SEEK, ev.data.seek.deltaMs);
+    break;
+  default:
+    break;
+  }
+}
+
+static void onVolumeChanged(const Event &ev)
+{
+  audioCmdPush(AudioCmdType::SET_VOLUME, ev.data.volume.level);
+  audioCmdPush(AudioCmdType::SET_MUTE, ev.data.volume.muted);
+}
+
+// 只改内存里的配置，由 configPoll() 合并后写 NVS
+static void onConfigChanged(const Event &ev)
+{
+  configSet(ev.data.config.key, ev.data.config.value);
+}
+
+// 音频任务开始播放一首歌（含自动切歌、无缝衔接）或重扫后重新定位后发布；
+// 界面看到的当前序号和标题只在这里（loop 所在任务）更新
+static void onTrackChanged(const Event &ev)
+{
+  gAppState.currentTrackIdx = ev.data.track.index;
+  copySafeTitle(gAppState.currentTitle, sizeof(gAppState.currentTitle));
+
+  static int32_t lastSavedIdx = -1;
+  if (ev.data.track.index != lastSavedIdx)
+  {
+    lastSavedIdx = ev.data.track.index;
+    publishConfig(ConfigKey::TRACK_INDEX, ev.data.track.index);
   }
 }
 
@@ -404,67 +773,119 @@ void setup()
   // 赛博开机动画
   uiShowBootAnim();
 
+  eventBusInit();
+#ifdef EVENT_BUS_BENCHMARK
+  eventBusRunBenchmark(20000);
+#endif
+#ifdef DECODE_BENCHMARK
+  // 在音频任务启动前跑完，结果不受播放和曲库扫描干扰
+  decodeBenchRun(DECODE_BENCH_DIR);
+  resampleBenchRun();
+#endif
+  eventBusSubscribe(EventType::KEY_EVENT, onKeyEvent);
+  eventBusSubscribe(EventType::PLAY_REQUEST, onPlaybackRequest);
+  eventBusSubscribe(EventType::RESUME_REQUEST, onPlaybackRequest);
+  eventBusSubscribe(EventType::NEXT_REQUEST, onPlaybackRequest);
+  eventBusSubscribe(EventType::PREV_REQUEST, onPlaybackRequest);
+  eventBusSubscribe(EventType::PAUSE_REQUEST, onPlaybackRequest);
+  eventBusSubscribe(EventType::STOP_REQUEST, onPlaybackRequest);
+  eventBusSubscribe(EventType::SEEK_REQUEST, onPlaybackRequest);
+  eventBusSubscribe(EventType::VOLUME_CHANGED, onVolumeChanged);
+  eventBusSubscribe(EventType::TRACK_CHANGED, onTrackChanged);
+  eventBusSubscribe(EventType::CONFIG_CHANGED, onConfigChanged);
+
   configInit();
+  platformOnShutdown(configFlush);
   AppState loaded;
   configLoad(&loaded);
   gAppState.volume = loaded.volume;
   gAppState.currentTrackIdx = loaded.currentTrackIdx;
   gAppState.inBrowser = false;
   gAppState.playMode = loaded.playMode;
+  gAppState.gapless = loaded.gapless;
   gAppState.isPlaying = false;
 
-  if (SD.cardType() != CARD_NONE)
-  {
-    File root = SD.open("/");
-    scanDir(root);
-    root.close();
-    Serial.printf("Loaded %d songs\n", g_totalTracks);
+  // 只读索引，不遍历目录；索引不可用时由后台任务边扫边填充列表
+  libraryInit();
+  libraryLoad();
+  Serial.printf("Loaded %d songs\n", libraryGetCount());
 
-    if (g_totalTracks > 0)
-    {
-      strncpy(gAppState.currentTitle, getSafeTitle(), 63);
-    }
-    else
-    {
-      strncpy(gAppState.currentTitle, "No Files", 63);
-    }
+  // 续播：播放只靠检查点里的路径；列表序号先核对记下的提示，对不上才按路径找
+  if (resumeStoreLoad(g_resume))
+  {
+    g_resumePending = true;
+    snprintf(g_currentPath, sizeof(g_currentPath), "%s", g_resume.path);
+    gAppState.elapsedMs = g_resume.positionMs;
+    char path[LIBRARY_MAX_PATH_LEN];
+    int idx = g_resume.index;
+    if (!libraryCopyPath(idx, path, sizeof(path)) || strcmp(path, g_resume.path) != 0)
+      idx = libraryFindPath(g_resume.path);
+    if (idx >= 0)
+      gAppState.currentTrackIdx = idx;
+    Serial.printf("Resume point: %s at %lu ms\n", g_resume.path, (unsigned long)g_resume.positionMs);
   }
+  shuffleLoad();
+  resumeWriterStart();
+  g_playIdx = gAppState.currentTrackIdx;
+  copySafeTitle(gAppState.currentTitle, sizeof(gAppState.currentTitle));
 
   xTaskCreatePinnedToCore(Task_Audio_Loop, "Audio", 65536, NULL, 2, &TaskHandle_Audio, 0);
-  platformAudioSetVolume(gAppState.volume);
 
-  uiRender();
+  // 后台扫描/校验曲库，之后按 S 键触发增量重扫
+  libraryStartBackgroundTask();
+
+  uiSubmitState(&gAppState);
+  uiStartRenderTask();
+}
+
+// 后台重扫改动列表后收拢浏览光标；当前曲目由音频任务按路径重新定位，经 TRACK_CHANGED 送回
+void syncLibraryGeneration()
+{
+  static uint32_t lastGen = 0;
+  uint32_t gen = libraryGetGeneration();
+  if (gen == lastGen)
+    return;
+  lastGen = gen;
+
+  int total = libraryGetCount();
+  if (gAppState.browserCursor >= total)
+    gAppState.browserCursor = total > 0 ? total - 1 : 0;
+  Serial.printf("Library updated: %d songs\n", total);
 }
 
 void loop()
 {
   handleInput();
+  eventBusPoll();
+  syncLibraryGeneration();
+  audioTelemetryPoll();
+  configPoll();
 
-  static uint32_t lastDraw = 0;
-  if (millis() - lastDraw > 40)
+  static uint32_t lastTitleSync = 0;
+  if (millis() - lastTitleSync > 40)
   {
     if (!gAppState.inBrowser)
     {
-      const char *title = getSafeTitle();
-      if (strncmp(gAppState.currentTitle, title, 63) != 0)
-      {
-        strncpy(gAppState.currentTitle, title, 63);
-        gAppState.currentTitle[63] = '\0';
-      }
+      char title[sizeof(gAppState.currentTitle)];
+      copySafeTitle(title, sizeof(title));
+      if (strcmp(gAppState.currentTitle, title) != 0)
+        memcpy(gAppState.currentTitle, title, sizeof(title));
     }
-    uiRender();
-    lastDraw = millis();
+    lastTitleSync = millis();
   }
 
-  static uint32_t lastSave = 0;
-  static int lastSavedIdx = -1;
-  if (millis() - lastSave > 5000)
+  static uint32_t lastBatteryPoll = 0;
+  if (!lastBatteryPoll || millis() - lastBatteryPoll > BATTERY_POLL_MS)
   {
-    if (gAppState.currentTrackIdx != lastSavedIdx)
-    {
-      configSave(&gAppState);
-      lastSavedIdx = gAppState.currentTrackIdx;
-    }
-    lastSave = millis();
+    gAppState.batteryLevel = platformGetBattery().level;
+    lastBatteryPoll = millis();
+  }
+
+  // 渲染在独立任务里进行，这里只交出状态快照，不等待绘制
+  uiSubmitState(&gAppState);
+  if (g_uiDirty)
+  {
+    g_uiDirty = false;
+    uiRequestFrame();
   }
 }
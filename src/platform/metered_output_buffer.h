@@ -0,0 +1,62 @@
+#pragma once
+#include <AudioOutputBuffer.h>
+
+// 读写指针在 AudioOutputBuffer 里是 protected，派生一层：
+//   - 把填充量读出来
+//   - 采样率变化时先把缓冲里旧采样率的数据送完再切换下游（否则这段数据会按新采样率播放，变调）
+class MeteredOutputBuffer : public AudioOutputBuffer
+{
+public:
+    MeteredOutputBuffer(int bytes, AudioOutput *dest) : AudioOutputBuffer(bytes, dest), pendingRate(0) {}
+
+    virtual bool SetRate(int hz) override
+    {
+        // 还没开始往下游送（filled 为 false）时缓冲里的数据不会先播放，直接切换
+        if (!filled || bufferedFrames() == 0)
+        {
+            pendingRate = 0;
+            return AudioOutputBuffer::SetRate(hz);
+        }
+        pendingRate = hz;
+        return true;
+    }
+
+    virtual bool ConsumeSample(int16_t sample[2]) override
+    {
+        if (pendingRate)
+        {
+            // 新采样率的样本先不收，直到旧数据全部送出
+            while (readPtr != writePtr)
+            {
+                int16_t s[2] = {leftSample[readPtr], rightSample[readPtr]};
+                if (!sink->ConsumeSample(s))
+                    return false;
+                readPtr = (readPtr + 1) % buffSize;
+            }
+            AudioOutputBuffer::SetRate(pendingRate);
+            pendingRate = 0;
+        }
+        return AudioOutputBuffer::ConsumeSample(sample);
+    }
+
+    // 缓冲中尚未送出的帧数（buffSize 和读写指针都以帧为单位）
+    uint32_t bufferedFrames() const
+    {
+        if (buffSize <= 0)
+            return 0;
+        int used = writePtr - readPtr;
+        if (used < 0)
+            used += buffSize;
+        return (uint32_t)used;
+    }
+
+    uint8_t fillPercent() const
+    {
+        if (buffSize <= 0)
+            return 0;
+        return (uint8_t)(bufferedFrames() * 100 / buffSize);
+    }
+
+private:
+    int pendingRate;
+};
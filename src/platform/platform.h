@@ -6,7 +6,8 @@ enum class PlatformModel
 {
     UNKNOWN,
     CARDPUTER_V1,
-    CARDPUTER_ADV
+    CARDPUTER_ADV,
+    NATIVE_SIM // 主机上的 native 环境
 };
 
 enum class KeyCode
@@ -25,6 +26,9 @@ enum class KeyCode
     MODE_SWITCH, // Tab
     MUTE_TOGGLE, // Ctrl
     REFRESH,     // R
+    RESCAN,      // S
+    GAPLESS_TOGGLE, // G
+    DEBUG_TOGGLE,   // D：音频遥测浮层
     NEXT,
     PREV
 };
@@ -65,8 +69,18 @@ void platformGfxSetBrightness(uint8_t level);
 void platformGfxDrawText(int16_t x, int16_t y, const char *text, uint32_t rgb888, uint8_t size);
 
 bool platformAudioInit(uint32_t sampleRate);
+// 音量和静音都在输出级里平滑过渡，可以随时调用（只能在音频任务里）
 void platformAudioSetVolume(uint8_t vol);
+void platformAudioSetMuted(bool muted);
+// 切歌/seek 前调用：缓冲里的旧数据在末尾淡出，之后写入的新数据淡入
+void platformAudioMarkDiscontinuity();
 void *platformGetAudioOutputPtr();
+// 输出端可以直接切换到的采样率（按优先顺序），其余采样率由 ResampleOutput 转换
+uint8_t platformAudioGetOutputRates(const uint32_t **rates);
+// 输出缓冲（解码 -> I2S 之间）当前填充量，0~100
+uint8_t platformAudioGetBufferFill();
 
 bool platformPollKeyEvent(KeyEvent &ev);
 BatteryStatus platformGetBattery();
+// 关机/重启前回调（设备上为 esp_restart() 的关机钩子，模拟器为退出回调），用来写出未保存的状态
+void platformOnShutdown(void (*fn)());
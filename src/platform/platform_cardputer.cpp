@@ -4,9 +4,12 @@
 #include <FS.h>
 #include <SD.h>
 #include <AudioOutputI2S.h>
-#include <AudioOutputBuffer.h>
+#include "platform/metered_output_buffer.h"
 #include <math.h>
 #include <esp_task_wdt.h>
+#include <esp_system.h>
+#include "core/audio/spectrum.h"
+#include "core/audio/volume_stage.h"
 
 #define USE_CARDPUTER_ADV 1
 
@@ -17,7 +20,9 @@
 
 static bool g_isInitialized = false;
 static AudioOutputI2S *g_baseOut = nullptr;
-static AudioOutputBuffer *g_buffOut = nullptr;
+static MeteredOutputBuffer *g_buffOut = nullptr;
+static SpectrumTap *g_tapOut = nullptr;
+static VolumeStage *g_volOut = nullptr;
 
 static uint32_t g_lastVolRepeatTime = 0;
 static uint32_t g_lastCtrlTime = 0;
@@ -69,8 +74,6 @@ void platformGfxDrawText(int16_t x, int16_t y, const char *text, uint32_t rgb888
     M5Cardputer.Display.print(text);
 }
 
-static uint8_t g_lastVol = 0;
-
 bool platformAudioInit(uint32_t sampleRate)
 {
     if (g_baseOut)
@@ -81,24 +84,44 @@ bool platformAudioInit(uint32_t sampleRate)
     g_baseOut->SetOutputModeMono(false);
 
     // [优化] 减小 Buffer 到 12KB，给解码器留出更多堆内存防止崩盘
-    g_buffOut = new AudioOutputBuffer(1024 * 12, g_baseOut);
-    g_baseOut->SetGain(0.05);
-    g_lastVol = 5;
+    // 缓冲 -> 频谱抽头 -> 音量级 -> I2S：频谱看到的是未经音量缩放的样本，
+    // 音量由音量级以 Q15 定点处理，I2S 自身增益固定 1.0
+    g_volOut = new VolumeStage(g_baseOut);
+    g_tapOut = new SpectrumTap(g_volOut);
+    g_buffOut = new MeteredOutputBuffer(1024 * 12, g_tapOut);
+    g_baseOut->SetGain(1.0f);
     return true;
 }
 
 void platformAudioSetVolume(uint8_t vol)
 {
-    if (g_baseOut)
-    {
-        float v = (float)vol / 100.0f;
-        float gain = pow(v, 3.0f);
-        g_baseOut->SetGain(gain);
-        g_lastVol = vol;
-    }
+    if (g_volOut)
+        g_volOut->setVolume(vol);
+}
+
+void platformAudioSetMuted(bool muted)
+{
+    if (g_volOut)
+        g_volOut->setMuted(muted);
+}
+
+void platformAudioMarkDiscontinuity()
+{
+    if (g_volOut)
+        g_volOut->markDiscontinuity(g_buffOut->bufferedFrames());
+}
+
+// I2S 时钟和功放/编解码器只按这两个采样率配置过；其余采样率重采样到其中一个
+static const uint32_t OUTPUT_RATES[] = {44100, 48000};
+
+uint8_t platformAudioGetOutputRates(const uint32_t **rates)
+{
+    *rates = OUTPUT_RATES;
+    return sizeof(OUTPUT_RATES) / sizeof(OUTPUT_RATES[0]);
 }
 
 void *platformGetAudioOutputPtr() { return (void *)g_buffOut; }
+uint8_t platformAudioGetBufferFill() { return g_buffOut ? g_buffOut->fillPercent() : 0; }
 size_t platformAudioWrite(const int16_t *interleavedStereo, size_t samples) { return samples; }
 void platformAudioStop()
 {
@@ -171,6 +194,12 @@ bool platformPollKeyEvent(KeyEvent &ev)
                 k = KeyCode::PLAY_PAUSE;
             else if (M5Cardputer.Keyboard.isKeyPressed('r') || M5Cardputer.Keyboard.isKeyPressed('R'))
                 k = KeyCode::REFRESH;
+            else if (M5Cardputer.Keyboard.isKeyPressed('s') || M5Cardputer.Keyboard.isKeyPressed('S'))
+                k = KeyCode::RESCAN;
+            else if (M5Cardputer.Keyboard.isKeyPressed('g') || M5Cardputer.Keyboard.isKeyPressed('G'))
+                k = KeyCode::GAPLESS_TOGGLE;
+            else if (M5Cardputer.Keyboard.isKeyPressed('d') || M5Cardputer.Keyboard.isKeyPressed('D'))
+                k = KeyCode::DEBUG_TOGGLE;
 
             if (M5Cardputer.Keyboard.isKeyPressed('=') || M5Cardputer.Keyboard.isKeyPressed('-') ||
                 M5Cardputer.Keyboard.isKeyPressed(KEY_LEFT_CTRL))
@@ -195,3 +224,8 @@ BatteryStatus platformGetBattery()
     st.charging = M5Cardputer.Power.isCharging();
     return st;
 }
+
+void platformOnShutdown(void (*fn)())
+{
+    esp_register_shutdown_handler(fn);
+}
@@ -0,0 +1,359 @@
+#include "platform/platform.h"
+#include <M5Cardputer.h>
+#include <SD.h>
+#include <sim.h>
+#include "platform/metered_output_buffer.h"
+#include "core/audio/spectrum.h"
+#include "core/audio/volume_stage.h"
+#include <vector>
+
+// 主机上的平台实现（native 环境）：
+//   - 按键来自脚本文件 SIM_INPUT，每行 "<毫秒> <按键名>"，按键名即 KeyCode 的枚举名；
+//     另有 "<毫秒> SHOT <文件.ppm>" 导出当前屏幕、"<毫秒> QUIT" 结束运行，# 开头为注释
+//   - 音频送进 SimAudioSink：SIM_WAV 给出路径时写 WAV，否则丢弃；
+//     默认按采样率限速（和 I2S DMA 一样写满就拒收），SIM_REALTIME=0 时不限速，解码跑满
+//   - SD 卡根目录为 SIM_SD_ROOT，屏幕退出时导出到 SIM_SCREEN
+//   - 电量固定为 SIM_BATTERY（%，默认 100，不充电），用来验证低电量路径
+#define SIM_DMA_FRAMES 512 // 模拟 I2S DMA 缓冲：暂停后恢复时最多一次接收这么多帧
+
+// ==========================
+// 音频输出
+// ==========================
+class SimAudioSink : public AudioOutput
+{
+public:
+    SimAudioSink() : wav(nullptr), dataBytes(0), realtime(true), credit(0), lastUs(0)
+    {
+        hertz = 44100;
+        bps = 16;
+        channels = 2;
+        gainF2P6 = 1 << 6;
+    }
+
+    void setRealtime(bool on) { realtime = on; }
+
+    bool openWav(const char *path)
+    {
+        wav = fopen(path, "wb");
+        if (!wav)
+            return false;
+        writeHeader();
+        return true;
+    }
+
+    virtual bool begin() override
+    {
+        lastUs = micros();
+        credit = SIM_DMA_FRAMES;
+        return true;
+    }
+
+    virtual bool ConsumeSample(int16_t sample[2]) override
+    {
+        if (realtime)
+        {
+            uint32_t now = micros();
+            credit += (double)(now - lastUs) * hertz / 1000000.0;
+            lastUs = now;
+            if (credit > SIM_DMA_FRAMES)
+                credit = SIM_DMA_FRAMES;
+            if (credit < 1.0)
+                return false;
+            credit -= 1.0;
+        }
+
+        if (wav)
+        {
+            int16_t s[2] = {sample[0], sample[1]};
+            MakeSampleStereo16(s);
+            s[0] = Amplify(s[0]);
+            s[1] = Amplify(s[1]);
+            fwrite(s, sizeof(s), 1, wav);
+            dataBytes += sizeof(s);
+        }
+        return true;
+    }
+
+    virtual bool stop() override
+    {
+        finish();
+        return true;
+    }
+
+    // 回填 WAV 头里的长度；采样率取第一次写头时的值
+    void finish()
+    {
+        if (!wav)
+            return;
+        long pos = ftell(wav);
+        writeHeader();
+        fseek(wav, pos, SEEK_SET);
+        fflush(wav);
+    }
+
+private:
+    void writeHeader()
+    {
+        uint32_t rate = hertz;
+        uint8_t h[44];
+        memcpy(h, "RIFF", 4);
+        put32(h + 4, 36 + dataBytes);
+        memcpy(h + 8, "WAVEfmt ", 8);
+        put32(h + 16, 16);
+        put16(h + 20, 1); // PCM
+        put16(h + 22, 2);
+        put32(h + 24, rate);
+        put32(h + 28, rate * 4);
+        put16(h + 32, 4);
+        put16(h + 34, 16);
+        memcpy(h + 36, "data", 4);
+        put32(h + 40, dataBytes);
+        fseek(wav, 0, SEEK_SET);
+        fwrite(h, 1, sizeof(h), wav);
+    }
+
+    static void put16(uint8_t *p, uint16_t v)
+    {
+        p[0] = v & 0xFF;
+        p[1] = v >> 8;
+    }
+
+    static void put32(uint8_t *p, uint32_t v)
+    {
+        for (int i = 0; i < 4; i++)
+            p[i] = (v >> (8 * i)) & 0xFF;
+    }
+
+    FILE *wav;
+    uint32_t dataBytes;
+    bool realtime;
+    double credit; // 按墙钟累积、还能接收的帧数
+    uint32_t lastUs;
+};
+
+static bool g_isInitialized = false;
+static SimAudioSink *g_sink = nullptr;
+static MeteredOutputBuffer *g_buffOut = nullptr;
+static SpectrumTap *g_tapOut = nullptr;
+static VolumeStage *g_volOut = nullptr;
+
+// ==========================
+// 按键脚本
+// ==========================
+enum class SimCmd
+{
+    KEY,
+    SHOT,
+    QUIT
+};
+
+struct SimInput
+{
+    uint32_t atMs;
+    SimCmd cmd;
+    KeyCode code;
+    char arg[96];
+};
+
+static std::vector<SimInput> g_script;
+static size_t g_scriptPos = 0;
+
+struct KeyName
+{
+    const char *name;
+    KeyCode code;
+};
+
+static const KeyName KEY_NAMES[] = {
+    {"OK", KeyCode::OK},
+    {"BACK", KeyCode::BACK},
+    {"LIST", KeyCode::LIST},
+    {"PLAY_PAUSE", KeyCode::PLAY_PAUSE},
+    {"UP", KeyCode::UP},
+    {"DOWN", KeyCode::DOWN},
+    {"LEFT", KeyCode::LEFT},
+    {"RIGHT", KeyCode::RIGHT},
+    {"VOL_INC", KeyCode::VOL_INC},
+    {"VOL_DEC", KeyCode::VOL_DEC},
+    {"MODE_SWITCH", KeyCode::MODE_SWITCH},
+    {"MUTE_TOGGLE", KeyCode::MUTE_TOGGLE},
+    {"REFRESH", KeyCode::REFRESH},
+    {"RESCAN", KeyCode::RESCAN},
+    {"GAPLESS_TOGGLE", KeyCode::GAPLESS_TOGGLE},
+    {"DEBUG_TOGGLE", KeyCode::DEBUG_TOGGLE},
+    {"NEXT", KeyCode::NEXT},
+    {"PREV", KeyCode::PREV},
+};
+
+static void loadScript(const char *path)
+{
+    FILE *fp = fopen(path, "r");
+    if (!fp)
+    {
+        Serial.printf("[PLAT] input script %s not found, no keys\n", path);
+        return;
+    }
+
+    char line[160];
+    int lineNo = 0;
+    while (fgets(line, sizeof(line), fp))
+    {
+        lineNo++;
+        char name[32] = "";
+        SimInput in = {};
+        if (line[0] == '#' || sscanf(line, "%u %31s %95s", &in.atMs, name, in.arg) < 2)
+            continue;
+
+        if (strcmp(name, "QUIT") == 0)
+            in.cmd = SimCmd::QUIT;
+        else if (strcmp(name, "SHOT") == 0)
+            in.cmd = SimCmd::SHOT;
+        else
+        {
+            in.cmd = SimCmd::KEY;
+            in.code = KeyCode::NONE;
+            for (const KeyName &k : KEY_NAMES)
+                if (strcmp(name, k.name) == 0)
+                    in.code = k.code;
+            if (in.code == KeyCode::NONE)
+            {
+                Serial.printf("[PLAT] %s:%d unknown key %s\n", path, lineNo, name);
+                continue;
+            }
+        }
+        g_script.push_back(in);
+    }
+    fclose(fp);
+    Serial.printf("[PLAT] input script: %u entries\n", (unsigned)g_script.size());
+}
+
+static void onExit()
+{
+    if (g_sink)
+        g_sink->finish();
+    const char *shot = simEnv("SIM_SCREEN", "sim_screen.ppm");
+    if (M5Cardputer.Display.dumpPPM(shot))
+        Serial.printf("[PLAT] screen saved to %s\n", shot);
+}
+
+void platformInit()
+{
+    if (g_isInitialized)
+        return;
+
+    M5Cardputer.Display.setRotation(1);
+    M5Cardputer.Display.fillScreen(BLACK);
+    M5Cardputer.Display.setTextSize(1);
+
+    if (!SD.begin())
+        Serial.println("SD Fail");
+
+    loadScript(simEnv("SIM_INPUT", "sim_input.txt"));
+    simAtExit(onExit);
+
+    g_isInitialized = true;
+}
+
+PlatformModel platformGetModel() { return PlatformModel::NATIVE_SIM; }
+
+void platformUpdate()
+{
+}
+
+void platformGfxFillScreen(uint32_t c) { M5Cardputer.Display.fillScreen(c); }
+void platformGfxSetBrightness(uint8_t level) { M5Cardputer.Display.setBrightness(level); }
+void platformGfxDrawText(int16_t x, int16_t y, const char *text, uint32_t rgb888, uint8_t size)
+{
+    M5Cardputer.Display.setTextColor(rgb888);
+    M5Cardputer.Display.setTextSize(size);
+    M5Cardputer.Display.setCursor(x, y);
+    M5Cardputer.Display.print(text);
+}
+
+bool platformAudioInit(uint32_t sampleRate)
+{
+    if (g_sink)
+        return true;
+
+    g_sink = new SimAudioSink();
+    g_sink->SetRate(sampleRate);
+    g_sink->setRealtime(simEnvInt("SIM_REALTIME", 1) != 0);
+    const char *wav = simEnv("SIM_WAV", nullptr);
+    if (wav && !g_sink->openWav(wav))
+        Serial.printf("[PLAT] cannot open %s\n", wav);
+
+    // 和设备上同样的链路：缓冲 -> 频谱抽头 -> 音量级 -> 输出
+    g_volOut = new VolumeStage(g_sink);
+    g_tapOut = new SpectrumTap(g_volOut);
+    g_buffOut = new MeteredOutputBuffer(1024 * 12, g_tapOut);
+    g_sink->SetGain(1.0f);
+    return true;
+}
+
+void platformAudioSetVolume(uint8_t vol)
+{
+    if (g_volOut)
+        g_volOut->setVolume(vol);
+}
+
+void platformAudioSetMuted(bool muted)
+{
+    if (g_volOut)
+        g_volOut->setMuted(muted);
+}
+
+void platformAudioMarkDiscontinuity()
+{
+    if (g_volOut)
+        g_volOut->markDiscontinuity(g_buffOut->bufferedFrames());
+}
+
+// 和设备保持一致，重采样路径在主机上也能跑到
+static const uint32_t OUTPUT_RATES[] = {44100, 48000};
+
+uint8_t platformAudioGetOutputRates(const uint32_t **rates)
+{
+    *rates = OUTPUT_RATES;
+    return sizeof(OUTPUT_RATES) / sizeof(OUTPUT_RATES[0]);
+}
+
+void *platformGetAudioOutputPtr() { return (void *)g_buffOut; }
+uint8_t platformAudioGetBufferFill() { return g_buffOut ? g_buffOut->fillPercent() : 0; }
+
+bool platformPollKeyEvent(KeyEvent &ev)
+{
+    uint32_t now = millis();
+    while (g_scriptPos < g_script.size() && g_script[g_scriptPos].atMs <= now)
+    {
+        const SimInput &in = g_script[g_scriptPos++];
+        switch (in.cmd)
+        {
+        case SimCmd::KEY:
+            ev.code = in.code;
+            ev.pressed = true;
+            return true;
+        case SimCmd::SHOT:
+            if (M5Cardputer.Display.dumpPPM(in.arg[0] ? in.arg : "sim_shot.ppm"))
+                Serial.printf("[PLAT] screen saved to %s\n", in.arg);
+            break;
+        case SimCmd::QUIT:
+            simRequestQuit(0);
+            return false;
+        }
+    }
+    return false;
+}
+
+BatteryStatus platformGetBattery()
+{
+    BatteryStatus st;
+    st.level = simEnvInt("SIM_BATTERY", 100);
+    st.voltage = 3.3f + 0.009f * st.level;
+    st.charging = false;
+    return st;
+}
+
+void platformOnShutdown(void (*fn)())
+{
+    simAtExit(fn);
+}
@@ -1,5 +1,6 @@
 #include "background_renderer.h"
 #include <math.h>
+#include "log.h"
 
 // ======================
 // 基本配置
@@ -48,10 +49,41 @@ static NebulaWave nebulaWaves[NUM_NEBULA_WAVES] = {
     {20.0f, 0.020f, 3.5f, 95.0f, 0.35f, NEBULA_ORANGE},
     {15.0f, 0.025f, 0.0f, 110.0f, 0.50f, NEBULA_BLUE}};
 
+// 当前绘制哪些层
+static uint8_t g_layers = BG_LAYER_ALL;
+
 // 星云滚动 & 时间
 static float g_nebulaScrollX = 0.0f;
 static float g_nebulaTime = 0.0f;
 
+// 正弦表：一周 1024 点，Q14，多存一项方便线性插值
+#define SINE_LUT_BITS 10
+#define SINE_LUT_SIZE (1 << SINE_LUT_BITS)
+static int16_t g_sineLut[SINE_LUT_SIZE + 1];
+
+// bgDraw() 耗时统计
+#define BG_STATS_LOG_INTERVAL 10000
+static uint32_t g_drawUsAvg = 0;
+static uint32_t g_drawLastLog = 0;
+
+// 相位用 32 位无符号数表示一整周（2π），加法溢出即自然回绕
+static inline uint32_t radToPhase(float rad)
+{
+    float turns = rad * 0.15915494f; // 1 / 2π
+    turns -= floorf(turns);
+    return (uint32_t)(turns * 4294967040.0f);
+}
+
+// 查表 + 8 位插值，返回 Q14
+static inline int32_t sinQ14(uint32_t phase)
+{
+    uint32_t idx = phase >> (32 - SINE_LUT_BITS);
+    int32_t frac = (phase >> (32 - SINE_LUT_BITS - 8)) & 0xFF;
+    int32_t a = g_sineLut[idx];
+    int32_t b = g_sineLut[idx + 1];
+    return a + (((b - a) * frac) >> 8);
+}
+
 // ======================
 // 颜色混合：fg 覆盖 bg
 // alpha: 0.0 ~ 1.0
@@ -78,6 +110,40 @@ static inline uint16_t blendColor(uint16_t fg, uint16_t bg, float alpha)
     return (r << 11) | (g << 5) | b;
 }
 
+#ifdef BG_BENCHMARK
+// 对比用：改成定点查表之前的浮点内核（每列 sinf() + blendColor()），只在 bgBenchRun() 里用
+static bool g_benchFloat = false;
+
+static void drawNebulaFloat(M5Canvas *sprite, float currentOffsetX, float currentOffsetY, float fadeFactor)
+{
+    const int screenH = 135;
+    for (int w = 0; w < NUM_NEBULA_WAVES; ++w)
+    {
+        NebulaWave &wave = nebulaWaves[w];
+        float layerAlpha = (0.40f + 0.10f * w) * fadeFactor;
+        if (layerAlpha > 1.0f)
+            layerAlpha = 1.0f;
+
+        for (int x = 0; x < 240; ++x)
+        {
+            float worldX = (float)x + currentOffsetX * wave.parallaxFactor;
+            float phase = worldX * wave.frequency + wave.phase + g_nebulaTime * 0.35f;
+            float waveY = wave.verticalOffset + sinf(phase) * wave.amplitude + currentOffsetY;
+            if (waveY >= screenH)
+                continue;
+            if (waveY < 0.0f)
+                waveY = 0.0f;
+            int yStart = (int)waveY;
+            int h = screenH - yStart;
+            if (h <= 0)
+                continue;
+            uint16_t col = blendColor(wave.color, SPACE_BG, layerAlpha);
+            sprite->drawFastVLine(x, yStart, h, col);
+        }
+    }
+}
+#endif
+
 // ======================
 // 画星云（星云 ONLY 改动的核心）
 //
@@ -93,6 +159,13 @@ static void drawNebulaInternal(M5Canvas *sprite,
 {
     if (fadeFactor <= 0.0f)
         return;
+#ifdef BG_BENCHMARK
+    if (g_benchFloat)
+    {
+        drawNebulaFloat(sprite, currentOffsetX, currentOffsetY, fadeFactor);
+        return;
+    }
+#endif
 
     const int screenH = 135;
 
@@ -106,27 +179,32 @@ static void drawNebulaInternal(M5Canvas *sprite,
         if (layerAlpha > 1.0f)
             layerAlpha = 1.0f;
 
-        for (int x = 0; x < 240; ++x)
-        {
-            float worldX = (float)x + currentOffsetX * wave.parallaxFactor;
+        // 整层同一种颜色，混合只做一次
+        uint16_t col = blendColor(wave.color, SPACE_BG, layerAlpha);
 
-            float phase = worldX * wave.frequency + wave.phase + g_nebulaTime * 0.35f; // 轻微流动
+        // 第 0 列的相位（轻微流动），之后每列加 frequency；波线高度用 Q8 定点
+        float phase0 = currentOffsetX * wave.parallaxFactor * wave.frequency + wave.phase + g_nebulaTime * 0.35f;
+        uint32_t acc = radToPhase(phase0);
+        uint32_t step = radToPhase(wave.frequency);
+        int32_t ampQ8 = (int32_t)(wave.amplitude * 256.0f);
+        int32_t baseQ8 = (int32_t)((wave.verticalOffset + currentOffsetY) * 256.0f);
 
+        for (int x = 0; x < 240; ++x, acc += step)
+        {
             // 一条波线：决定“星云从哪里开始”
-            float waveY = wave.verticalOffset + sinf(phase) * wave.amplitude + currentOffsetY;
+            int32_t waveY = baseQ8 + ((sinQ14(acc) * ampQ8) >> 14);
 
-            if (waveY >= screenH)
+            if (waveY >= (screenH << 8))
                 continue;
-            if (waveY < 0.0f)
-                waveY = 0.0f;
+            if (waveY < 0)
+                waveY = 0;
 
-            int yStart = (int)waveY;
+            int yStart = waveY >> 8;
             int h = screenH - yStart;
             if (h <= 0)
                 continue;
 
             // 从 waveY 一直画到屏幕底部
-            uint16_t col = blendColor(wave.color, SPACE_BG, layerAlpha);
             sprite->drawFastVLine(x, yStart, h, col);
         }
     }
@@ -137,6 +215,9 @@ static void drawNebulaInternal(M5Canvas *sprite,
 // ======================
 void bgInit()
 {
+    for (int i = 0; i <= SINE_LUT_SIZE; i++)
+        g_sineLut[i] = (int16_t)lroundf(16384.0f * sinf(6.2831853f * i / SINE_LUT_SIZE));
+
     // 星星
     stars.clear();
     stars.reserve(NUM_STARS);
@@ -261,12 +342,19 @@ void bgUpdate(float dt)
 // ======================
 void bgDraw(M5Canvas *sprite)
 {
+    uint32_t t0 = micros();
+
     // 深空背景
     sprite->fillScreen(SPACE_BG);
 
+    bool drawStars = g_layers & BG_LAYER_STARS;
+    bool drawMeteors = g_layers & BG_LAYER_METEORS;
+
     // 1) 星星
     for (auto &s : stars)
     {
+        if (!drawStars)
+            break;
         uint8_t b = s.brightness;
         if (random(0, 100) < 2)
             b = 255; // 偶尔闪一下
@@ -276,7 +364,7 @@ void bgDraw(M5Canvas *sprite)
     }
 
     // 2) 小像素星系
-    for (int i = 0; i < NUM_MICRO_GALAXIES; ++i)
+    for (int i = 0; drawStars && i < NUM_MICRO_GALAXIES; ++i)
     {
         float tw = (sinf(microGalaxies[i].phase) * 0.5f + 0.5f); // 0~1
         uint8_t base = 120 + (uint8_t)(tw * 135);                // 120~255
@@ -299,7 +387,7 @@ void bgDraw(M5Canvas *sprite)
     }
 
     // 3) 先画“在星云后面”的流星（等会被星云覆盖一部分）
-    for (size_t i = 0; i < meteors.size(); ++i)
+    for (size_t i = 0; drawMeteors && i < meteors.size(); ++i)
     {
         const auto &m = meteors[i];
         if (!m.active)
@@ -316,13 +404,14 @@ void bgDraw(M5Canvas *sprite)
     }
 
     // 4) 星云（按你的 NebulaWave，从波线往下铺到底）
-    drawNebulaInternal(sprite,
-                       g_nebulaScrollX, // currentOffsetX
-                       0.0f,            // currentOffsetY
-                       1.0f);           // fadeFactor（目前常驻 1）
+    if (g_layers & BG_LAYER_NEBULA)
+        drawNebulaInternal(sprite,
+                           g_nebulaScrollX, // currentOffsetX
+                           0.0f,            // currentOffsetY
+                           1.0f);           // fadeFactor（目前常驻 1）
 
     // 5) 再画“在星云前面”的流星
-    for (size_t i = 0; i < meteors.size(); ++i)
+    for (size_t i = 0; drawMeteors && i < meteors.size(); ++i)
     {
         const auto &m = meteors[i];
         if (!m.active)
@@ -339,4 +428,44 @@ void bgDraw(M5Canvas *sprite)
     }
 
     // ✅ 不画行星圆圈 / 地平线 / 额外条纹
+
+    uint32_t us = micros() - t0;
+    g_drawUsAvg = g_drawUsAvg ? (g_drawUsAvg * 7 + us) / 8 : us;
+    if (millis() - g_drawLastLog > BG_STATS_LOG_INTERVAL)
+    {
+        g_drawLastLog = millis();
+        LOG_UI("bgDraw: avg %lu us", (unsigned long)g_drawUsAvg);
+    }
+}
+
+void bgSetLayers(uint8_t layers)
+{
+    g_layers = layers;
 }
+
+#ifdef BG_BENCHMARK
+// 整个 bgDraw()（全部图层）先用浮点内核、再用定点内核各画 frames 帧，打印两者的平均耗时
+void bgBenchRun(M5Canvas *sprite, int frames)
+{
+    uint8_t layers = g_layers;
+    g_layers = BG_LAYER_ALL;
+    uint32_t avg[2];
+    for (int k = 0; k < 2; k++)
+    {
+        g_benchFloat = k == 0;
+        uint32_t total = 0;
+        for (int i = 0; i < frames; i++)
+        {
+            bgUpdate();
+            uint32_t t0 = micros();
+            bgDraw(sprite);
+            total += micros() - t0;
+        }
+        avg[k] = total / frames;
+    }
+    g_benchFloat = false;
+    g_layers = layers;
+    LOG_UI("bgDraw bench: float kernel avg %lu us, fixed-point avg %lu us (%d frames each, all layers)",
+           (unsigned long)avg[0], (unsigned long)avg[1], frames);
+}
+#endif
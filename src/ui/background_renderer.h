@@ -31,6 +31,19 @@ struct NebulaWave
 // 星云条数常量（只声明一次）
 constexpr int NUM_NEBULA_WAVES = 3;
 
+// 背景分层，负载高时由帧率调节器按位关闭
+#define BG_LAYER_STARS 0x01   // 星星 + 小像素星系
+#define BG_LAYER_METEORS 0x02
+#define BG_LAYER_NEBULA 0x04
+#define BG_LAYER_ALL (BG_LAYER_STARS | BG_LAYER_METEORS | BG_LAYER_NEBULA)
+
 void bgInit();
 void bgUpdate(float dt = 0.1f);
 void bgDraw(M5Canvas *sprite);
+void bgSetLayers(uint8_t layers);
+
+#ifdef BG_BENCHMARK
+// 开机时对比星云的浮点内核和定点内核（整个 bgDraw() 的耗时），在 uiInit() 里调用
+#define BG_BENCH_FRAMES 500
+void bgBenchRun(M5Canvas *sprite, int frames);
+#endif
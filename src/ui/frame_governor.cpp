@@ -0,0 +1,120 @@
+#include "ui/frame_governor.h"
+#include "ui/background_renderer.h"
+#include "core/audio/audio_load.h"
+#include "log.h"
+
+#define GOV_SAMPLE_MS 500   // 取样间隔
+#define GOV_RECOVER_MS 3000 // 连续健康这么久才升一级
+// 任一条件满足即认为音频有风险
+#define GOV_FILL_LOW 25
+#define GOV_DECODE_HIGH 75
+// 两个条件同时满足才算健康；中间区间保持不动，避免来回跳
+#define GOV_FILL_OK 60
+#define GOV_DECODE_OK 55
+
+static GovernorStats g_stats = {GovLevel::FULL, 0, 0, 0, 0};
+static uint32_t g_lastSample = 0;
+static uint32_t g_healthySince = 0;
+
+static const char *levelName(GovLevel l)
+{
+    switch (l)
+    {
+    case GovLevel::FULL:
+        return "full";
+    case GovLevel::NO_METEORS:
+        return "no-meteors";
+    case GovLevel::NO_STARS:
+        return "no-stars";
+    case GovLevel::NO_NEBULA:
+        return "no-nebula";
+    case GovLevel::HALF_FPS:
+        return "half-fps";
+    case GovLevel::QUARTER_FPS:
+        return "quarter-fps";
+    default:
+        return "?";
+    }
+}
+
+static void setLevel(GovLevel next, const char *reason)
+{
+    LOG_UI("governor: %s -> %s (%s, fill %u%%, decode %u%%, down %lu, up %lu)",
+           levelName(g_stats.level), levelName(next), reason,
+           g_stats.lastFill, g_stats.lastDecode,
+           (unsigned long)g_stats.stepsDown, (unsigned long)g_stats.stepsUp);
+    g_stats.level = next;
+}
+
+void governorUpdate(bool playing)
+{
+    uint32_t now = millis();
+    if (now - g_lastSample < GOV_SAMPLE_MS)
+        return;
+    g_lastSample = now;
+
+    AudioLoad load = audioLoadSample();
+    g_stats.lastFill = load.bufferFill;
+    g_stats.lastDecode = load.decodeLoad;
+
+    uint8_t level = (uint8_t)g_stats.level;
+
+    // 不在播放时缓冲本来就是空的，不算风险
+    bool atRisk = playing && (load.bufferFill < GOV_FILL_LOW || load.decodeLoad > GOV_DECODE_HIGH);
+    bool healthy = !playing || (load.bufferFill >= GOV_FILL_OK && load.decodeLoad <= GOV_DECODE_OK);
+
+    if (atRisk)
+    {
+        g_healthySince = 0;
+        if (level + 1 < (uint8_t)GovLevel::COUNT)
+        {
+            g_stats.stepsDown++;
+            setLevel((GovLevel)(level + 1), load.bufferFill < GOV_FILL_LOW ? "buffer low" : "decode busy");
+        }
+        return;
+    }
+
+    if (!healthy || level == 0)
+    {
+        g_healthySince = 0;
+        return;
+    }
+
+    if (g_healthySince == 0)
+        g_healthySince = now;
+    else if (now - g_healthySince >= GOV_RECOVER_MS)
+    {
+        g_stats.stepsUp++;
+        g_healthySince = now; // 每升一级重新计时
+        setLevel((GovLevel)(level - 1), playing ? "recovered" : "idle");
+    }
+}
+
+uint8_t governorBgLayers()
+{
+    switch (g_stats.level)
+    {
+    case GovLevel::FULL:
+        return BG_LAYER_ALL;
+    case GovLevel::NO_METEORS:
+        return BG_LAYER_STARS | BG_LAYER_NEBULA;
+    case GovLevel::NO_STARS:
+        return BG_LAYER_NEBULA;
+    default:
+        return 0;
+    }
+}
+
+uint32_t governorFpsDivisor()
+{
+    if (g_stats.level == GovLevel::QUARTER_FPS)
+        return 4;
+    if (g_stats.level == GovLevel::HALF_FPS)
+        return 2;
+    return 1;
+}
+
+GovernorStats governorGetStats()
+{
+    return g_stats;
+}
@@ -0,0 +1,32 @@
+#pragma once
+#include <stdint.h>
+
+// 帧率调节器：盯着输出缓冲填充量和解码占用率，音频吃紧时逐级降低画面开销，
+// 先去掉背景层（流星 -> 星星 -> 星云），再降帧率；恢复稳定一段时间后逐级加回
+enum class GovLevel : uint8_t
+{
+    FULL,
+    NO_METEORS,
+    NO_STARS,
+    NO_NEBULA,
+    HALF_FPS,
+    QUARTER_FPS,
+    COUNT
+};
+
+struct GovernorStats
+{
+    GovLevel level;
+    uint32_t stepsDown;
+    uint32_t stepsUp;
+    uint8_t lastFill;   // 最近一次取样的输出缓冲填充量 %
+    uint8_t lastDecode; // 最近一次取样的解码占用率 %
+};
+
+// 渲染任务每帧调用；内部按固定间隔取样
+void governorUpdate(bool playing);
+// 当前允许绘制的背景层（BG_LAYER_*）
+uint8_t governorBgLayers();
+// 目标帧率除以这个数
+uint32_t governorFpsDivisor();
+GovernorStats governorGetStats();
@@ -1,20 +1,72 @@
 #include "ui/ui_root.h"
 #include "platform/platform.h"
 #include "core/audio/audio_engine.h"
+#include "core/library/library.h"
+#include "core/audio/spectrum.h"
+#include "core/audio/audio_telemetry.h"
 #include "background_renderer.h"
+#include "frame_governor.h"
 #include <M5Cardputer.h>
 #include <math.h>
-
-static AppState *g_app = nullptr;
+#include <atomic>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include <esp_heap_caps.h>
+#include "log.h"
+
+// 渲染任务放在核心 1（和 loop()、SD 预读任务同核），核心 0 留给解码和曲库扫描；
+// 优先级和 loop() 相同（时间片轮转），低于预读任务，SD 补货永远先跑
+#define UI_TASK_STACK 8192
+#define UI_TASK_PRIO 1
+#define UI_TASK_CORE 1
+
+// 渲染只读这份快照；g_pending 由 loop() 提交，每帧开始时拷到 g_view
+static AppState g_pending;
+static AppState g_view;
+static portMUX_TYPE g_stateMux = portMUX_INITIALIZER_UNLOCKED;
+static const AppState *g_app = &g_view;
+
+// 单画布：DMA 从不直接读画布，推送前先把脏块拷进暂存区，所以帧结束后就能接着画
 static M5Canvas *g_sprite = nullptr;
+
+static TaskHandle_t g_renderTask = nullptr;
+static std::atomic<uint32_t> g_targetFps(UI_TARGET_FPS);
+
+// 列表滚动位置只属于界面，不写回 AppState
+static int g_browserScrollTop = 0;
 static int g_scrollOffset = 0;
 static int g_listScroll = 0;
 static uint32_t g_titleScrollTime = 0;
 static uint32_t g_listScrollTime = 0;
 
+// ==========================================
+// 脏矩形：画布按 16x15 分块，每帧比较块哈希，只推送变化的块
+// ==========================================
+#define UI_W 240
+#define UI_H 135
+#define UI_TILE_W 16
+#define UI_TILE_H 15
+#define UI_TILES_X (UI_W / UI_TILE_W) // 15
+#define UI_TILES_Y (UI_H / UI_TILE_H) // 9
+#define UI_STATS_LOG_INTERVAL 10000
+
+// 两块 DMA 暂存区，各放得下一整行块；一块在传输时拷下一段到另一块
+#define UI_STAGE_PIXELS (UI_W * UI_TILE_H)
+static uint16_t *g_stage[2] = {nullptr, nullptr};
+
+static uint32_t g_tileHash[UI_TILES_Y][UI_TILES_X];
+static uint16_t g_tileForce[UI_TILES_Y]; // 控件标记的脏块（每行一个位图），本帧直接推送
+static std::atomic<bool> g_fullRedraw(true);
+
+static UiStats g_uiStats = {};
+static uint32_t g_statBytes = 0;
+static uint32_t g_statFrames = 0;
+static uint32_t g_statWindowStart = 0;
+static uint32_t g_statLastLog = 0;
+
 // 外部函数声明
 bool audioEngineIsMuted();
-String audioEngineGetListItem(int index);
+const char *audioEngineGetListItem(int index);
 int audioEngineGetTotalTracks();
 
 // ==========================================
@@ -30,18 +82,202 @@ int audioEngineGetTotalTracks();
 #define C_DIM 0x0821
 #define C_MASK 0x0000 // 遮罩色(黑色)
 
-// 初始化 UI
-void uiInit(AppState *app)
+// 控件每帧都会变的区域直接标脏，省掉哈希比较
+static void markDirty(int x, int y, int w, int h)
 {
-    g_app = app;
-    g_sprite = new M5Canvas(&M5Cardputer.Display);
-    g_sprite->createSprite(240, 135);
+    if (w <= 0 || h <= 0)
+        return;
+    int tx0 = x < 0 ? 0 : x / UI_TILE_W;
+    int ty0 = y < 0 ? 0 : y / UI_TILE_H;
+    int tx1 = (x + w - 1) / UI_TILE_W;
+    int ty1 = (y + h - 1) / UI_TILE_H;
+    if (tx1 >= UI_TILES_X)
+        tx1 = UI_TILES_X - 1;
+    if (ty1 >= UI_TILES_Y)
+        ty1 = UI_TILES_Y - 1;
+    for (int ty = ty0; ty <= ty1; ty++)
+        for (int tx = tx0; tx <= tx1; tx++)
+            g_tileForce[ty] |= (uint16_t)(1u << tx);
+}
+
+void uiInvalidate()
+{
+    g_fullRedraw = true;
+}
+
+static uint32_t hashTile(const uint16_t *buf, int tx, int ty)
+{
+    uint32_t h = 2166136261u;
+    const uint16_t *row = buf + ty * UI_TILE_H * UI_W + tx * UI_TILE_W;
+    for (int r = 0; r < UI_TILE_H; r++, row += UI_W)
+    {
+        const uint32_t *p = (const uint32_t *)row;
+        for (int i = 0; i < UI_TILE_W / 2; i++)
+            h = (h ^ p[i]) * 16777619u;
+    }
+    return h;
+}
+
+// 推送一段脏块（同一块行里相邻的若干块）：只开这段的窗口。
+// 窗口在画布里不连续，先拷进暂存区再 DMA；writePixelsDMA 发起前会等上一段传完，
+// 所以拷这一段时，上一段正在从另一块暂存区传出去
+static uint32_t pushRun(const uint16_t *buf, int ty, int tx0, int tx1, int &stage)
+{
+    auto &lcd = M5Cardputer.Display;
+    int x = tx0 * UI_TILE_W;
+    int y = ty * UI_TILE_H;
+    int w = (tx1 - tx0) * UI_TILE_W;
+    const uint16_t *src = buf + y * UI_W + x;
+
+    lcd.setAddrWindow(x, y, w, UI_TILE_H);
+    if (!g_stage[0])
+    {
+        // 暂存区没分到：逐行阻塞写（画布内存已是屏幕字节序，不需要再交换）
+        for (int r = 0; r < UI_TILE_H; r++, src += UI_W)
+            lcd.writePixels(src, w, false);
+        return w * UI_TILE_H * 2;
+    }
+
+    uint16_t *dst = g_stage[stage];
+    for (int r = 0; r < UI_TILE_H; r++, src += UI_W, dst += w)
+        memcpy(dst, src, w * sizeof(uint16_t));
+    lcd.writePixelsDMA(g_stage[stage], w * UI_TILE_H, false);
+    stage ^= 1;
+    return w * UI_TILE_H * 2;
+}
+
+// 比较每块的哈希，每个块行里相邻的脏块合成一段，一段一次 DMA。
+// 每帧一次总线事务：endWrite() 只等最后一段（至多一整行块，约 7 KB），之后画布随便画
+static uint32_t pushDirtyTiles()
+{
+    const uint16_t *buf = (const uint16_t *)g_sprite->getBuffer();
+    uint32_t bytes = 0;
+    int stage = 0;
+    bool open = false;
+    // 只在帧开始读一次，推送途中别的任务再要求全屏推送就留给下一帧
+    bool full = g_fullRedraw.exchange(false);
+
+    for (int ty = 0; ty < UI_TILES_Y; ty++)
+    {
+        uint16_t dirty = 0;
+        for (int tx = 0; tx < UI_TILES_X; tx++)
+        {
+            if (g_tileForce[ty] & (1u << tx))
+            {
+                // 强制推送的块不算哈希，下次重新比较
+                g_tileHash[ty][tx] = 0;
+                dirty |= (uint16_t)(1u << tx);
+                continue;
+            }
+            uint32_t h = hashTile(buf, tx, ty);
+            if (full || h != g_tileHash[ty][tx])
+            {
+                g_tileHash[ty][tx] = h;
+                dirty |= (uint16_t)(1u << tx);
+            }
+        }
+        g_tileForce[ty] = 0;
+
+        int tx = 0;
+        while (dirty >> tx)
+        {
+            if (!(dirty & (1u << tx)))
+            {
+                tx++;
+                continue;
+            }
+            int end = tx;
+            while (end < UI_TILES_X && (dirty & (1u << end)))
+                end++;
+            if (!open)
+            {
+                M5Cardputer.Display.startWrite();
+                open = true;
+            }
+            bytes += pushRun(buf, ty, tx, end, stage);
+            tx = end;
+        }
+    }
+
+    if (open)
+        M5Cardputer.Display.endWrite();
+    return bytes;
+}
+
+static void updateUiStats(uint32_t frameUs, uint32_t bytes)
+{
+    g_uiStats.frameUs = frameUs;
+    g_statBytes += bytes;
+    g_statFrames++;
+
+    uint32_t now = millis();
+    uint32_t elapsed = now - g_statWindowStart;
+    if (elapsed >= 1000)
+    {
+        g_uiStats.bytesPerSec = (uint32_t)((uint64_t)g_statBytes * 1000 / elapsed);
+        g_uiStats.fps = g_statFrames * 1000 / elapsed;
+        g_uiStats.targetFps = g_targetFps.load(std::memory_order_relaxed);
+        g_statBytes = 0;
+        g_statFrames = 0;
+        g_statWindowStart = now;
+    }
+
+    if (now - g_statLastLog > UI_STATS_LOG_INTERVAL)
+    {
+        g_statLastLog = now;
+        LOG_UI("display: %lu B/s pushed (full frames: %lu B/s), %lu/%lu fps, frame %lu us, %s",
+               (unsigned long)g_uiStats.bytesPerSec, (unsigned long)(g_uiStats.fps * UI_W * UI_H * 2),
+               (unsigned long)g_uiStats.fps, (unsigned long)g_uiStats.targetFps, (unsigned long)g_uiStats.frameUs,
+               g_stage[0] ? "dma staged" : "blocking");
+    }
+}
+
+UiStats uiGetStats()
+{
+    return g_uiStats;
+}
+
+// 画布放内部 RAM，哈希和拷贝暂存区都要逐块读它
+static M5Canvas *createCanvas()
+{
+    M5Canvas *c = new M5Canvas(&M5Cardputer.Display);
+    c->setPsram(false);
+    if (!c->createSprite(UI_W, UI_H))
+    {
+        delete c;
+        return nullptr;
+    }
     // 使用内置中文支持
-    g_sprite->setFont(&fonts::efontCN_16);
-    g_sprite->setTextSize(1);
+    c->setFont(&fonts::efontCN_16);
+    c->setTextSize(1);
+    return c;
+}
+
+// 初始化 UI
+void uiInit(const AppState *app)
+{
+    g_pending = *app;
+    g_view = *app;
+    g_sprite = createCanvas();
+    g_stage[0] = (uint16_t *)heap_caps_malloc(UI_STAGE_PIXELS * sizeof(uint16_t), MALLOC_CAP_DMA);
+    g_stage[1] = (uint16_t *)heap_caps_malloc(UI_STAGE_PIXELS * sizeof(uint16_t), MALLOC_CAP_DMA);
+    if (!g_stage[0] || !g_stage[1])
+    {
+        // 一块也不留：只用一块时拷贝就得等传输，不如直接阻塞写
+        heap_caps_free(g_stage[0]);
+        heap_caps_free(g_stage[1]);
+        g_stage[0] = g_stage[1] = nullptr;
+        LOG_UI("dma staging alloc failed, blocking pushes");
+    }
+    M5Cardputer.Display.initDMA();
 
     // 初始化星空 / 星云背景
     bgInit();
+#ifdef BG_BENCHMARK
+    bgBenchRun(g_sprite, BG_BENCH_FRAMES);
+#endif
+    // 频谱分析表（窗函数、旋转因子、频段边界）
+    spectrumInit();
 }
 
 // 开机动画：赛博宇宙背景 + VAST_JIANG Player 霓虹字闪烁+轻微晃动
@@ -115,6 +351,8 @@ void uiShowBootAnim()
         g_sprite->pushSprite(0, 0);
         delay(20);
     }
+    // 开机动画整屏推送过，块哈希已失效
+    uiInvalidate();
 }
 
 // ==========================
@@ -188,6 +426,32 @@ void drawVolBar(int x, int y, int w, int h, int vol, bool isMuted)
     }
 }
 
+// ==========================
+// 曲库扫描进度：压在 Header 分隔线上
+// 总量未知（全量扫描）时画来回扫动的光条，否则按目录数画进度
+// ==========================
+void drawScanProgress(int lineY)
+{
+    LibraryScanProgress p = libraryGetScanProgress();
+    if (!p.active)
+        return;
+
+    if (p.cold || p.dirsKnown <= 0)
+    {
+        const int seg = 40;
+        const int span = 240 - seg;
+        int pos = (millis() / 8) % (2 * span);
+        if (pos > span)
+            pos = 2 * span - pos;
+        g_sprite->drawFastHLine(pos, lineY, seg, C_MAGENTA);
+    }
+    else
+    {
+        int done = p.dirsDone < p.dirsKnown ? p.dirsDone : p.dirsKnown;
+        g_sprite->drawFastHLine(0, lineY, 240 * done / p.dirsKnown, C_MAGENTA);
+    }
+}
+
 // ==========================
 // 播放界面
 // ==========================
@@ -204,12 +468,13 @@ void renderPlayer()
     g_sprite->setTextColor(C_CYAN);
     g_sprite->drawString(" VAST_JIANG OS", 2, 2);
 
-    BatteryStatus bat = platformGetBattery();
+    // 电量由 loop() 低频读取后随快照送来，渲染任务不碰电源芯片
     char batS[16];
-    sprintf(batS, "PWR:%d%%", bat.level);
-    uint32_t batCol = bat.level > 20 ? C_GREEN : C_RED;
+    sprintf(batS, "PWR:%d%%", (int)g_app->batteryLevel);
+    uint32_t batCol = g_app->batteryLevel > 20 ? C_GREEN : C_RED;
     g_sprite->setTextColor(batCol);
     g_sprite->drawRightString(batS, 236, 2);
+    drawScanProgress(18);
 
     // 3. 歌名区域 (赛博框，内部透明，只画边框)
     int boxY = 30;
@@ -242,6 +507,7 @@ void renderPlayer()
         g_sprite->setClipRect(clipX, clipY, clipW, clipH);
         g_sprite->drawString(title, clipX + g_scrollOffset, boxY + 8);
         g_sprite->clearClipRect();
+        markDirty(clipX, clipY, clipW, clipH);
     }
     else
     {
@@ -249,33 +515,58 @@ void renderPlayer()
         g_sprite->drawCenterString(title, 120, boxY + 8);
     }
 
+    // 播放时间：标题框下方右对齐，小字体
+    if (g_app->durationMs > 0 || g_app->elapsedMs > 0)
+    {
+        char timeS[24];
+        uint32_t e = g_app->elapsedMs / 1000;
+        uint32_t d = g_app->durationMs / 1000;
+        if (d > 0)
+            snprintf(timeS, sizeof(timeS), "%lu:%02lu / %lu:%02lu",
+                     (unsigned long)(e / 60), (unsigned long)(e % 60), (unsigned long)(d / 60), (unsigned long)(d % 60));
+        else
+            snprintf(timeS, sizeof(timeS), "%lu:%02lu", (unsigned long)(e / 60), (unsigned long)(e % 60));
+        g_sprite->setFont(&fonts::Font0);
+        g_sprite->setTextColor(C_CYAN);
+        g_sprite->drawRightString(timeS, 230, boxY + 35);
+        g_sprite->setFont(&fonts::efontCN_16);
+    }
+
     // 4. 状态 & 伪频谱
     const char *st = g_app->isPlaying ? ">> RUNNING" : "|| PAUSED";
     uint32_t stCol = g_app->isPlaying ? C_GREEN : C_RED;
     drawMaskedText(st, 15, 75, stCol);
 
-    // 频谱线（赛博霓虹色随机跳动）
+    // 频谱（解码输出的实时 FFT，对数频段 + 峰值保持）
     int specY = 95;
     g_sprite->drawFastHLine(15, specY, 140, C_MAGENTA);
+    spectrumUpdate();
     if (g_app->isPlaying)
+        markDirty(15, specY - 11, 140, 23);
+    const uint8_t *levels = spectrumGetLevels();
+    const uint8_t *peaks = spectrumGetPeaks();
+    for (int b = 0; b < SPECTRUM_BANDS; b++)
     {
-        for (int i = 0; i < 140; i += 6)
+        int x = 15 + b * 6;
+        int h = levels[b] * 18 / SPECTRUM_LEVEL_MAX;
+        int ph = peaks[b] * 18 / SPECTRUM_LEVEL_MAX;
+
+        // 根据 X 位置切换颜色，霓虹风
+        uint16_t barColor;
+        int mod = b % 3;
+        if (mod == 0)
+            barColor = C_CYAN;
+        else if (mod == 1)
+            barColor = C_MAGENTA;
+        else
+            barColor = g_sprite->color565(255, 128, 0); // 霓虹橙
+
+        if (h > 0)
+            g_sprite->fillRect(x, specY - h / 2, 4, h | 1, barColor);
+        if (ph > h)
         {
-            if (random(10) > 4)
-            {
-                int h = random(4, 18);
-                // 根据 X 位置切换颜色，霓虹风
-                uint16_t barColor;
-                int mod = (i / 6) % 3;
-                if (mod == 0)
-                    barColor = C_CYAN;
-                else if (mod == 1)
-                    barColor = C_MAGENTA;
-                else
-                    barColor = g_sprite->color565(255, 128, 0); // 霓虹橙
-
-                g_sprite->drawFastVLine(15 + i, specY - h / 2, h, barColor);
-            }
+            g_sprite->drawFastHLine(x, specY - ph / 2 - 1, 4, C_WHITE);
+            g_sprite->drawFastHLine(x, specY + ph / 2 + 1, 4, C_WHITE);
         }
     }
 
@@ -301,6 +592,14 @@ void renderPlayer()
     int modeTextY = modeY + (modeH - 16) / 2; // 16 是字体高度
     g_sprite->drawString(modeStr, modeTextX, modeTextY);
 
+    // 无缝播放开启时在模式框下方标注
+    if (g_app->gapless)
+    {
+        g_sprite->setTextColor(C_GREEN);
+        int gapW = g_sprite->textWidth("GAPLESS");
+        g_sprite->drawString("GAPLESS", modeX + (modeW - gapW) / 2, modeY + modeH + 4);
+    }
+
     // 6. 底部：音量
     g_sprite->setTextColor(C_CYAN);
     g_sprite->drawString("VOL", 5, 113);
@@ -322,11 +621,22 @@ void renderBrowser()
     g_sprite->setTextColor(C_GREEN);
     g_sprite->drawString(" > FILE EXPLORER", 5, 2);
 
+    // 扫描中：列表边扫边增长，右上角显示已找到的曲目数
     int total = audioEngineGetTotalTracks();
+    bool scanning = libraryIsScanning();
+    if (scanning)
+    {
+        char scanS[16];
+        snprintf(scanS, sizeof(scanS), "SCAN %d", total);
+        g_sprite->setTextColor(C_MAGENTA);
+        g_sprite->drawRightString(scanS, 236, 2);
+        drawScanProgress(20);
+    }
+
     if (total == 0)
     {
-        g_sprite->setTextColor(C_RED);
-        g_sprite->drawCenterString("NO FILES", 120, 60);
+        g_sprite->setTextColor(scanning ? C_MAGENTA : C_RED);
+        g_sprite->drawCenterString(scanning ? "SCANNING..." : "NO FILES", 120, 60);
         return;
     }
 
@@ -335,20 +645,21 @@ void renderBrowser()
     int lh = 22;
     int startY = 25;
 
-    if (g_app->browserCursor < g_app->browserScrollTop)
-        g_app->browserScrollTop = g_app->browserCursor;
-    if (g_app->browserCursor >= g_app->browserScrollTop + maxLines)
-        g_app->browserScrollTop = g_app->browserCursor - maxLines + 1;
+    if (g_app->browserCursor < g_browserScrollTop)
+        g_browserScrollTop = g_app->browserCursor;
+    if (g_app->browserCursor >= g_browserScrollTop + maxLines)
+        g_browserScrollTop = g_app->browserCursor - maxLines + 1;
 
     for (int i = 0; i < maxLines; i++)
     {
-        int idx = g_app->browserScrollTop + i;
+        int idx = g_browserScrollTop + i;
         if (idx >= total)
             break;
 
         int y = startY + i * lh;
         bool sel = (idx == g_app->browserCursor);
-        String name = audioEngineGetListItem(idx);
+        const char *name = audioEngineGetListItem(idx);
+        char line[LIBRARY_MAX_PATH_LEN + 4];
 
         if (sel)
         {
@@ -379,14 +690,16 @@ void renderBrowser()
             else
             {
                 g_listScroll = 0;
-                g_sprite->drawString("> " + name, 5, y + 3);
+                snprintf(line, sizeof(line), "> %s", name);
+                g_sprite->drawString(line, 5, y + 3);
             }
         }
         else
         {
             // 普通项：背景透明，只画绿色文字
             g_sprite->setTextColor(C_GREEN);
-            g_sprite->drawString("  " + name, 5, y + 3);
+            snprintf(line, sizeof(line), "  %s", name);
+            g_sprite->drawString(line, 5, y + 3);
         }
     }
 
@@ -394,23 +707,127 @@ void renderBrowser()
     int barH = (total > 0) ? (100 * maxLines / total) : 100;
     if (barH < 5)
         barH = 5;
-    int barY = startY + (g_app->browserScrollTop * (100 - barH) / (total - maxLines > 0 ? total - maxLines : 1));
+    int barY = startY + (g_browserScrollTop * (100 - barH) / (total - maxLines > 0 ? total - maxLines : 1));
     g_sprite->drawRect(236, startY, 3, 100, C_DARK);
     g_sprite->fillRect(236, barY, 3, barH, C_CYAN);
 }
 
 // ==========================
-// 主 UI 渲染入口
+// 调试浮层：音频遥测（D 键开关），压在右上角
 // ==========================
-void uiRender()
+void drawTelemetryOverlay()
 {
-    if (!g_sprite)
-        return;
+    const int x = 118;
+    const int y = 20;
+    const int w = 122;
+    const int h = 62;
+
+    AudioTelemetry t = audioTelemetryGet();
+    char line[6][40];
+    snprintf(line[0], sizeof(line[0]), "BUF %3u%% %u-%u", t.fillNow, t.fillLow, t.fillHigh);
+    snprintf(line[1], sizeof(line[1]), "DEC %lu/%luus", (unsigned long)t.decodeAvgUs, (unsigned long)t.decodeMaxUs);
+    snprintf(line[2], sizeof(line[2]), "SD  %lu/%luus", (unsigned long)t.sdAvgUs, (unsigned long)t.sdMaxUs);
+    snprintf(line[3], sizeof(line[3]), "EMPTY %lu", (unsigned long)t.bufferEmpties);
+    snprintf(line[4], sizeof(line[4]), "OPEN %lu 1ST %lums", (unsigned long)t.openMs, (unsigned long)t.firstSampleMs);
+    snprintf(line[5], sizeof(line[5]), "%-4s CPU %u%%", audioFormatName(t.format), t.formatLoad[(int)t.format]);
+
+    g_sprite->fillRect(x, y, w, h, C_BLACK);
+    g_sprite->drawRect(x, y, w, h, C_DARK);
+    g_sprite->setFont(&fonts::Font0);
+    g_sprite->setTextColor(t.bufferEmpties ? C_RED : C_GREEN);
+    for (int i = 0; i < 6; i++)
+        g_sprite->drawString(line[i], x + 3, y + 2 + i * 10);
+    g_sprite->setFont(&fonts::efontCN_16);
+    markDirty(x, y, w, h);
+}
+
+// ==========================
+// 状态快照
+// ==========================
+void uiSubmitState(const AppState *app)
+{
+    portENTER_CRITICAL(&g_stateMux);
+    g_pending = *app;
+    portEXIT_CRITICAL(&g_stateMux);
+}
+
+static void takeSnapshot()
+{
+    portENTER_CRITICAL(&g_stateMux);
+    g_view = g_pending;
+    portEXIT_CRITICAL(&g_stateMux);
+}
+
+// ==========================
+// 渲染一帧（只在渲染任务里调用）
+// ==========================
+static void renderFrame()
+{
+    uint32_t t0 = micros();
+
+    takeSnapshot();
+
+    // 音频吃紧时先少画背景层
+    governorUpdate(g_app->isPlaying);
+    bgSetLayers(governorBgLayers());
 
     if (g_app->uiMode == UiMode::PLAYER)
         renderPlayer();
     else
         renderBrowser();
+    if (audioTelemetryEnabled())
+        drawTelemetryOverlay();
+
+    uint32_t bytes = pushDirtyTiles();
+    updateUiStats(micros() - t0, bytes);
+}
 
-    g_sprite->pushSprite(0, 0);
+static void renderTaskEntry(void *)
+{
+    uint32_t nextFrame = millis();
+    while (true)
+    {
+        uint32_t fps = g_targetFps.load(std::memory_order_relaxed) / governorFpsDivisor();
+        if (fps < 1)
+            fps = 1;
+        uint32_t period = 1000 / fps;
+        uint32_t now = millis();
+
+        // 等到下一个帧周期；uiRequestFrame() 会提前唤醒
+        if ((int32_t)(nextFrame - now) > 0)
+            ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(nextFrame - now));
+        else
+            ulTaskNotifyTake(pdTRUE, 0);
+
+        renderFrame();
+
+        // 落后太多时不追帧，从现在重新计时
+        nextFrame += period;
+        now = millis();
+        if ((int32_t)(now - nextFrame) > (int32_t)period)
+            nextFrame = now + period;
+    }
+}
+
+void uiStartRenderTask()
+{
+    if (g_renderTask || !g_sprite)
+        return;
+    xTaskCreatePinnedToCore(renderTaskEntry, "Render", UI_TASK_STACK, NULL, UI_TASK_PRIO, &g_renderTask, UI_TASK_CORE);
+    LOG_UI("render task started: %lu fps target", (unsigned long)g_targetFps.load());
+}
+
+void uiSetTargetFps(uint32_t fps)
+{
+    if (fps < 1)
+        fps = 1;
+    if (fps > 60)
+        fps = 60;
+    g_targetFps.store(fps, std::memory_order_relaxed);
+}
+
+void uiRequestFrame()
+{
+    if (g_renderTask)
+        xTaskNotifyGive(g_renderTask);
 }
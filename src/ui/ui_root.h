@@ -1,8 +1,32 @@
 #pragma once
 #include "core/state/app_state.h"
 
-// 初始化 UI (分配内存、设置字体)
-void uiInit(AppState *app);
+// 渲染任务的目标帧率，可在 build_flags 里覆盖
+#ifndef UI_TARGET_FPS
+#define UI_TARGET_FPS 25
+#endif
 
-// 渲染一帧画面
-void uiRender();
\ No newline at end of file
+// 初始化 UI (分配画布和 DMA 暂存区、设置字体)
+void uiInit(const AppState *app);
+
+// 启动渲染任务：与音频同核、优先级低于音频，按目标帧率绘制，
+// 一块画布绘制的同时另一块由 DMA 推送；输入所在的 loop() 不再等待任何一帧
+void uiStartRenderTask();
+void uiSetTargetFps(uint32_t fps);
+
+// 提交状态快照，渲染任务每帧开始时取最新的一份
+void uiSubmitState(const AppState *app);
+// 不等下一个帧周期，尽快画一帧（按键反馈）
+void uiRequestFrame();
+
+struct UiStats
+{
+    uint32_t frameUs;     // 最近一帧：绘制 + 比较 + 发起推送
+    uint32_t bytesPerSec; // 实际推送到屏幕的字节数（最近 1 秒）
+    uint32_t fps;
+    uint32_t targetFps;
+};
+
+// 下一帧全屏推送（例如屏幕内容被 UI 之外的代码改写过）
+void uiInvalidate();
+UiStats uiGetStats();
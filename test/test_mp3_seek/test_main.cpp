@@ -0,0 +1,204 @@
+// Mp3SeekSource 的按时间定位：5000 帧、帧长 417/418 字节交替的码流（没有 Xing/VBRI），
+// 落点必须是帧头；帧索引走完后要精确落在目标时间所在的那一帧
+#include <unity.h>
+#include <string.h>
+#include "core/audio/mp3_info.cpp"
+#include "core/audio/mp3_seek.cpp"
+#include "core/audio/track_source.cpp"
+
+#define TEST_FRAMES 5000
+#define TEST_FRAME_BYTES 417 // MPEG1 Layer III 128kbps 44.1kHz，不带填充位
+#define TEST_FRAME_SAMPLES 1152
+
+static uint8_t *g_stream = nullptr;
+static uint32_t g_streamLen = 0;
+
+// 第 f 帧帧头的位置：偶数帧不带填充，奇数帧带 1 字节填充
+static uint32_t frameOffset(uint32_t f)
+{
+    return f * TEST_FRAME_BYTES + f / 2;
+}
+
+static bool isFrameStart(uint32_t off)
+{
+    uint32_t f = off / (TEST_FRAME_BYTES + 1);
+    while (frameOffset(f) < off)
+        f++;
+    return f < TEST_FRAMES && frameOffset(f) == off;
+}
+
+static void buildStream()
+{
+    g_streamLen = frameOffset(TEST_FRAMES);
+    g_stream = (uint8_t *)calloc(g_streamLen, 1);
+    for (uint32_t f = 0; f < TEST_FRAMES; f++)
+    {
+        uint8_t *h = g_stream + frameOffset(f);
+        h[0] = 0xFF;
+        h[1] = 0xFB;
+        h[2] = (f & 1) ? 0x92 : 0x90; // 填充位
+        h[3] = 0x00;
+    }
+}
+
+// 内存里的输入
+class MemSource : public AudioFileSource
+{
+public:
+    MemSource() : pos(0) {}
+
+    virtual uint32_t read(void *data, uint32_t len) override
+    {
+        if (pos >= g_streamLen)
+            return 0;
+        if (len > g_streamLen - pos)
+            len = g_streamLen - pos;
+        memcpy(data, g_stream + pos, len);
+        pos += len;
+        return len;
+    }
+    virtual bool seek(int32_t p, int dir) override
+    {
+        int64_t to = dir == SEEK_SET ? p : dir == SEEK_CUR ? (int64_t)pos + p : (int64_t)g_streamLen + p;
+        if (to < 0 || to > (int64_t)g_streamLen)
+            return false;
+        pos = (uint32_t)to;
+        return true;
+    }
+    virtual bool close() override { return true; }
+    virtual bool isOpen() override { return true; }
+    virtual uint32_t getSize() override { return g_streamLen; }
+    virtual uint32_t getPos() override { return pos; }
+
+private:
+    uint32_t pos;
+};
+
+// 和 trackOpen() 一样：先读流信息，再从第一帧开始包一层 Mp3SeekSource
+static Mp3SeekSource *openStream(const char *path)
+{
+    MemSource *m = new MemSource();
+    Mp3StreamInfo info;
+    TEST_ASSERT_TRUE(mp3ReadStreamInfo(m, info));
+    m->seek(info.audioStart, SEEK_SET);
+    return new Mp3SeekSource(m, info, path);
+}
+
+static void readToEnd(Mp3SeekSource *s)
+{
+    static uint8_t buf[1500];
+    while (s->read(buf, sizeof(buf)) > 0)
+    {
+    }
+}
+
+static uint32_t expectedFrame(const Mp3SeekSource *s, uint32_t ms)
+{
+    uint64_t sample = (uint64_t)ms * 44100 / 1000 + mp3LeadingTrim(s->getInfo());
+    uint32_t f = (uint32_t)(sample / TEST_FRAME_SAMPLES);
+    return f < TEST_FRAMES ? f : TEST_FRAMES - 1;
+}
+
+void setUp()
+{
+}
+
+void tearDown()
+{
+}
+
+void test_stream_info()
+{
+    Mp3SeekSource *s = openStream("/info.mp3");
+    TEST_ASSERT_EQUAL_UINT32(0, s->getInfo().audioStart);
+    TEST_ASSERT_EQUAL_UINT32(44100, s->sampleRate());
+    TEST_ASSERT_EQUAL_UINT32(TEST_FRAME_SAMPLES, s->getInfo().samplesPerFrame);
+    TEST_ASSERT_FALSE(s->getInfo().hasXing);
+    delete s;
+}
+
+// 还没读过的曲目：按平均帧长估算，再找帧同步
+void test_estimated_seek_lands_on_frame_header()
+{
+    Mp3SeekSource *s = openStream("/estimate.mp3");
+    TrackSeekPoint q;
+    TEST_ASSERT_FALSE(s->locateQuick(60000, q));
+
+    uint32_t durMs = (uint32_t)((uint64_t)TEST_FRAMES * TEST_FRAME_SAMPLES * 1000 / 44100);
+    for (uint32_t ms = 0; ms < durMs; ms += 997)
+    {
+        TrackSeekPoint pt;
+        TEST_ASSERT_TRUE(s->locate(ms, pt));
+        TEST_ASSERT_TRUE_MESSAGE(isFrameStart(pt.offset), "estimated offset is not a frame header");
+        TEST_ASSERT_EQUAL_UINT32(0, pt.sample % TEST_FRAME_SAMPLES);
+    }
+    delete s;
+}
+
+// 顺序读完一遍后帧索引完整（5000 帧超过索引容量，步长会加倍），落点精确
+void test_indexed_seek_lands_on_target_frame()
+{
+    Mp3SeekSource *s = openStream("/indexed.mp3");
+    readToEnd(s);
+
+    uint32_t durMs = s->durationMs();
+    TEST_ASSERT_EQUAL_UINT32((uint32_t)((uint64_t)TEST_FRAMES * TEST_FRAME_SAMPLES * 1000 / 44100), durMs);
+    for (uint32_t ms = 0; ms <= durMs + 500; ms += 211)
+    {
+        TrackSeekPoint pt;
+        TEST_ASSERT_TRUE(s->locate(ms, pt));
+        uint32_t f = expectedFrame(s, ms);
+        TEST_ASSERT_TRUE(pt.exact);
+        TEST_ASSERT_EQUAL_UINT32_MESSAGE(f * TEST_FRAME_SAMPLES, pt.sample, "wrong frame");
+        TEST_ASSERT_EQUAL_UINT32_MESSAGE(frameOffset(f), pt.offset, "wrong offset");
+    }
+    delete s;
+}
+
+// 播放中的快速定位：locateQuick 给出不晚于目标的索引条目，refineTo 走到目标帧，结果和 locate 一致
+void test_quick_locate_then_refine_matches_locate()
+{
+    Mp3SeekSource *s = openStream("/quick.mp3");
+    readToEnd(s);
+
+    for (uint32_t ms = 0; ms < 130000; ms += 1733)
+    {
+        TrackSeekPoint q, p;
+        TEST_ASSERT_TRUE(s->locateQuick(ms, q));
+        TEST_ASSERT_TRUE(isFrameStart(q.offset));
+        TEST_ASSERT_LESS_OR_EQUAL(expectedFrame(s, ms) * TEST_FRAME_SAMPLES, q.sample);
+        TEST_ASSERT_TRUE(s->refineTo(ms, q));
+        TEST_ASSERT_TRUE(s->locate(ms, p));
+        TEST_ASSERT_EQUAL_UINT32(p.offset, q.offset);
+        TEST_ASSERT_EQUAL_UINT32(p.sample, q.sample);
+    }
+    delete s;
+}
+
+// seekTo 之后从落点读到的是帧头
+void test_seek_to_reads_frame_header()
+{
+    Mp3SeekSource *s = openStream("/seekto.mp3");
+    readToEnd(s);
+
+    TrackSeekPoint pt;
+    TEST_ASSERT_TRUE(s->locate(73000, pt));
+    TEST_ASSERT_TRUE(s->seekTo(pt));
+    uint8_t h[4];
+    TEST_ASSERT_EQUAL_UINT32(4, s->read(h, 4));
+    TEST_ASSERT_EQUAL(0xFF, h[0]);
+    TEST_ASSERT_EQUAL(0xFB, h[1]);
+    delete s;
+}
+
+int main(int argc, char **argv)
+{
+    buildStream();
+    UNITY_BEGIN();
+    RUN_TEST(test_stream_info);
+    RUN_TEST(test_estimated_seek_lands_on_frame_header);
+    RUN_TEST(test_indexed_seek_lands_on_target_frame);
+    RUN_TEST(test_quick_locate_then_refine_matches_locate);
+    RUN_TEST(test_seek_to_reads_frame_header);
+    return UNITY_END();
+}
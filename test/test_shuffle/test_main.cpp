@@ -0,0 +1,223 @@
+// 随机播放顺序：一轮内不重复、上一首是真正播过的那首、列表追加/删除/重排后的处理、存盘与恢复
+#include <unity.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <SD.h>
+#include "core/audio/shuffle_order.cpp"
+
+#define TEST_MAX_TRACKS 64
+
+// 替换掉曲库：列表序号 -> 句柄，路径由句柄生成
+static TrackHandle g_lib[TEST_MAX_TRACKS];
+static int g_libCount = 0;
+static TrackHandle g_nextHandle = 0;
+
+int libraryGetCount()
+{
+    return g_libCount;
+}
+
+TrackHandle libraryGetHandle(int index)
+{
+    return index >= 0 && index < g_libCount ? g_lib[index] : PATH_STORE_INVALID_HANDLE;
+}
+
+bool libraryCopyPath(int index, char *buf, size_t len)
+{
+    if (index < 0 || index >= g_libCount)
+        return false;
+    snprintf(buf, len, "/music/%u.mp3", (unsigned)g_lib[index]);
+    return true;
+}
+
+static void libAppend(int n)
+{
+    while (n-- > 0 && g_libCount < TEST_MAX_TRACKS)
+        g_lib[g_libCount++] = g_nextHandle++;
+}
+
+// 删除后其余曲目保持相对顺序（和曲库压缩一样）
+static void libRemove(int index)
+{
+    for (int i = index; i + 1 < g_libCount; i++)
+        g_lib[i] = g_lib[i + 1];
+    g_libCount--;
+}
+
+// 每个用例换一批新句柄，排列必然对不上，第一次调用时重新洗牌
+void setUp()
+{
+    g_libCount = 0;
+    g_nextHandle += 1000;
+}
+
+void tearDown()
+{
+}
+
+// 一轮 n 首不重复，相邻两次（包括跨轮）不是同一首
+void test_cycle_is_permutation_without_repeat()
+{
+    const int n = 7;
+    libAppend(n);
+    int cur = 3;
+    for (int cycle = 0; cycle < 200; cycle++)
+    {
+        bool seen[n] = {};
+        for (int k = 0; k < n; k++)
+        {
+            TEST_ASSERT_FALSE(seen[cur]);
+            seen[cur] = true;
+            int next = shuffleNext(cur);
+            TEST_ASSERT_TRUE(next >= 0 && next < n);
+            TEST_ASSERT_NOT_EQUAL(cur, next);
+            cur = next;
+        }
+    }
+}
+
+// 无缝衔接会提前取下一首：真正切过去之前反复调用、中间按一次上一首，结果都不变
+void test_next_is_stable_until_it_plays()
+{
+    libAppend(5);
+    int cur = 0;
+    for (int step = 0; step < 500; step++)
+    {
+        int a = shuffleNext(cur);
+        int p = shufflePrev(cur);
+        TEST_ASSERT_EQUAL_INT(a, shuffleNext(cur));
+        if (p != cur)
+        {
+            // 回到上一首再前进，应回到 cur，之后的预取也不变
+            TEST_ASSERT_EQUAL_INT(cur, shuffleNext(p));
+            TEST_ASSERT_EQUAL_INT(a, shuffleNext(cur));
+        }
+        cur = a;
+    }
+}
+
+// 上一首是排列里真正播过的那首，连续后退能一直退到本轮开头
+void test_prev_walks_back_through_played_tracks()
+{
+    const int n = 9;
+    libAppend(n);
+    int played[n];
+    played[0] = 4;
+    for (int k = 1; k < n; k++)
+        played[k] = shuffleNext(played[k - 1]);
+
+    int cur = played[n - 1];
+    for (int k = n - 2; k >= 0; k--)
+    {
+        cur = shufflePrev(cur);
+        TEST_ASSERT_EQUAL_INT(played[k], cur);
+    }
+    // 已在本轮开头
+    TEST_ASSERT_EQUAL_INT(played[0], shufflePrev(played[0]));
+}
+
+// 列表在末尾追加：新曲目并进本轮还没播的部分，已经播过的不会再出现
+void test_append_extends_current_cycle()
+{
+    libAppend(7);
+    int cur = 2;
+    bool seen[TEST_MAX_TRACKS] = {};
+    seen[cur] = true;
+    for (int k = 1; k < 3; k++)
+    {
+        cur = shuffleNext(cur);
+        seen[cur] = true;
+    }
+
+    libAppend(5);
+    for (int k = 3; k < 12; k++)
+    {
+        cur = shuffleNext(cur);
+        TEST_ASSERT_FALSE(seen[cur]);
+        seen[cur] = true;
+    }
+    for (int i = 0; i < 12; i++)
+        TEST_ASSERT_TRUE(seen[i]);
+}
+
+// 删了曲目（其余序号前移）：重新洗牌，当前曲目排第一，接下来一轮是其余所有曲目
+void test_removal_reshuffles_from_current()
+{
+    libAppend(8);
+    int cur = 5;
+    for (int k = 0; k < 3; k++)
+        cur = shuffleNext(cur);
+
+    libRemove(cur == 0 ? 1 : 0);
+    cur = cur == 0 ? 0 : cur - 1;
+    bool seen[TEST_MAX_TRACKS] = {};
+    seen[cur] = true;
+    for (int k = 1; k < 7; k++)
+    {
+        cur = shuffleNext(cur);
+        TEST_ASSERT_FALSE(seen[cur]);
+        seen[cur] = true;
+    }
+}
+
+// 存盘后恢复：排列和游标都接得上
+void test_saved_order_is_restored()
+{
+    libAppend(10);
+    int cur = 1;
+    for (int k = 0; k < 4; k++)
+        cur = shuffleNext(cur);
+    int next = shuffleNext(cur);
+    int prev = shufflePrev(cur);
+
+    shuffleCapture();
+    shuffleFlush();
+    g_n = 0; // 模拟重启
+    TEST_ASSERT_TRUE(shuffleLoad());
+    TEST_ASSERT_EQUAL_INT(next, shuffleNext(cur));
+    TEST_ASSERT_EQUAL_INT(prev, shufflePrev(cur));
+
+    // 只在末尾追加过：仍然接受
+    libAppend(3);
+    TEST_ASSERT_TRUE(shuffleLoad());
+}
+
+// 曲库压缩后又追加、总数没变少：存下的排列对应的已经不是这些曲目，必须放弃
+void test_saved_order_rejected_after_reorder()
+{
+    libAppend(10);
+    int cur = 0;
+    for (int k = 0; k < 4; k++)
+        cur = shuffleNext(cur);
+    shuffleCapture();
+    shuffleFlush();
+
+    libRemove(3);
+    libAppend(1);
+    TEST_ASSERT_FALSE(shuffleLoad());
+
+    // 放弃后照常从当前曲目重新洗牌
+    int next = shuffleNext(2);
+    TEST_ASSERT_TRUE(next >= 0 && next < 10);
+    TEST_ASSERT_NOT_EQUAL(2, next);
+}
+
+int main(int argc, char **argv)
+{
+    char root[] = "/tmp/synthcard_test_XXXXXX";
+    if (!mkdtemp(root))
+        return 1;
+    setenv("SIM_SD_ROOT", root, 1);
+    SD.begin();
+    randomSeed(12345);
+
+    UNITY_BEGIN();
+    RUN_TEST(test_cycle_is_permutation_without_repeat);
+    RUN_TEST(test_next_is_stable_until_it_plays);
+    RUN_TEST(test_prev_walks_back_through_played_tracks);
+    RUN_TEST(test_append_extends_current_cycle);
+    RUN_TEST(test_removal_reshuffles_from_current);
+    RUN_TEST(test_saved_order_is_restored);
+    RUN_TEST(test_saved_order_rejected_after_reorder);
+    return UNITY_END();
+}
@@ -0,0 +1,190 @@
+// VolumeStage 的 Q15 增益过渡：音量变化、静音、断点淡出淡入时输出逐帧连续，过渡结束后落在目标增益上
+#include <unity.h>
+#include <stdlib.h>
+#include "core/audio/volume_stage.cpp"
+
+#define TEST_LEVEL 16000     // 输入是恒定的直流，输出就是增益曲线
+#define TEST_MAX_FRAMES 8192
+
+// 记下每一帧的输出
+class CaptureOutput : public AudioOutput
+{
+public:
+    CaptureOutput() : count(0) {}
+
+    virtual bool begin() override { return true; }
+    virtual bool stop() override { return true; }
+    virtual bool ConsumeSample(int16_t sample[2]) override
+    {
+        if (count >= TEST_MAX_FRAMES)
+            return false;
+        left[count] = sample[0];
+        right[count] = sample[1];
+        count++;
+        return true;
+    }
+
+    int16_t left[TEST_MAX_FRAMES];
+    int16_t right[TEST_MAX_FRAMES];
+    uint32_t count;
+};
+
+static CaptureOutput *g_sink = nullptr;
+static VolumeStage *g_vol = nullptr;
+
+static void feed(uint32_t frames)
+{
+    for (uint32_t i = 0; i < frames; i++)
+    {
+        int16_t s[2] = {TEST_LEVEL, -TEST_LEVEL};
+        TEST_ASSERT_TRUE(g_vol->ConsumeSample(s));
+    }
+}
+
+// 按帧数送完并把不满一块的尾巴也处理掉
+static void feedAll(uint32_t frames)
+{
+    feed(frames);
+    g_vol->flush();
+}
+
+static uint32_t rampFrames()
+{
+    return 44100 * VOLUME_RAMP_MS / 1000;
+}
+
+static int32_t levelAt(uint8_t vol)
+{
+    int32_t g = (int32_t)((uint64_t)vol * vol * vol * VOLUME_UNITY / 1000000);
+    return (TEST_LEVEL * g) >> 15;
+}
+
+// [from, to) 内相邻两帧的差不超过 maxStep，左右声道对称
+static void assertContinuous(uint32_t from, uint32_t to, int32_t maxStep)
+{
+    for (uint32_t i = from; i < to; i++)
+    {
+        TEST_ASSERT_LESS_OR_EQUAL(1, abs(g_sink->left[i] + g_sink->right[i]));
+        if (i > from)
+            TEST_ASSERT_LESS_OR_EQUAL(maxStep, abs(g_sink->left[i] - g_sink->left[i - 1]));
+    }
+}
+
+// TEST_LEVEL 在 frames 帧内走完时每帧最多变化多少；增益步长截断、样本右移各有 1 的舍入余量
+static int32_t stepFor(uint32_t frames)
+{
+    return TEST_LEVEL / (int32_t)frames + 2;
+}
+
+static int32_t maxStep()
+{
+    return stepFor(rampFrames());
+}
+
+void setUp()
+{
+    g_sink = new CaptureOutput();
+    g_vol = new VolumeStage(g_sink);
+    g_vol->SetRate(44100);
+    g_vol->SetBitsPerSample(16);
+    g_vol->SetChannels(2);
+    g_vol->begin();
+}
+
+void tearDown()
+{
+    delete g_vol;
+    delete g_sink;
+}
+
+// 从静音升到满音量再降到一半：过渡期间单调、没有台阶，结束后正好是目标值
+void test_volume_change_ramps_continuously()
+{
+    g_vol->setVolume(100);
+    feedAll(1000);
+    TEST_ASSERT_EQUAL_UINT32(1000, g_sink->count);
+    TEST_ASSERT_LESS_OR_EQUAL(maxStep(), g_sink->left[0]);
+    for (uint32_t i = 1; i < rampFrames(); i++)
+        TEST_ASSERT_TRUE(g_sink->left[i] >= g_sink->left[i - 1]);
+    assertContinuous(0, 1000, maxStep());
+    TEST_ASSERT_EQUAL_INT(levelAt(100), g_sink->left[rampFrames()]);
+    TEST_ASSERT_EQUAL_INT(levelAt(100), g_sink->left[999]);
+
+    g_vol->setVolume(50);
+    feedAll(1000);
+    for (uint32_t i = 1001; i < 1000 + rampFrames(); i++)
+        TEST_ASSERT_TRUE(g_sink->left[i] <= g_sink->left[i - 1]);
+    assertContinuous(999, 2000, maxStep());
+    TEST_ASSERT_EQUAL_INT(levelAt(50), g_sink->left[1000 + rampFrames()]);
+    TEST_ASSERT_EQUAL_INT(levelAt(50), g_sink->left[1999]);
+}
+
+// 不在块边界上改音量：块里已收下、还没处理的帧也跟着过渡，照样连续
+void test_volume_change_inside_block()
+{
+    g_vol->setVolume(100);
+    feed(1000 + 13);
+    g_vol->setVolume(30);
+    feedAll(987);
+    assertContinuous(0, 2000, maxStep());
+    TEST_ASSERT_EQUAL_INT(levelAt(30), g_sink->left[1999]);
+}
+
+// 静音只是淡出到 0，音量保留，取消静音淡入回原来的音量
+void test_mute_fades_out_and_back()
+{
+    g_vol->setVolume(80);
+    feedAll(1000);
+    g_vol->setMuted(true);
+    feedAll(1000);
+    TEST_ASSERT_EQUAL_INT(0, g_sink->left[1000 + rampFrames()]);
+    TEST_ASSERT_EQUAL_INT(0, g_sink->left[1999]);
+    g_vol->setMuted(false);
+    feedAll(1000);
+    assertContinuous(0, 3000, maxStep());
+    TEST_ASSERT_EQUAL_INT(levelAt(80), g_sink->left[2999]);
+}
+
+// 断点前淡出到 0、断点处从 0 淡入：framesAhead 帧之后才是新数据
+void test_discontinuity_fades_around_break()
+{
+    g_vol->setVolume(100);
+    feedAll(1000);
+    const uint32_t ahead = 1500;
+    const uint32_t at = 1000 + ahead;
+    g_vol->markDiscontinuity(ahead);
+    feedAll(3000);
+
+    assertContinuous(0, 4000, maxStep());
+    TEST_ASSERT_EQUAL_INT(levelAt(100), g_sink->left[at - rampFrames() - 1]);
+    TEST_ASSERT_LESS_OR_EQUAL(maxStep(), g_sink->left[at - 1]);
+    TEST_ASSERT_LESS_OR_EQUAL(maxStep(), g_sink->left[at]);
+    TEST_ASSERT_EQUAL_INT(levelAt(100), g_sink->left[at + rampFrames()]);
+    TEST_ASSERT_EQUAL_INT(levelAt(100), g_sink->left[3999]);
+}
+
+// 断点比一次过渡还近：马上开始淡出，照样在断点处到 0
+void test_discontinuity_closer_than_ramp()
+{
+    g_vol->setVolume(100);
+    feedAll(1000);
+    const uint32_t ahead = rampFrames() / 4;
+    g_vol->markDiscontinuity(ahead);
+    feedAll(1000);
+
+    assertContinuous(999, 1000 + ahead, stepFor(ahead));
+    TEST_ASSERT_LESS_OR_EQUAL(stepFor(ahead), g_sink->left[1000 + ahead - 1]);
+    assertContinuous(1000 + ahead, 2000, maxStep());
+    TEST_ASSERT_EQUAL_INT(levelAt(100), g_sink->left[1999]);
+}
+
+int main(int argc, char **argv)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_volume_change_ramps_continuously);
+    RUN_TEST(test_volume_change_inside_block);
+    RUN_TEST(test_mute_fades_out_and_back);
+    RUN_TEST(test_discontinuity_fades_around_break);
+    RUN_TEST(test_discontinuity_closer_than_ramp);
+    return UNITY_END();
+}
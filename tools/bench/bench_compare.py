@@ -0,0 +1,82 @@
+#!/usr/bin/env python3
+# 对比两次解码测试的结果（串口日志或 grep 出的 BENCH 行均可）
+#   用法：bench_compare.py 基准.log 新.log [--threshold 5]
+# 按文件名逐个对比 fps / rtf / 堆 / 栈，重采样按比值对比 rtf；rtf 变慢超过阈值（百分比）时退出码为 1
+import argparse
+import json
+import sys
+
+
+def load(path):
+    header, files = None, {}
+    with open(path, encoding="utf-8", errors="replace") as f:
+        for line in f:
+            i = line.find("BENCH {")
+            if i < 0:
+                continue
+            try:
+                obj = json.loads(line[i + 6:])
+            except ValueError:
+                continue
+            if "bench" in obj:
+                header, files = obj, {}  # 日志里有多次运行时只取最后一次
+            elif "file" in obj:
+                files[obj["file"]] = obj
+            elif "resample" in obj:
+                obj["ok"] = True
+                files["resample " + obj["resample"]] = obj
+    if header is None:
+        sys.exit("%s: no BENCH header found" % path)
+    return header, files
+
+
+def pct(old, new):
+    return (new - old) * 100.0 / old if old else 0.0
+
+
+def main():
+    ap = argparse.ArgumentParser()
+    ap.add_argument("base")
+    ap.add_argument("new")
+    ap.add_argument("--threshold", type=float, default=5.0, help="rtf regression limit in percent")
+    args = ap.parse_args()
+
+    bh, base = load(args.base)
+    nh, new = load(args.new)
+    if bh.get("format") != nh.get("format"):
+        sys.exit("result format differs: %s vs %s" % (bh.get("format"), nh.get("format")))
+    for key in ("platform", "cpu_mhz", "psram", "lib", "compiler"):
+        if bh.get(key) != nh.get(key):
+            print("note: %s %s -> %s" % (key, bh.get(key), nh.get(key)))
+
+    print("%-28s %9s %9s %7s %8s %8s %8s" % ("file", "fps", "new", "rtf%", "heap", "psram", "stack"))
+    regressed = []
+    for name in sorted(set(base) | set(new)):
+        b, n = base.get(name), new.get(name)
+        if not b or not n:
+            print("%-28s %s" % (name, "only in base" if b else "only in new"))
+            continue
+        if not (b["ok"] and n["ok"]):
+            print("%-28s ok %s -> %s" % (name, b["ok"], n["ok"]))
+            if b["ok"]:
+                regressed.append(name)
+            continue
+        d = pct(b["rtf"], n["rtf"])
+        if "fps" in b:
+            print("%-28s %9.1f %9.1f %+6.1f%% %+8d %+8d %+8d" % (
+                name, b["fps"], n["fps"], d,
+                n["heap_peak"] - b["heap_peak"], n["psram_peak"] - b["psram_peak"],
+                n["stack_peak"] - b["stack_peak"]))
+        else:
+            print("%-28s %9s %9s %+6.1f%%" % (name, "-", "-", d))
+        if d > args.threshold:
+            regressed.append(name)
+
+    if regressed:
+        print("regressed (rtf +%.1f%% or failed): %s" % (args.threshold, ", ".join(regressed)))
+        return 1
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,79 @@
+#!/bin/sh
+# 生成解码测试夹具：MP3 为主，另有同一信号的 WAV/FLAC 用于对比各格式的 CPU 占用（需要带 libmp3lame 的 ffmpeg）
+#   用法：tools/bench/gen_fixtures.sh [输出目录]      默认 ./bench_fixtures
+#   DURATION=秒 可改时长（默认 30）
+# 源信号是左右声道不同的正弦 + 噪声，ffmpeg 的 random() 按种子确定，同一版本 ffmpeg 每次生成的文件相同
+set -e
+
+OUT=${1:-bench_fixtures}
+DUR=${DURATION:-30}
+FF="ffmpeg -hide_banner -loglevel error -y"
+
+mkdir -p "$OUT"
+TMP=$(mktemp -d)
+trap 'rm -rf "$TMP"' EXIT
+
+$FF -f lavfi -i "aevalsrc=0.3*sin(2*PI*220*t)+0.15*(random(0)*2-1)|0.3*sin(2*PI*331*t)+0.15*(random(1)*2-1):s=48000:d=$DUR" \
+    -c:a pcm_s16le "$TMP/src.wav"
+
+enc()
+{
+    name=$1
+    shift
+    $FF -i "$TMP/src.wav" -map_metadata -1 -c:a libmp3lame "$@" "$OUT/$name.mp3"
+    echo "$OUT/$name.mp3"
+}
+
+# 码率（44.1kHz 立体声 CBR）
+enc cbr128_44k -ar 44100 -b:a 128k
+enc cbr192_44k -ar 44100 -b:a 192k
+enc cbr320_44k -ar 44100 -b:a 320k
+# VBR：LAME V0 / V2 / V5
+enc vbr_v0_44k -ar 44100 -q:a 0
+enc vbr_v2_44k -ar 44100 -q:a 2
+enc vbr_v5_44k -ar 44100 -q:a 5
+# 单声道
+enc mono128_44k -ar 44100 -ac 1 -b:a 128k
+enc mono64_22k -ar 22050 -ac 1 -b:a 64k
+# 采样率（22.05kHz 为 MPEG-2，每帧 576 个样本）
+enc cbr64_22k -ar 22050 -b:a 64k
+enc cbr128_32k -ar 32000 -b:a 128k
+enc cbr192_48k -ar 48000 -b:a 192k
+enc cbr320_48k -ar 48000 -b:a 320k
+
+# 大 ID3v2：内嵌约 750KB 的封面（随机像素的 PNG，几乎不可压缩），另有一个约 64KB 的
+$FF -f lavfi -i "nullsrc=s=512x512,geq=r=random(1)*255:g=random(2)*255:b=random(3)*255,format=rgb24" \
+    -frames:v 1 "$TMP/cover_large.png"
+$FF -f lavfi -i "nullsrc=s=148x148,geq=r=random(1)*255:g=random(2)*255:b=random(3)*255,format=rgb24" \
+    -frames:v 1 "$TMP/cover_small.png"
+for size in large small; do
+    $FF -i "$TMP/src.wav" -i "$TMP/cover_$size.png" -map 0:a -map 1:v -c:v copy \
+        -c:a libmp3lame -ar 44100 -b:a 128k -id3v2_version 3 \
+        -metadata title="Bench $size ID3" -metadata artist="SynthCard" \
+        -metadata:s:v title="Album cover" -metadata:s:v comment="Cover (front)" \
+        "$OUT/id3_${size}_cbr128_44k.mp3"
+    echo "$OUT/id3_${size}_cbr128_44k.mp3"
+done
+
+# WAV / FLAC：44.1kHz 立体声，和 cbr*_44k 同一段信号，rtf 可以直接横向比较
+pcm()
+{
+    name=$1
+    shift
+    $FF -i "$TMP/src.wav" -map_metadata -1 -ar 44100 "$@" "$OUT/$name"
+    echo "$OUT/$name"
+}
+pcm pcm16_44k.wav -c:a pcm_s16le
+pcm pcm24_44k.wav -c:a pcm_s24le
+pcm pcm16_mono_44k.wav -ac 1 -c:a pcm_s16le
+pcm pcm16_48k.wav -ar 48000 -c:a pcm_s16le
+pcm flac16_44k.flac -c:a flac -compression_level 5
+pcm flac16_44k_c8.flac -c:a flac -compression_level 8
+pcm flac24_44k.flac -c:a flac -sample_fmt s32 -bits_per_raw_sample 24
+pcm flac16_48k.flac -ar 48000 -c:a flac
+# 带约 750KB 封面的 FLAC：封面在元数据块里，打开时应直接跳过
+$FF -i "$TMP/src.wav" -i "$TMP/cover_large.png" -map 0:a -map 1:v -c:v copy -disposition:v attached_pic \
+    -c:a flac -ar 44100 -metadata title="Bench cover FLAC" "$OUT/cover_large_flac16_44k.flac"
+echo "$OUT/cover_large_flac16_44k.flac"
+
+echo "done: copy $OUT/* to /.bench on the SD card (or SIM_SD_ROOT/.bench for native)"